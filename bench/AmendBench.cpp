@@ -0,0 +1,94 @@
+// A quoting loop that moves one resting order's price far faster than edits are acknowledged:
+//   direct     every price change is its own modifyOrderAsync request
+//   coalesced  price changes go through System::amendOrder, which keeps one edit in flight
+//              and merges the rest into the one waiting behind it
+// Reports requests sent, edits absorbed, and how long after the last change the exchange
+// acknowledged the final price. Run it against the simulator.
+// Usage: amend_bench [base_url] [edits] [interval_us]
+// The access token is read from DERIBIT_TOKEN (any token works unless the simulator uses --strict-auth).
+#include "System.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <thread>
+
+using Clock = std::chrono::steady_clock;
+
+static std::string placeResting(System& system, const std::string& token) {
+    BuyRequest request;
+    request.instrument = "BTC-PERPETUAL";
+    request.amount = 10.0;
+    request.price = 1000.0; // Far below the market, so it rests
+    request.label = "amend-bench";
+    OrderResult placed;
+    system.placeOrder(request, token, placed);
+    return std::string(placed.id());
+}
+
+static EditRequest quote(const std::string& orderId, int i) {
+    EditRequest edit;
+    edit.orderId = orderId;
+    edit.amount = 10.0;
+    edit.price = 1000.0 + i % 500;
+    return edit;
+}
+
+static void run(System& system, const std::string& token, int edits, std::chrono::microseconds interval, bool coalesce) {
+    const std::string orderId = placeResting(system, token);
+    if (orderId.empty()) {
+        std::cerr << "Could not place the resting order" << std::endl;
+        return;
+    }
+    const uint64_t sentBefore = system.amendQueue().sent();
+    const uint64_t absorbedBefore = system.amendQueue().absorbed();
+    std::atomic<int> pending{edits};
+    std::atomic<int> failed{0};
+    std::atomic<int64_t> finalAckNs{0};
+    const double finalPrice = *quote(orderId, edits - 1).price;
+
+    auto onResult = [&](const OrderResult& result) {
+        if (!result.ok()) {
+            ++failed;
+        }
+        finalAckNs.store(Clock::now().time_since_epoch().count());
+        --pending;
+    };
+    Clock::time_point lastChange;
+    for (int i = 0; i < edits; ++i) {
+        if (coalesce) {
+            system.amendOrder(quote(orderId, i), token, onResult);
+        } else {
+            system.modifyOrderAsync(quote(orderId, i), token, onResult);
+        }
+        lastChange = Clock::now();
+        std::this_thread::sleep_until(lastChange + interval);
+    }
+    while (pending.load() > 0) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    const double settleMs = (finalAckNs.load() - lastChange.time_since_epoch().count()) / 1e6;
+
+    const uint64_t sent = coalesce ? system.amendQueue().sent() - sentBefore : edits;
+    const uint64_t absorbed = coalesce ? system.amendQueue().absorbed() - absorbedBefore : 0;
+    std::cout << (coalesce ? "coalesced" : "direct") << ": " << edits << " price changes, " << sent
+              << " requests, " << absorbed << " absorbed, " << failed << " failed, final price "
+              << finalPrice << " acknowledged " << settleMs << " ms after the last change" << std::endl;
+    system.cancelOrder(CancelRequest{orderId}, token);
+}
+
+int main(int argc, char* argv[]) {
+    const std::string url = argc > 1 ? argv[1] : "http://127.0.0.1:8080";
+    const int edits = argc > 2 ? std::atoi(argv[2]) : 5000;
+    const std::chrono::microseconds interval(argc > 3 ? std::atoi(argv[3]) : 100);
+    const char* tokenEnv = std::getenv("DERIBIT_TOKEN");
+    const std::string token = tokenEnv ? tokenEnv : "bench";
+
+    Connection conn(url);
+    System system(conn, 1);
+
+    run(system, token, edits, interval, false);
+    run(system, token, edits, interval, true);
+    return 0;
+}
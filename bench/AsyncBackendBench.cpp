@@ -0,0 +1,62 @@
+// Compares System::placeOrdersAsync on the thread-pool backend against the curl_multi engine.
+// Usage: async_backend_bench [base_url] [orders] [threads]
+// The access token is read from DERIBIT_TOKEN.
+#include "System.h"
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+#include <tuple>
+
+// Run one burst of market orders and report wall time and throughput
+static void runBurst(System& system, System::AsyncBackend backend, const char* name, const std::string& token,
+                     const std::vector<std::tuple<std::string, std::string, double, double, std::string>>& orders) {
+    system.setAsyncBackend(backend);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<rapidjson::Document> responses = system.placeOrdersAsync(token, orders);
+    auto end = std::chrono::steady_clock::now();
+
+    size_t ok = 0;
+    for (const auto& response : responses) {
+        if (response.IsObject() && response.HasMember("result")) {
+            ++ok;
+        }
+    }
+
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << name << ": " << orders.size() << " orders in " << ms << " ms ("
+              << (orders.size() * 1000.0 / ms) << " orders/s), " << ok << " succeeded" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const std::string baseUrl = argc > 1 ? argv[1] : "https://test.deribit.com";
+    const int orderCount = argc > 2 ? std::atoi(argv[2]) : 200;
+    const size_t threadCount = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 4;
+
+    const char* token = std::getenv("DERIBIT_TOKEN");
+    if (!token) {
+        std::cerr << "Set DERIBIT_TOKEN to an access token" << std::endl;
+        return 1;
+    }
+
+    std::vector<std::tuple<std::string, std::string, double, double, std::string>> orders;
+    for (int i = 0; i < orderCount; ++i) {
+        orders.emplace_back("ETH-PERPETUAL", "market", 1, 0, "bench" + std::to_string(i));
+    }
+
+    Connection conn(baseUrl);
+    System system(conn, threadCount);
+
+    // Warm up both paths so neither pays the first TLS handshake in the measurement
+    std::vector<std::tuple<std::string, std::string, double, double, std::string>> warmup(orders.begin(), orders.begin() + std::min<size_t>(orders.size(), 8));
+    system.setAsyncBackend(System::AsyncBackend::ThreadPool);
+    system.placeOrdersAsync(token, warmup);
+    system.setAsyncBackend(System::AsyncBackend::CurlMulti);
+    system.placeOrdersAsync(token, warmup);
+
+    runBurst(system, System::AsyncBackend::ThreadPool, "thread-pool", token, orders);
+    runBurst(system, System::AsyncBackend::CurlMulti, "curl-multi ", token, orders);
+    return 0;
+}
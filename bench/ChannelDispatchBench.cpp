@@ -0,0 +1,94 @@
+// Routing a notification to its channel's handler for a full-universe subscription (book,
+// trades and ticker of every instrument):
+//   prefix scan  one prefix handler per channel, compared in turn (the old dispatch)
+//   hash map     std::unordered_map<std::string, handler>, hashing the name per message
+//   interned     ChannelIndex::find, then an array indexed by ChannelId
+// Usage: channel_dispatch_bench [instruments] [messages]
+#include "ChannelRegistry.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+static std::vector<std::string> universe(int instruments) {
+    static const char* const currencies[] = {"BTC", "ETH", "SOL"};
+    static const char* const expiries[] = {"27DEC24", "28MAR25", "27JUN25", "26SEP25"};
+    std::vector<std::string> channels;
+    for (int i = 0; i < instruments; ++i) {
+        std::string instrument = std::string(currencies[i % 3]) + "-" + expiries[(i / 3) % 4] + "-" +
+                                 std::to_string(1000 + (i / 12) * 500) + (i % 2 ? "-C" : "-P");
+        channels.push_back("book." + instrument + ".100ms");
+        channels.push_back("trades." + instrument + ".100ms");
+        channels.push_back("ticker." + instrument + ".100ms");
+    }
+    return channels;
+}
+
+template <typename Route>
+static void measure(const char* name, const std::vector<std::string_view>& stream, Route route) {
+    uint64_t routed = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (std::string_view channel : stream) {
+        routed += route(channel);
+    }
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    std::cout << name << ": " << ns / stream.size() << " ns per message (" << routed << " routed)" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const int instruments = argc > 1 ? std::atoi(argv[1]) : 1000;
+    const int messages = argc > 2 ? std::atoi(argv[2]) : 2000000;
+
+    const std::vector<std::string> channels = universe(instruments);
+    ChannelRegistry registry;
+    registry.intern(channels);
+    std::vector<uint64_t> counts(channels.size()); // Stand-in for the handler table
+
+    std::unordered_map<std::string, size_t> byName;
+    for (size_t i = 0; i < channels.size(); ++i) {
+        byName.emplace(channels[i], i);
+    }
+
+    // Notifications arrive as views into frames, in no particular order
+    std::vector<std::string_view> stream;
+    std::mt19937 random(42);
+    std::uniform_int_distribution<size_t> pick(0, channels.size() - 1);
+    for (int i = 0; i < messages; ++i) {
+        stream.push_back(channels[pick(random)]);
+    }
+
+    std::cout << channels.size() << " channels, " << messages << " messages" << std::endl;
+    if (channels.size() <= 3000) {
+        measure("prefix scan", stream, [&](std::string_view channel) {
+            for (size_t i = 0; i < channels.size(); ++i) {
+                if (channel.compare(0, channels[i].size(), channels[i]) == 0) {
+                    ++counts[i];
+                    return 1;
+                }
+            }
+            return 0;
+        });
+    }
+    measure("hash map", stream, [&](std::string_view channel) {
+        auto found = byName.find(std::string(channel));
+        if (found == byName.end()) {
+            return 0;
+        }
+        ++counts[found->second];
+        return 1;
+    });
+    std::shared_ptr<const ChannelIndex> index = registry.index();
+    measure("interned", stream, [&](std::string_view channel) {
+        const ChannelId id = index->find(channel);
+        if (id == NoChannelId) {
+            return 0;
+        }
+        ++counts[id];
+        return 1;
+    });
+    return 0;
+}
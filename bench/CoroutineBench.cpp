@@ -0,0 +1,168 @@
+// Place -> edit -> cancel chains with the coroutine API against the thread-pool path.
+//   pool  each chain runs on a ThreadPool thread as three blocking calls, so concurrency is
+//         the number of threads
+//   coro  each chain is a coroutine on one io_context thread awaiting AsyncSystem calls on the
+//         curl_multi engine, so concurrency is the number of coroutines
+// Reports chains per second and the process's peak resident and virtual memory above what it
+// used before the mode started, sampled every few milliseconds. Run it against the simulator.
+// Usage: coroutine_bench [base_url] [chains] [concurrency]
+// The access token is read from DERIBIT_TOKEN (any token works unless the simulator uses --strict-auth).
+#include "AsyncSystem.h"
+#include <boost/asio/co_spawn.hpp>
+#include <boost/asio/detached.hpp>
+#include <boost/asio/io_context.hpp>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// kB figures from /proc/self/status
+struct MemoryUsage {
+    long residentKb = 0;
+    long virtualKb = 0;
+};
+
+static MemoryUsage readMemory() {
+    MemoryUsage usage;
+    std::ifstream status("/proc/self/status");
+    std::string key;
+    long value;
+    while (status >> key) {
+        if (key == "VmRSS:" && status >> value) {
+            usage.residentKb = value;
+        } else if (key == "VmSize:" && status >> value) {
+            usage.virtualKb = value;
+        }
+    }
+    return usage;
+}
+
+// Peak memory while it is alive
+class MemorySampler {
+public:
+    MemorySampler() : baseline(readMemory()), peak(baseline), sampler([this]() {
+        while (!stopping.load()) {
+            const MemoryUsage now = readMemory();
+            peak.residentKb = std::max(peak.residentKb, now.residentKb);
+            peak.virtualKb = std::max(peak.virtualKb, now.virtualKb);
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+    }) {}
+
+    MemoryUsage stop() {
+        stopping = true;
+        sampler.join();
+        return {peak.residentKb - baseline.residentKb, peak.virtualKb - baseline.virtualKb};
+    }
+
+private:
+    MemoryUsage baseline;
+    MemoryUsage peak;
+    std::atomic<bool> stopping{false};
+    std::thread sampler;
+};
+
+static BuyRequest restingBuy(int i) {
+    BuyRequest request;
+    request.instrument = "BTC-PERPETUAL";
+    request.amount = 10.0;
+    request.price = 1000.0 + i % 100; // Far below the market, so it rests
+    request.label = "coro-bench";
+    return request;
+}
+
+static void report(const char* mode, int chains, int failed, double seconds, const MemoryUsage& memory) {
+    std::cout << mode << ": " << chains / seconds << " chains/s, " << failed << " failed, peak +"
+              << memory.residentKb / 1024.0 << " MB resident, +" << memory.virtualKb / 1024.0 << " MB virtual"
+              << std::endl;
+}
+
+static void runPool(System& system, const std::string& token, int chains, int concurrency) {
+    MemorySampler memory;
+    std::atomic<int> failed{0};
+    auto start = std::chrono::steady_clock::now();
+    {
+        ThreadPool pool(concurrency);
+        WaitGroup done;
+        for (int i = 0; i < chains; ++i) {
+            pool.post(done, [&system, &token, &failed, i]() {
+                OrderResult placed;
+                system.placeOrder(restingBuy(i), token, placed);
+                if (!placed.ok()) {
+                    ++failed;
+                    return;
+                }
+                EditRequest edit;
+                edit.orderId = std::string(placed.id());
+                edit.amount = 10.0;
+                edit.price = 900.0;
+                OrderResult edited;
+                system.modifyOrder(edit, token, edited);
+                OrderResult cancelled;
+                system.cancelOrder(CancelRequest{edit.orderId}, token, cancelled);
+                if (!edited.ok() || !cancelled.ok()) {
+                    ++failed;
+                }
+            });
+        }
+        done.wait();
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report("pool", chains, failed, seconds, memory.stop());
+}
+
+// One chain after another until the shared counter runs out
+static boost::asio::awaitable<void> chainWorker(AsyncSystem& orders, const std::string& token,
+                                                std::atomic<int>& next, int chains, std::atomic<int>& failed) {
+    for (int i = next++; i < chains; i = next++) {
+        OrderResult placed = co_await orders.placeOrder(restingBuy(i), token);
+        if (!placed.ok()) {
+            ++failed;
+            continue;
+        }
+        EditRequest edit;
+        edit.orderId = std::string(placed.id());
+        edit.amount = 10.0;
+        edit.price = 900.0;
+        OrderResult edited = co_await orders.modifyOrder(edit, token);
+        OrderResult cancelled = co_await orders.cancelOrder(CancelRequest{edit.orderId}, token);
+        if (!edited.ok() || !cancelled.ok()) {
+            ++failed;
+        }
+    }
+}
+
+static void runCoroutines(System& system, const std::string& token, int chains, int concurrency) {
+    MemorySampler memory;
+    AsyncSystem orders(system);
+    boost::asio::io_context io;
+    std::atomic<int> next{0};
+    std::atomic<int> failed{0};
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < concurrency; ++c) {
+        boost::asio::co_spawn(io, chainWorker(orders, token, next, chains, failed), boost::asio::detached);
+    }
+    io.run();
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    report("coro", chains, failed, seconds, memory.stop());
+}
+
+int main(int argc, char* argv[]) {
+    const std::string url = argc > 1 ? argv[1] : "http://127.0.0.1:8080";
+    const int chains = argc > 2 ? std::atoi(argv[2]) : 2000;
+    const int concurrency = argc > 3 ? std::atoi(argv[3]) : 256;
+    const char* tokenEnv = std::getenv("DERIBIT_TOKEN");
+    const std::string token = tokenEnv ? tokenEnv : "bench";
+
+    Connection conn(url);
+    System system(conn, 1);
+    system.setAsyncBackend(System::AsyncBackend::CurlMulti);
+
+    std::cout << chains << " place/edit/cancel chains, " << concurrency << " in flight" << std::endl;
+    runPool(system, token, chains, concurrency);
+    runCoroutines(system, token, chains, concurrency);
+    return 0;
+}
@@ -0,0 +1,128 @@
+// Per-order encode cost of a limit buy: the old unordered_map path (std::to_string values,
+// then concatenated into a query string and a JSON body as Connection::sendRequest did)
+// against RequestEncoder writing the REST target and the JSON-RPC request into reused buffers.
+// Heap allocations per order are counted through operator new.
+// Usage: encode_bench [orders]
+#include "RequestEncoder.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <unordered_map>
+
+static std::atomic<size_t> allocationCount{0};
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// The parameters as Trading::placeOrder used to build them
+static std::unordered_map<std::string, std::string> legacyParams(
+    const std::string& instrument, const std::string& type, double amount, double price, const std::string& label) {
+    std::unordered_map<std::string, std::string> params;
+    params["instrument_name"] = instrument;
+    params["type"] = type;
+    params["amount"] = std::to_string(amount);
+    if (type == "limit") {
+        params["price"] = std::to_string(price);
+    }
+    if (!label.empty()) {
+        params["label"] = label;
+    }
+    return params;
+}
+
+// The URL and body as Connection::sendRequest used to build them
+static size_t legacyEncode(const std::string& baseUrl, const std::unordered_map<std::string, std::string>& params) {
+    std::string url = baseUrl + "/api/v2/private/buy";
+    std::string data = "{";
+    for (const auto& param : params) {
+        data += "\"" + param.first + "\": \"" + param.second + "\",";
+    }
+    data.pop_back();
+    data += "}";
+    url += "?";
+    for (const auto& param : params) {
+        url += param.first + "=" + param.second + "&";
+    }
+    url.pop_back();
+    return url.size() + data.size();
+}
+
+struct Result {
+    double nsPerOrder;
+    double allocationsPerOrder;
+};
+
+template <typename F>
+static Result measure(size_t count, F&& encodeOne) {
+    for (size_t i = 0; i < 1000; ++i) {
+        encodeOne(i); // Warm-up: lets reused buffers reach their final capacity
+    }
+    const size_t before = allocationCount.load();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        encodeOne(i);
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return Result{std::chrono::duration<double, std::nano>(elapsed).count() / count,
+                  static_cast<double>(allocationCount.load() - before) / count};
+}
+
+static void report(const char* name, const Result& result) {
+    std::cout << name << result.nsPerOrder << " ns/order, " << result.allocationsPerOrder << " allocations/order\n";
+}
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    const std::string baseUrl = "https://test.deribit.com";
+    const std::string instrument = "BTC-PERPETUAL";
+    const std::string label = "bench-order";
+    size_t sink = 0;
+
+    Result legacy = measure(count, [&](size_t i) {
+        sink += legacyEncode(baseUrl, legacyParams(instrument, "limit", 10.0 + (i & 7), 50000.5 + (i & 15), label));
+    });
+
+    BuyRequest request;
+    request.instrument = instrument;
+    request.type = OrderType::Limit;
+    request.label = label;
+    std::string target;
+    std::string url;
+    Result rest = measure(count, [&](size_t i) {
+        request.amount = 10.0 + (i & 7);
+        request.price = 50000.5 + (i & 15);
+        RequestEncoder::encodeTarget(target, request);
+        url.assign(baseUrl);
+        url.append(target);
+        sink += url.size();
+    });
+
+    const std::string token = "1582628593469.1MbQ-J_4.CBP-OajkPCHQl6GHUnGWOqeR4B2AC24zNXm6Hqk8ELpDbZ5YGiZj";
+    std::string frame;
+    Result jsonRpc = measure(count, [&](size_t i) {
+        request.amount = 10.0 + (i & 7);
+        request.price = 50000.5 + (i & 15);
+        RequestEncoder::encodeJsonRpc(frame, i + 1, token, request);
+        sink += frame.size();
+    });
+
+    std::cout << "orders: " << count << "\n";
+    report("map + to_string (URL and body): ", legacy);
+    report("RequestEncoder REST target:     ", rest);
+    report("RequestEncoder JSON-RPC:        ", jsonRpc);
+    std::cout << "sample target: " << target << "\n";
+    std::cout << "sample frame:  " << frame << "\n";
+    std::cout << "bytes encoded: " << sink << std::endl;
+    return 0;
+}
@@ -0,0 +1,89 @@
+// Counts heap allocations per inbound market-data message on the listener path:
+// frame handed to a string_view handler, parsed in situ, applied to the order book.
+// The old path (copy the payload, DOM-parse with Document::Parse) is measured for comparison.
+// Heap use is counted both through operator new and through growth of the parser's
+// pools (rapidjson takes extra pool chunks from malloc). Exits non-zero if the in-situ
+// path allocates in steady state.
+// Usage: feed_alloc_bench [messages]
+#include "InsituParser.h"
+#include "OrderBook.h"
+#include "SyntheticBook.h"
+#include "rapidjson/document.h"
+#include <atomic>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static std::atomic<size_t> allocationCount{0};
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 100000;
+    const size_t warmup = 1000;
+    const std::vector<std::string> messages = syntheticStream(count + warmup);
+
+    // Stand-in for the payload buffer moved out of websocketpp; sized once up front
+    std::string frame;
+    frame.reserve(1 << 20);
+
+    size_t handlerBytes = 0;
+    auto handler = [&handlerBytes](std::string_view view) { handlerBytes += view.size(); };
+
+    // New path
+    InsituParser parser;
+    OrderBookManager books;
+    size_t valuePoolSeen = parser.valuePoolBytes(); // Both pools are reset every message and grow
+    size_t stackPoolSeen = parser.stackPoolBytes(); // only when one does not fit
+    size_t poolGrowths = 0;
+    size_t before = 0;
+    for (size_t i = 0; i < messages.size(); ++i) {
+        if (i == warmup) {
+            before = allocationCount.load();
+        }
+        frame.assign(messages[i]); // Fits the reserved capacity, so no allocation
+        handler(std::string_view(frame));
+        InsituParser::Document& document = parser.parse(frame);
+        if (i >= warmup && (parser.valuePoolBytes() > valuePoolSeen || parser.stackPoolBytes() > stackPoolSeen)) {
+            ++poolGrowths;
+        }
+        valuePoolSeen = parser.valuePoolBytes();
+        stackPoolSeen = parser.stackPoolBytes();
+        OrderBook::Result result;
+        books.apply(document["params"]["data"], result);
+    }
+    const size_t insituAllocations = allocationCount.load() - before + poolGrowths;
+
+    // Old path: copy out of the queue into a local string, then build a DOM
+    OrderBookManager oldBooks;
+    for (size_t i = 0; i < messages.size(); ++i) {
+        if (i == warmup) {
+            before = allocationCount.load();
+        }
+        std::string message = messages[i];
+        rapidjson::Document document;
+        document.Parse(message.c_str());
+        OrderBook::Result result;
+        oldBooks.apply(document["params"]["data"], result);
+    }
+    const size_t domAllocations = allocationCount.load() - before;
+
+    std::cout << "messages measured: " << count << " (after " << warmup << " warm-up)\n";
+    std::cout << "in-situ path:  " << static_cast<double>(insituAllocations) / count << " allocations/message\n";
+    std::cout << "copy + DOM:    " << static_cast<double>(domAllocations) / count << " allocations/message\n";
+    std::cout << "bytes seen by handler: " << handlerBytes << std::endl;
+
+    return insituAllocations == 0 ? 0 : 1;
+}
@@ -0,0 +1,115 @@
+// Book notifications decoded and applied to the local books by each feed parser:
+//   rapidjson  InsituParser DOM, then BookDelta::parse (the listener's default path)
+//   simdjson   SimdFeedDecoder on-demand, straight into a BookDelta (needs GOQUANT_WITH_SIMDJSON)
+// Messages come from a recording of a live session, one frame per line, e.g. written by
+//   client.setMessageHandler([&out](std::string_view frame) { out << frame << '\n'; });
+// Frames on other channels are skipped. Without a recording the synthetic BTC-PERPETUAL
+// stream is used. Exits non-zero if the two parsers leave different books.
+// Usage: feed_decode_bench [recording] [passes]
+#include "InsituParser.h"
+#include "OrderBook.h"
+#include "SimdFeedDecoder.h"
+#include "SyntheticBook.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+static std::vector<std::string> loadRecording(const char* path) {
+    std::vector<std::string> messages;
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.find("\"channel\":\"book.") != std::string::npos) {
+            messages.push_back(line);
+        }
+    }
+    return messages;
+}
+
+// Decode and apply every message passes times; the first pass is warm-up
+template <typename Apply>
+static void measure(const char* name, const std::vector<std::string>& messages, int passes, Apply apply) {
+    std::string frame;
+    frame.reserve(1 << 20); // Stand-in for the payload buffer moved out of websocketpp
+    size_t failed = 0;
+    for (const std::string& message : messages) {
+        frame.assign(message);
+        failed += !apply(frame);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass) {
+        for (const std::string& message : messages) {
+            frame.assign(message);
+            apply(frame);
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    const double count = static_cast<double>(messages.size()) * passes;
+    std::cout << name << ": " << count / seconds << " messages/s, " << seconds * 1e9 / count
+              << " ns per message (" << failed << " not decoded)" << std::endl;
+}
+
+static bool sameTop(const OrderBook* a, const OrderBook* b) {
+    if (!a || !b || a->bidDepth() != b->bidDepth() || a->askDepth() != b->askDepth()) {
+        return false;
+    }
+    const bool bidsMatch = !a->bestBid() || (a->bestBid()->price == b->bestBid()->price &&
+                                             a->bestBid()->amount == b->bestBid()->amount);
+    const bool asksMatch = !a->bestAsk() || (a->bestAsk()->price == b->bestAsk()->price &&
+                                             a->bestAsk()->amount == b->bestAsk()->amount);
+    return bidsMatch && asksMatch && a->lastChangeId() == b->lastChangeId();
+}
+
+int main(int argc, char* argv[]) {
+    const bool recorded = argc > 1;
+    const int passes = argc > 2 ? std::max(1, std::atoi(argv[2])) : 10;
+    const std::vector<std::string> messages = recorded ? loadRecording(argv[1]) : syntheticStream(100000);
+    if (messages.empty()) {
+        std::cerr << "No book notifications in " << argv[1] << std::endl;
+        return 1;
+    }
+    size_t bytes = 0;
+    for (const std::string& message : messages) {
+        bytes += message.size();
+    }
+    std::cout << messages.size() << (recorded ? " recorded" : " synthetic") << " book messages, "
+              << bytes / messages.size() << " bytes on average, " << passes << " passes" << std::endl;
+
+    InsituParser parser;
+    OrderBookManager rapidBooks;
+    measure("rapidjson", messages, passes, [&](std::string& frame) {
+        InsituParser::Document& document = parser.parse(frame);
+        if (document.HasParseError() || !document.HasMember("params") || !document["params"].HasMember("data")) {
+            return false;
+        }
+        OrderBook::Result result;
+        return rapidBooks.apply(document["params"]["data"], result) != nullptr;
+    });
+
+    if (!SimdFeedDecoder::available()) {
+        std::cout << "simdjson: not in this build (configure with -DGOQUANT_WITH_SIMDJSON=ON)" << std::endl;
+        return 0;
+    }
+    SimdFeedDecoder decoder;
+    BookDelta delta;
+    OrderBookManager simdBooks;
+    measure("simdjson", messages, passes, [&](std::string& frame) {
+        std::string_view channel;
+        if (!decoder.decodeBook(frame, channel, delta)) {
+            return false;
+        }
+        OrderBook::Result result;
+        return simdBooks.apply(delta, result) != nullptr;
+    });
+
+    // Both replayed the same stream, so the last instrument's book must agree
+    const bool match = sameTop(rapidBooks.find(delta.instrument), simdBooks.find(delta.instrument));
+    std::cout << "books " << (match ? "match" : "DIFFER") << std::endl;
+    return match ? 0 : 1;
+}
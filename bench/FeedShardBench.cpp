@@ -0,0 +1,69 @@
+// Market-data throughput against the simulator's book feed for a whole universe of
+// instruments with 1, 2, 4... pinned shard workers. (The listener-only path prints each
+// notification's propagation delay, so it is not comparable and is left out.)
+// Start the simulator with a book rate high enough to saturate the client, e.g.
+//   deribit_simulator --book-rate 2000 --depth 50
+// Usage: feed_shard_bench [host] [port] [instruments] [seconds] [max_shards]
+// Shard i is pinned to core i + 1, leaving core 0 to the network thread.
+#include "WebSocketClient.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+static std::vector<std::string> bookChannels(int instruments) {
+    std::vector<std::string> channels;
+    for (int i = 0; i < instruments; ++i) {
+        channels.push_back("book.SIM-" + std::to_string(i) + "-PERPETUAL.100ms");
+    }
+    return channels;
+}
+
+// Notifications handled per second with shards workers
+static void run(const std::string& host, const std::string& port, const std::vector<std::string>& channels,
+                int seconds, size_t shards) {
+    WebSocketClient client;
+    std::vector<int> cores(shards);
+    std::iota(cores.begin(), cores.end(), 1);
+    client.setMarketDataShards(shards, cores);
+
+    if (!client.startSession(host, port, "bench") || !client.subscribe(channels, "bench")) {
+        std::cerr << "Could not subscribe to the simulator" << std::endl;
+        return;
+    }
+
+    auto handled = [&]() {
+        const std::vector<uint64_t> counts = client.shardMessageCounts();
+        return std::accumulate(counts.begin(), counts.end(), uint64_t(0));
+    };
+    std::this_thread::sleep_for(std::chrono::seconds(1)); // Snapshots and warm-up
+    const uint64_t before = handled();
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    const uint64_t after = handled();
+
+    std::cout << shards << " shards: " << (after - before) / seconds << " notifications/s (per shard:";
+    for (uint64_t count : client.shardMessageCounts()) {
+        std::cout << ' ' << count;
+    }
+    std::cout << ")" << std::endl;
+    client.close();
+}
+
+int main(int argc, char* argv[]) {
+    const std::string host = argc > 1 ? argv[1] : "127.0.0.1";
+    const std::string port = argc > 2 ? argv[2] : "8443";
+    const int instruments = argc > 3 ? std::atoi(argv[3]) : 500;
+    const int seconds = argc > 4 ? std::max(1, std::atoi(argv[4])) : 5;
+    const size_t maxShards = argc > 5 ? std::strtoul(argv[5], nullptr, 10) : std::max(2u, std::thread::hardware_concurrency()) - 1;
+
+    const std::vector<std::string> channels = bookChannels(instruments);
+    std::cout << instruments << " book channels, " << seconds << " s per run" << std::endl;
+    for (size_t shards = 1; shards <= maxShards; shards *= 2) {
+        run(host, port, channels, seconds, shards);
+    }
+    return 0;
+}
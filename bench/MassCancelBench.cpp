@@ -0,0 +1,111 @@
+// Time to flatten a book of resting orders: one cancel per order id with cancelOrdersAsync,
+// against System::massCancel by instrument, by label prefix and by side. Each round places
+// the same book first: buys and sells in every one of a few labels. Run it against the simulator.
+// Usage: mass_cancel_bench [base_url] [orders] [threads]
+// The access token is read from DERIBIT_TOKEN (any token works unless the simulator uses --strict-auth).
+#include "System.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+static const char* const Instrument = "BTC-PERPETUAL";
+static const int LabelCount = 4;
+
+// Rest alternate buys far below the market and sells far above it, so each of the labels
+// mm-0..mm-3 holds both sides; returns the ids placed
+static std::vector<std::string> placeBook(System& system, const std::string& token, int orders) {
+    std::vector<BuyRequest> buys;
+    std::vector<SellRequest> sells;
+    for (int i = 0; i < orders; ++i) {
+        OrderRequest request;
+        request.instrument = Instrument;
+        request.amount = 10.0;
+        request.label = "mm-" + std::to_string((i / 2) % LabelCount);
+        if (i % 2 == 0) {
+            request.price = 1000.0 + i % 100;
+            buys.push_back(BuyRequest{request});
+        } else {
+            request.price = 1000000.0 + i % 100;
+            sells.push_back(SellRequest{request});
+        }
+    }
+    OrderBatch buyBatch = system.placeOrders(buys, token);
+    OrderBatch sellBatch = system.sellOrders(sells, token);
+    buyBatch.wait();
+    sellBatch.wait();
+
+    std::vector<std::string> ids;
+    for (const OrderBatch* batch : {&buyBatch, &sellBatch}) {
+        for (const OrderResult& result : batch->results()) {
+            if (result.ok()) {
+                ids.emplace_back(result.id());
+            }
+        }
+    }
+    return ids;
+}
+
+static void report(const char* mode, size_t resting, size_t requests, size_t cancelled, double ms) {
+    std::cout << mode << ": " << cancelled << "/" << resting << " cancelled in " << ms << " ms, "
+              << requests << " requests" << std::endl;
+}
+
+static void runPerOrder(System& system, const std::string& token, int orders) {
+    const std::vector<std::string> ids = placeBook(system, token, orders);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<rapidjson::Document> responses = system.cancelOrdersAsync(ids, token);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    size_t cancelled = 0;
+    for (const auto& response : responses) {
+        if (response.IsObject() && response.HasMember("result")) {
+            ++cancelled;
+        }
+    }
+    report("per order", ids.size(), ids.size(), cancelled, ms);
+}
+
+static void runMassCancel(System& system, const std::string& token, int orders, const char* mode, const OrderFilter& filter) {
+    const std::vector<std::string> ids = placeBook(system, token, orders);
+    auto start = std::chrono::steady_clock::now();
+    const System::MassCancelResult outcome = system.massCancel(filter, token);
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    if (outcome.failed) {
+        std::cerr << mode << ": " << outcome.failed << " requests failed" << std::endl;
+    }
+    report(mode, ids.size(), outcome.requests, outcome.cancelled, ms);
+}
+
+int main(int argc, char* argv[]) {
+    const std::string url = argc > 1 ? argv[1] : "http://127.0.0.1:8080";
+    const int orders = argc > 2 ? std::atoi(argv[2]) : 300;
+    const size_t threads = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 8;
+    const char* tokenEnv = std::getenv("DERIBIT_TOKEN");
+    const std::string token = tokenEnv ? tokenEnv : "bench";
+
+    Connection conn(url);
+    System system(conn, threads);
+    // Start from an empty book
+    system.cancelAllOrder(token);
+
+    std::cout << orders << " resting orders, " << threads << " threads" << std::endl;
+    runPerOrder(system, token, orders);
+
+    OrderFilter byInstrument;
+    byInstrument.instrument = Instrument;
+    runMassCancel(system, token, orders, "by instrument", byInstrument);
+
+    OrderFilter byLabel;
+    byLabel.labelPrefix = "mm-";
+    runMassCancel(system, token, orders, "by label", byLabel);
+
+    // A label is cancelled whole only when all of its open orders match; every label holds
+    // both sides, so this one falls back to single cancels for the buys
+    OrderFilter bySide;
+    bySide.instrument = Instrument;
+    bySide.buy = true;
+    runMassCancel(system, token, orders, "by side", bySide);
+    return 0;
+}
@@ -0,0 +1,87 @@
+// Replays book.{instrument}.raw notifications through OrderBook and reports the cost per update.
+// Usage: order_book_bench [recorded.jsonl] [rounds]
+// recorded.jsonl holds one raw WebSocket notification per line, starting with a snapshot.
+// Without a file a synthetic BTC-PERPETUAL stream is generated.
+#include "OrderBook.h"
+#include "SyntheticBook.h"
+#include "rapidjson/document.h"
+#include <iostream>
+#include <fstream>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdlib>
+
+int main(int argc, char* argv[]) {
+    std::vector<std::string> messages;
+    if (argc > 1) {
+        std::ifstream in(argv[1]);
+        if (!in) {
+            std::cerr << "Cannot open " << argv[1] << std::endl;
+            return 1;
+        }
+        for (std::string line; std::getline(in, line);) {
+            if (!line.empty()) {
+                messages.push_back(line);
+            }
+        }
+    } else {
+        messages = syntheticStream(200000);
+    }
+    const int rounds = argc > 2 ? std::atoi(argv[2]) : 20;
+
+    // Parse everything up front so the timed loop only measures book maintenance
+    std::vector<BookDelta> deltas;
+    deltas.reserve(messages.size());
+    size_t levelUpdates = 0;
+    for (const std::string& message : messages) {
+        rapidjson::Document doc;
+        doc.Parse(message.c_str());
+        if (doc.HasParseError() || !doc.HasMember("params") || !doc["params"].HasMember("data")) {
+            continue;
+        }
+        BookDelta delta;
+        if (delta.parse(doc["params"]["data"])) {
+            levelUpdates += delta.snapshot ? 0 : delta.bids.size() + delta.asks.size();
+            deltas.push_back(std::move(delta));
+        }
+    }
+    if (deltas.empty() || !deltas.front().snapshot) {
+        std::cerr << "Stream must start with a snapshot" << std::endl;
+        return 1;
+    }
+
+    OrderBook book(deltas.front().instrument);
+    size_t gaps = 0;
+    std::chrono::nanoseconds total(0);
+    for (int round = 0; round < rounds; ++round) {
+        book.apply(deltas.front());
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 1; i < deltas.size(); ++i) {
+            if (book.apply(deltas[i]) == OrderBook::Result::Gap) {
+                ++gaps;
+            }
+        }
+        total += std::chrono::steady_clock::now() - start;
+    }
+
+    const double messagesApplied = static_cast<double>(deltas.size() - 1) * rounds;
+    std::cout << "messages: " << deltas.size() - 1 << " x " << rounds << " rounds, level updates per round: " << levelUpdates << "\n";
+    std::cout << "apply: " << total.count() / messagesApplied << " ns/message, "
+              << total.count() / (static_cast<double>(levelUpdates) * rounds) << " ns/level update\n";
+    std::cout << "gaps: " << gaps << ", final depth: " << book.bidDepth() << " bids / " << book.askDepth() << " asks\n";
+
+    // Parse + apply, as the listener thread does it
+    OrderBookManager manager;
+    auto start = std::chrono::steady_clock::now();
+    for (const std::string& message : messages) {
+        rapidjson::Document doc;
+        doc.Parse(message.c_str());
+        OrderBook::Result result;
+        manager.apply(doc["params"]["data"], result);
+    }
+    auto parseApply = std::chrono::steady_clock::now() - start;
+    std::cout << "parse + apply: " << std::chrono::duration<double, std::nano>(parseApply).count() / messages.size()
+              << " ns/message" << std::endl;
+    return 0;
+}
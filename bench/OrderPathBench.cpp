@@ -0,0 +1,322 @@
+// Order-path latency benchmark. Drives System/Trading against a configurable endpoint and
+// reports latency percentiles from an HDR-style histogram for each dispatch mode:
+//   sync   System::placeOrder on the calling thread, one order at a time
+//   pool   System::placeOrder on a ThreadPool (what the ThreadPool async backend does)
+//   multi  Trading::placeOrderAsync on the curl_multi RequestEngine
+//   ws     WebSocketClient::buy as JSON-RPC on an authenticated WebSocket
+// Load is closed-loop by default (--rate 0: keep --concurrency orders in flight) or open-loop
+// (--rate R: start an order every 1/R seconds whether or not earlier ones have completed).
+// Open-loop latency is measured from each order's scheduled start, so time spent waiting
+// behind a slow response is counted instead of hidden.
+//
+// Usage: order_path_bench [--url URL] [--modes sync,pool,multi,ws] [--orders N] [--warmup N]
+//                         [--rate R] [--concurrency C] [--instrument NAME] [--amount A]
+//                         [--price P] [--ws-host HOST] [--ws-port PORT] [--no-cancel]
+//                         [--format text|csv|json] [--output FILE]
+// The access token is read from DERIBIT_TOKEN. Orders are limit buys at --price (default far
+// below the market so they rest), and open orders are cancelled after each mode.
+#include "System.h"
+#include "Trading.h"
+#include "RequestEngine.h"
+#include "ThreadPool.h"
+#include "WebSocketClient.h"
+#include "OrderResponseDecoder.h"
+#include "LatencyHistogram.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Options {
+    std::string url = "https://test.deribit.com";
+    std::vector<std::string> modes = {"sync", "pool", "multi"};
+    size_t orders = 1000;
+    size_t warmup = 20;
+    double rate = 0.0;
+    size_t concurrency = 8;
+    std::string instrument = "ETH-PERPETUAL";
+    double amount = 1.0;
+    double price = 100.0;
+    std::string wsHost = "test.deribit.com";
+    std::string wsPort = "443";
+    bool cancel = true;
+    std::string format = "text";
+    std::string output;
+};
+
+struct RunResult {
+    std::string mode;
+    size_t concurrency = 0;
+    size_t orders = 0;
+    uint64_t errors = 0;
+    double seconds = 0.0;
+    uint64_t newConnections = 0;
+    uint64_t reusedConnections = 0;
+    std::unique_ptr<LatencyHistogram> latency = std::make_unique<LatencyHistogram>();
+};
+
+// Completion of one order: ok is false for transport failures and exchange errors
+using Done = std::function<void(bool ok)>;
+// Starts one order; may complete inline (sync) or later from another thread
+using Submit = std::function<void(Done done)>;
+
+static std::vector<std::string> split(const std::string& list) {
+    std::vector<std::string> parts;
+    std::stringstream in(list);
+    for (std::string part; std::getline(in, part, ',');) {
+        if (!part.empty()) {
+            parts.push_back(part);
+        }
+    }
+    return parts;
+}
+
+static bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--no-cancel") {
+            options.cancel = false;
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        const std::string value = argv[++i];
+        if (arg == "--url") options.url = value;
+        else if (arg == "--modes") options.modes = split(value);
+        else if (arg == "--orders") options.orders = std::strtoul(value.c_str(), nullptr, 10);
+        else if (arg == "--warmup") options.warmup = std::strtoul(value.c_str(), nullptr, 10);
+        else if (arg == "--rate") options.rate = std::atof(value.c_str());
+        else if (arg == "--concurrency") options.concurrency = std::max<size_t>(1, std::strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--instrument") options.instrument = value;
+        else if (arg == "--amount") options.amount = std::atof(value.c_str());
+        else if (arg == "--price") options.price = std::atof(value.c_str());
+        else if (arg == "--ws-host") options.wsHost = value;
+        else if (arg == "--ws-port") options.wsPort = value;
+        else if (arg == "--format") options.format = value;
+        else if (arg == "--output") options.output = value;
+        else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+// Run `orders` orders through submit, recording each latency in histogram.
+// Closed loop waits for a free slot before starting the next order; open loop starts
+// orders on a fixed schedule and measures from the scheduled time.
+static void drive(const Options& options, size_t orders, size_t slots, const Submit& submit,
+                  LatencyHistogram& histogram, std::atomic<uint64_t>& errors) {
+    std::mutex mutex;
+    std::condition_variable changed;
+    size_t inFlight = 0;
+    size_t completed = 0;
+
+    const bool openLoop = options.rate > 0.0;
+    const auto interval = std::chrono::nanoseconds(openLoop ? static_cast<int64_t>(1e9 / options.rate) : 0);
+    const auto start = std::chrono::steady_clock::now();
+
+    for (size_t i = 0; i < orders; ++i) {
+        std::chrono::steady_clock::time_point intended;
+        if (openLoop) {
+            intended = start + interval * static_cast<int64_t>(i);
+            std::this_thread::sleep_until(intended);
+        } else {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&]() { return inFlight < slots; });
+            intended = std::chrono::steady_clock::now();
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++inFlight;
+        }
+        submit([&, intended](bool ok) {
+            const auto elapsed = std::chrono::steady_clock::now() - intended;
+            histogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+            if (!ok) {
+                errors.fetch_add(1, std::memory_order_relaxed);
+            }
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                --inFlight;
+                ++completed;
+            }
+            changed.notify_all();
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(mutex);
+    changed.wait(lock, [&]() { return completed == orders; });
+}
+
+// Warm up, then measure one mode
+static RunResult runMode(const Options& options, const std::string& mode, size_t slots, const Submit& submit, Connection& conn) {
+    RunResult result;
+    result.mode = mode;
+    result.concurrency = options.rate > 0.0 ? 0 : slots;
+    result.orders = options.orders;
+
+    // Warm-up pays for DNS, TLS handshakes and first-use allocations outside the measurement
+    LatencyHistogram warmupLatency;
+    std::atomic<uint64_t> warmupErrors{0};
+    Options closedLoop = options;
+    closedLoop.rate = 0.0;
+    drive(closedLoop, options.warmup, slots, submit, warmupLatency, warmupErrors);
+
+    conn.resetPoolStats();
+    std::atomic<uint64_t> errors{0};
+    auto start = std::chrono::steady_clock::now();
+    drive(options, options.orders, slots, submit, *result.latency, errors);
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.errors = errors.load();
+
+    const Connection::PoolStats stats = conn.getPoolStats();
+    result.newConnections = stats.newConnections;
+    result.reusedConnections = stats.reusedConnections;
+    return result;
+}
+
+static const double reportedPercentiles[] = {50.0, 90.0, 99.0, 99.9};
+
+static void writeText(std::ostream& out, const Options& options, const std::vector<RunResult>& results) {
+    out << "endpoint: " << options.url << ", load: "
+        << (options.rate > 0.0 ? "open loop at " + std::to_string(options.rate) + " orders/s" : "closed loop") << "\n";
+    for (const RunResult& result : results) {
+        const LatencyHistogram& h = *result.latency;
+        out << result.mode << ": " << result.orders << " orders, " << result.errors << " errors, "
+            << result.orders / result.seconds << " orders/s"
+            << " | p50 " << h.percentile(50.0) << " ns, p90 " << h.percentile(90.0)
+            << " ns, p99 " << h.percentile(99.0) << " ns, p99.9 " << h.percentile(99.9)
+            << " ns, max " << h.max() << " ns"
+            << " | connections new " << result.newConnections << " reused " << result.reusedConnections << "\n";
+    }
+}
+
+static void writeCsv(std::ostream& out, const Options& options, const std::vector<RunResult>& results) {
+    out << "mode,load,rate,concurrency,orders,errors,seconds,throughput,min_ns,mean_ns,p50_ns,p90_ns,p99_ns,p999_ns,max_ns,"
+           "new_connections,reused_connections\n";
+    for (const RunResult& result : results) {
+        const LatencyHistogram& h = *result.latency;
+        out << result.mode << ',' << (options.rate > 0.0 ? "open" : "closed") << ',' << options.rate << ','
+            << result.concurrency << ',' << result.orders << ',' << result.errors << ',' << result.seconds << ','
+            << result.orders / result.seconds << ',' << h.min() << ',' << h.mean();
+        for (double p : reportedPercentiles) {
+            out << ',' << h.percentile(p);
+        }
+        out << ',' << h.max() << ',' << result.newConnections << ',' << result.reusedConnections << '\n';
+    }
+}
+
+static void writeJson(std::ostream& out, const Options& options, const std::vector<RunResult>& results) {
+    out << "{\"url\":\"" << options.url << "\",\"load\":\"" << (options.rate > 0.0 ? "open" : "closed")
+        << "\",\"rate\":" << options.rate << ",\"runs\":[";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const RunResult& result = results[i];
+        const LatencyHistogram& h = *result.latency;
+        out << (i ? "," : "") << "{\"mode\":\"" << result.mode << "\",\"concurrency\":" << result.concurrency
+            << ",\"orders\":" << result.orders << ",\"errors\":" << result.errors << ",\"seconds\":" << result.seconds
+            << ",\"throughput\":" << result.orders / result.seconds << ",\"min_ns\":" << h.min()
+            << ",\"mean_ns\":" << h.mean() << ",\"p50_ns\":" << h.percentile(50.0) << ",\"p90_ns\":" << h.percentile(90.0)
+            << ",\"p99_ns\":" << h.percentile(99.0) << ",\"p999_ns\":" << h.percentile(99.9) << ",\"max_ns\":" << h.max()
+            << ",\"new_connections\":" << result.newConnections << ",\"reused_connections\":" << result.reusedConnections << "}";
+    }
+    out << "]}\n";
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+    const char* envToken = std::getenv("DERIBIT_TOKEN");
+    if (!envToken) {
+        std::cerr << "Set DERIBIT_TOKEN to an access token" << std::endl;
+        return 1;
+    }
+    const std::string token = envToken;
+
+    BuyRequest request;
+    request.instrument = options.instrument;
+    request.type = OrderType::Limit;
+    request.amount = options.amount;
+    request.price = options.price;
+
+    Connection conn(options.url);
+    System system(conn, options.concurrency);
+    std::vector<RunResult> results;
+
+    for (const std::string& mode : options.modes) {
+        if (mode == "sync") {
+            results.push_back(runMode(options, mode, 1, [&](Done done) {
+                OrderResult result;
+                system.placeOrder(request, token, result);
+                done(result.ok());
+            }, conn));
+        } else if (mode == "pool") {
+            ThreadPool pool(options.concurrency);
+            results.push_back(runMode(options, mode, options.concurrency, [&](Done done) {
+                pool.enqueue([&system, &request, &token, done]() {
+                    OrderResult result;
+                    system.placeOrder(request, token, result);
+                    done(result.ok());
+                });
+            }, conn));
+        } else if (mode == "multi") {
+            RequestEngine engine(options.url);
+            Trading trading(conn);
+            trading.setEngine(&engine);
+            results.push_back(runMode(options, mode, options.concurrency, [&](Done done) {
+                trading.placeOrderAsync(request, token, [done](const OrderResult& result) { done(result.ok()); });
+            }, conn));
+        } else if (mode == "ws") {
+            WebSocketClient client;
+            client.setMessageHandler([](std::string_view) {});
+            if (!client.startSession(options.wsHost, options.wsPort, token)) {
+                std::cerr << "Skipping ws: cannot connect to " << options.wsHost << ":" << options.wsPort << std::endl;
+                continue;
+            }
+            results.push_back(runMode(options, mode, options.concurrency, [&](Done done) {
+                client.buy(request, [done](rapidjson::Document&& response) {
+                    OrderResult result;
+                    OrderResponseDecoder::fromDocument(response, result);
+                    done(result.ok());
+                });
+            }, conn));
+            client.close();
+        } else {
+            std::cerr << "Unknown mode " << mode << std::endl;
+            continue;
+        }
+        if (options.cancel) {
+            system.cancelAllOrder(token);
+        }
+    }
+
+    std::ofstream file;
+    if (!options.output.empty()) {
+        file.open(options.output);
+        if (!file) {
+            std::cerr << "Cannot write " << options.output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& out = options.output.empty() ? std::cout : file;
+    if (options.format == "csv") {
+        writeCsv(out, options, results);
+    } else if (options.format == "json") {
+        writeJson(out, options, results);
+    } else {
+        writeText(out, options, results);
+    }
+    return 0;
+}
@@ -0,0 +1,109 @@
+// Measures RateLimiter's acquire cost, then sends bursts of orders to the simulator with no
+// limiter, a rejecting one and a queueing one, counting the too_many_requests the server returns.
+// Start the simulator with --rate-limit so it enforces the same credits as the exchange.
+// Usage: rate_limiter_bench [base_url] [orders] [threads]
+// The access token is read from DERIBIT_TOKEN (any token works unless the simulator uses --strict-auth).
+#include "System.h"
+#include "RateLimiter.h"
+#include <iostream>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+#include <tuple>
+
+// ns per acquire with threadCount threads taking credits from one bucket that never runs dry
+static void measureAcquire(int threadCount) {
+    RateLimiter limiter({1e12, 1e12, 1.0}, RateLimiter::defaultConfig(RateLimiter::Bucket::NonMatchingEngine));
+    const int perThread = 2000000 / threadCount;
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&limiter, perThread]() {
+            for (int i = 0; i < perThread; ++i) {
+                limiter.acquire(RateLimiter::Bucket::MatchingEngine);
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    std::cout << "acquire, " << threadCount << " thread" << (threadCount > 1 ? "s" : " ") << ": "
+              << ns / (perThread * threadCount) << " ns/op" << std::endl;
+}
+
+// Send one burst of limit orders that rest, and count what the server accepted and refused
+static void runBurst(System& system, RateLimiter* limiter, const char* name, const std::string& token,
+                     const std::vector<std::tuple<std::string, std::string, double, double, std::string>>& orders) {
+    system.setRateLimiter(limiter);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<rapidjson::Document> responses = system.placeOrdersAsync(token, orders);
+    auto end = std::chrono::steady_clock::now();
+
+    size_t ok = 0;
+    size_t tooManyRequests = 0;
+    for (const auto& response : responses) {
+        if (response.IsObject() && response.HasMember("result")) {
+            ++ok;
+        } else if (response.IsObject() && response.HasMember("error") && response["error"].IsObject()
+                   && response["error"].HasMember("code") && response["error"]["code"].IsInt()
+                   && response["error"]["code"].GetInt() == 10028) {
+            ++tooManyRequests;
+        }
+    }
+
+    const double ms = std::chrono::duration<double, std::milli>(end - start).count();
+    std::cout << name << ": " << orders.size() << " orders in " << ms << " ms, " << ok << " accepted, "
+              << tooManyRequests << " too_many_requests";
+    if (limiter) {
+        const RateLimiter::Stats stats = limiter->stats(RateLimiter::Bucket::MatchingEngine);
+        std::cout << " (" << stats.rejected << " rejected locally, " << stats.throttled << " queued for "
+                  << stats.waitedNs / 1000000 << " ms in total, " << stats.credits << " credits left)";
+    }
+    std::cout << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const std::string baseUrl = argc > 1 ? argv[1] : "http://127.0.0.1:8080";
+    const int orderCount = argc > 2 ? std::atoi(argv[2]) : 40;
+    const size_t threadCount = argc > 3 ? std::strtoul(argv[3], nullptr, 10) : 8;
+
+    const char* token = std::getenv("DERIBIT_TOKEN");
+    if (!token) {
+        std::cerr << "Set DERIBIT_TOKEN to an access token" << std::endl;
+        return 1;
+    }
+
+    for (int threads : {1, 2, 4, 8}) {
+        measureAcquire(threads);
+    }
+
+    std::vector<std::tuple<std::string, std::string, double, double, std::string>> orders;
+    for (int i = 0; i < orderCount; ++i) {
+        orders.emplace_back("BTC-PERPETUAL", "limit", 10, 20000, "bench" + std::to_string(i));
+    }
+
+    Connection conn(baseUrl);
+    System system(conn, threadCount);
+    RateLimiter rejecting(RateLimiter::Policy::Reject);
+    RateLimiter queueing(RateLimiter::Policy::Queue);
+    queueing.setMaxWait(std::chrono::seconds(60));
+
+    // The server's matching-engine bucket takes capacity / refill to fill up again after a burst
+    const RateLimiter::BucketConfig matching = RateLimiter::defaultConfig(RateLimiter::Bucket::MatchingEngine);
+    const auto refill = std::chrono::milliseconds(static_cast<int64_t>(matching.capacity / matching.refillPerSecond * 1000) + 500);
+
+    runBurst(system, nullptr, "no limiter", token, orders);
+    std::this_thread::sleep_for(refill);
+    runBurst(system, &rejecting, "reject    ", token, orders);
+    std::this_thread::sleep_for(refill);
+    runBurst(system, &queueing, "queue     ", token, orders);
+    system.setRateLimiter(nullptr);
+    return 0;
+}
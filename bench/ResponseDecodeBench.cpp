@@ -0,0 +1,86 @@
+// Cost of turning an order response into the fields the trading path uses: a full
+// rapidjson::Document probed with HasMember (the DOM API) against OrderResponseDecoder's
+// SAX handler filling an OrderResult. Reports time and memory per response.
+// Usage: response_decode_bench [responses]
+#include "OrderResponseDecoder.h"
+#include "rapidjson/document.h"
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <string>
+
+static std::atomic<size_t> allocationCount{0};
+
+void* operator new(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+// private/buy response with one fill, shaped like the exchange's
+static const char* buyResponse =
+    R"({"jsonrpc":"2.0","id":5275,"result":{"trades":[{"trade_seq":1966056,"trade_id":"ETH-2696083","timestamp":1590483938456,)"
+    R"("tick_direction":0,"state":"filled","reduce_only":false,"price":203.3,"post_only":false,"order_type":"market",)"
+    R"("order_id":"ETH-584849853","matching_id":null,"mark_price":203.28,"liquidity":"T","label":"market0000234",)"
+    R"("instrument_name":"ETH-PERPETUAL","index_price":203.33,"fee_currency":"ETH","fee":0.00014757,"direction":"buy",)"
+    R"("amount":40}],"order":{"web":false,"time_in_force":"good_til_cancelled","replaced":false,"reduce_only":false,)"
+    R"("price":207.3,"post_only":false,"order_type":"market","order_state":"filled","order_id":"ETH-584849853",)"
+    R"("max_show":40,"last_update_timestamp":1590483938456,"label":"market0000234","is_liquidation":false,)"
+    R"("instrument_name":"ETH-PERPETUAL","filled_amount":40,"direction":"buy","creation_timestamp":1590483938456,)"
+    R"("commission":0.00014757,"average_price":203.3,"api":true,"amount":40}},"usIn":1590483938456000,)"
+    R"("usOut":1590483938459000,"usDiff":3000,"testnet":true})";
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    const std::string body = buyResponse;
+    double sink = 0.0;
+
+    // DOM: parse everything, then probe for the fields
+    size_t domPoolBytes = 0;
+    size_t before = allocationCount.load();
+    auto start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        rapidjson::Document doc;
+        doc.Parse(body.c_str());
+        if (doc.HasMember("result") && doc["result"].HasMember("order")) {
+            const rapidjson::Value& order = doc["result"]["order"];
+            std::string orderId = order["order_id"].GetString();
+            std::string state = order["order_state"].GetString();
+            sink += order["filled_amount"].GetDouble() + order["average_price"].GetDouble() + orderId.size() + state.size();
+        }
+        domPoolBytes = doc.GetAllocator().Size();
+    }
+    auto domTime = std::chrono::steady_clock::now() - start;
+    const size_t domAllocations = allocationCount.load() - before;
+
+    // SAX: only the wanted fields are stored
+    OrderResult result;
+    OrderResponseDecoder::decode(body, result); // Warm-up grows the reader's stack once
+    before = allocationCount.load();
+    start = std::chrono::steady_clock::now();
+    for (size_t i = 0; i < count; ++i) {
+        OrderResponseDecoder::decode(body, result);
+        sink += result.filledAmount + result.averagePrice + std::strlen(result.orderId);
+    }
+    auto saxTime = std::chrono::steady_clock::now() - start;
+    const size_t saxAllocations = allocationCount.load() - before;
+
+    std::cout << "responses: " << count << " (" << body.size() << " bytes each)\n";
+    std::cout << "DOM + HasMember: " << std::chrono::duration<double, std::nano>(domTime).count() / count << " ns/response, "
+              << domPoolBytes << " bytes of DOM values (plus the malloc'd pool and stack), "
+              << static_cast<double>(domAllocations) / count << " operator new/response\n";
+    std::cout << "SAX OrderResult: " << std::chrono::duration<double, std::nano>(saxTime).count() / count << " ns/response, "
+              << sizeof(OrderResult) << " bytes of result, "
+              << static_cast<double>(saxAllocations) / count << " operator new/response\n";
+    std::cout << "decoded: " << result.id() << " " << toString(result.state) << " filled " << result.filledAmount
+              << " @ " << result.averagePrice << " (checksum " << sink << ")" << std::endl;
+    return 0;
+}
@@ -0,0 +1,85 @@
+// Cost of RiskCheck::checkOrder on the order path: every limit enabled, for orders that pass
+// and give their open-order slot straight back, orders refused by each limit, and several
+// threads checking orders on their own instruments at once. The rejection table at the end
+// is the same report the trade menu prints.
+// Usage: risk_check_bench [checks]
+#include "RiskCheck.h"
+#include "InstrumentCache.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+static RiskCheck::Limits benchLimits() {
+    RiskCheck::Limits limits;
+    limits.maxOrderAmount = 1000.0;
+    limits.maxNotional = 5e7;
+    limits.maxOpenOrders = 100;
+    limits.priceBand = 0.05;
+    return limits;
+}
+
+static BuyRequest benchOrder(InstrumentId id, double amount, double price) {
+    BuyRequest request;
+    request.instrument = "BTC-PERPETUAL";
+    request.instrumentId = id;
+    request.amount = amount;
+    request.price = price;
+    return request;
+}
+
+// ns per check with threadCount threads, each on its own instrument
+static void measure(RiskCheck& risk, const char* name, const BuyRequest& order, int threadCount, int checks) {
+    const int perThread = checks / threadCount;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int t = 0; t < threadCount; ++t) {
+        threads.emplace_back([&risk, &order, t, perThread]() {
+            BuyRequest request = order;
+            request.instrumentId = static_cast<InstrumentId>(t);
+            for (int i = 0; i < perThread; ++i) {
+                if (risk.checkOrder(request.instrumentId, request) == RiskCheck::Result::Ok) {
+                    risk.orderClosed(request.instrumentId);
+                }
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    const double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    std::cout << name << ", " << threadCount << " thread" << (threadCount > 1 ? "s" : " ") << ": "
+              << ns / (perThread * threadCount) << " ns/check" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    const int checks = argc > 1 ? std::atoi(argv[1]) : 4000000;
+
+    InstrumentCache instruments;
+    RiskCheck risk(instruments);
+    risk.setDefaultLimits(benchLimits());
+    for (InstrumentId id = 0; id < 8; ++id) {
+        risk.setReferencePrice(id, 50000.0);
+    }
+
+    measure(risk, "pass, no message rate", benchOrder(0, 10.0, 50100.0), 1, checks);
+    risk.setMessageRate(1e12, 1e6); // Enabled but never exhausted, to include its cost
+    measure(risk, "pass", benchOrder(0, 10.0, 50100.0), 1, checks);
+    measure(risk, "reject amount", benchOrder(0, 5000.0, 50100.0), 1, checks);
+    measure(risk, "reject notional", benchOrder(0, 900.0, 60000.0), 1, checks);
+    measure(risk, "reject band", benchOrder(0, 10.0, 60000.0), 1, checks);
+    for (int threads : {2, 4, 8}) {
+        measure(risk, "pass", benchOrder(0, 10.0, 50100.0), threads, checks);
+    }
+
+    // A real message rate: a tight loop is refused once the burst is spent
+    risk.setMessageRate(1000.0, 50.0);
+    measure(risk, "message rate 1000/s", benchOrder(0, 10.0, 50100.0), 1, checks / 10);
+
+    std::cout << std::endl;
+    risk.write(std::cout);
+    return 0;
+}
@@ -0,0 +1,103 @@
+// Enqueue-to-dequeue latency of the on_message -> listener hand-off for each wait strategy,
+// compared with the old mutex-protected std::queue polled with a 10 ms sleep.
+// Usage: spsc_ring_bench [messages] [messages_per_second]
+#include "SpscRing.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <vector>
+
+struct Message {
+    std::string payload;
+    int64_t enqueuedNs = 0;
+};
+
+static int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static void report(const char* name, std::vector<int64_t>& latencies) {
+    std::sort(latencies.begin(), latencies.end());
+    auto at = [&](double q) { return latencies[static_cast<size_t>(q * (latencies.size() - 1))]; };
+    std::cout << name << ": p50 " << at(0.50) << " ns, p99 " << at(0.99) << " ns, p99.9 " << at(0.999)
+              << " ns, max " << latencies.back() << " ns" << std::endl;
+}
+
+// Producer paced at a fixed rate so the numbers show hand-off latency, not queue build-up
+template<typename Push>
+static void produce(size_t count, int64_t intervalNs, Push push) {
+    const std::string payload(300, 'x'); // Roughly the size of a book change notification
+    int64_t next = nowNs();
+    for (size_t i = 0; i < count; ++i) {
+        while (nowNs() < next) {
+        }
+        push(Message{payload, nowNs()});
+        next += intervalNs;
+    }
+}
+
+static void runRing(const char* name, WaitStrategy strategy, size_t count, int64_t intervalNs) {
+    SpscRing<Message> ring(8192, strategy);
+    std::atomic<bool> running{true};
+    std::vector<int64_t> latencies;
+    latencies.reserve(count);
+
+    std::thread consumer([&]() {
+        Message message;
+        while (latencies.size() < count && ring.pop(message, running)) {
+            latencies.push_back(nowNs() - message.enqueuedNs);
+        }
+    });
+    produce(count, intervalNs, [&](Message&& message) { ring.push(std::move(message)); });
+    consumer.join();
+    report(name, latencies);
+}
+
+// The previous WebSocketClient hand-off, kept here as the baseline
+static void runMutexQueue(size_t count, int64_t intervalNs) {
+    std::queue<Message> queue;
+    std::mutex queueMutex;
+    std::vector<int64_t> latencies;
+    latencies.reserve(count);
+
+    std::thread consumer([&]() {
+        while (latencies.size() < count) {
+            std::unique_lock<std::mutex> lock(queueMutex);
+            if (!queue.empty()) {
+                Message message = queue.front();
+                queue.pop();
+                lock.unlock();
+                latencies.push_back(nowNs() - message.enqueuedNs);
+            } else {
+                lock.unlock();
+                std::this_thread::sleep_for(std::chrono::milliseconds(10));
+            }
+        }
+    });
+    produce(count, intervalNs, [&](Message&& message) {
+        std::lock_guard<std::mutex> lock(queueMutex);
+        queue.push(std::move(message));
+    });
+    consumer.join();
+    report("mutex queue + 10ms sleep", latencies);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t count = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200000;
+    const double rate = argc > 2 ? std::atof(argv[2]) : 50000.0;
+    const int64_t intervalNs = static_cast<int64_t>(1e9 / rate);
+
+    std::cout << count << " messages at " << rate << " msg/s" << std::endl;
+    runRing("busy-spin", WaitStrategy::BusySpin, count, intervalNs);
+    runRing("spin-then-yield", WaitStrategy::SpinYield, count, intervalNs);
+    runRing("park (condvar)", WaitStrategy::Park, count, intervalNs);
+    runMutexQueue(std::min<size_t>(count, 2000), intervalNs);
+    return 0;
+}
@@ -0,0 +1,93 @@
+#ifndef SYNTHETIC_BOOK_H
+#define SYNTHETIC_BOOK_H
+
+// Synthetic book.{instrument}.raw notification stream shared by the benchmarks
+#include "OrderBook.h"
+#include <sstream>
+#include <random>
+#include <map>
+#include <string>
+#include <vector>
+
+// Serialize one side of a synthetic notification
+inline void writeSide(std::ostringstream& out, const std::vector<LevelUpdate>& updates) {
+    out << "[";
+    for (size_t i = 0; i < updates.size(); ++i) {
+        const char* action = updates[i].action == LevelUpdate::Action::New ? "new"
+                           : updates[i].action == LevelUpdate::Action::Change ? "change" : "delete";
+        out << (i ? "," : "") << "[\"" << action << "\"," << updates[i].price << "," << updates[i].amount << "]";
+    }
+    out << "]";
+}
+
+inline std::string notification(bool snapshot, int64_t changeId, int64_t timestamp,
+                                const std::vector<LevelUpdate>& bids, const std::vector<LevelUpdate>& asks) {
+    std::ostringstream out;
+    out.precision(10);
+    out << "{\"jsonrpc\":\"2.0\",\"method\":\"subscription\",\"params\":{\"channel\":\"book.BTC-PERPETUAL.raw\",\"data\":{"
+        << "\"type\":\"" << (snapshot ? "snapshot" : "change") << "\",\"timestamp\":" << timestamp
+        << ",\"instrument_name\":\"BTC-PERPETUAL\",\"change_id\":" << changeId;
+    if (!snapshot) {
+        out << ",\"prev_change_id\":" << changeId - 1;
+    }
+    out << ",\"bids\":";
+    writeSide(out, bids);
+    out << ",\"asks\":";
+    writeSide(out, asks);
+    out << "}}}";
+    return out.str();
+}
+
+// Build a snapshot plus a stream of changes concentrated near the top of the book, like a live feed
+inline std::vector<std::string> syntheticStream(size_t changes) {
+    const double tick = 0.5;
+    const double mid = 30000.0;
+    const int depth = 500;
+    std::mt19937_64 rng(42);
+    std::geometric_distribution<int> levelFromTop(0.25);
+    std::uniform_real_distribution<double> size(10.0, 50000.0);
+    std::uniform_int_distribution<int> coin(0, 9);
+
+    std::map<double, double> bids;
+    std::map<double, double> asks;
+    std::vector<LevelUpdate> bidUpdates;
+    std::vector<LevelUpdate> askUpdates;
+    for (int i = 1; i <= depth; ++i) {
+        bids[mid - i * tick] = size(rng);
+        asks[mid + i * tick] = size(rng);
+        bidUpdates.push_back({LevelUpdate::Action::New, mid - i * tick, bids[mid - i * tick]});
+        askUpdates.push_back({LevelUpdate::Action::New, mid + i * tick, asks[mid + i * tick]});
+    }
+
+    std::vector<std::string> messages;
+    int64_t changeId = 1000;
+    int64_t timestamp = 1700000000000;
+    messages.push_back(notification(true, changeId, timestamp, bidUpdates, askUpdates));
+
+    for (size_t n = 0; n < changes; ++n) {
+        bidUpdates.clear();
+        askUpdates.clear();
+        const bool bidSide = coin(rng) < 5;
+        auto& book = bidSide ? bids : asks;
+        auto& updates = bidSide ? bidUpdates : askUpdates;
+        const double best = bidSide ? bids.rbegin()->first : asks.begin()->first;
+        const double price = bidSide ? best - levelFromTop(rng) * tick : best + levelFromTop(rng) * tick;
+
+        auto it = book.find(price);
+        const int roll = coin(rng);
+        if (it == book.end()) {
+            book[price] = size(rng);
+            updates.push_back({LevelUpdate::Action::New, price, book[price]});
+        } else if (roll < 2 && book.size() > 50) {
+            book.erase(it);
+            updates.push_back({LevelUpdate::Action::Delete, price, 0.0});
+        } else {
+            it->second = size(rng);
+            updates.push_back({LevelUpdate::Action::Change, price, it->second});
+        }
+        messages.push_back(notification(false, ++changeId, ++timestamp, bidUpdates, askUpdates));
+    }
+    return messages;
+}
+
+#endif // SYNTHETIC_BOOK_H
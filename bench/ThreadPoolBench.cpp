@@ -0,0 +1,159 @@
+// Producer contention on ThreadPool: 1 to 64 threads each submit a share of a fixed number of
+// small tasks, and the run ends when every task has completed. Compared are the previous
+// single-queue pool (one mutex and condition variable, a shared_ptr<packaged_task> per
+// enqueue), the work-stealing pool through the same enqueue() call, and its post() and bulk()
+// paths with a WaitGroup instead of futures.
+// Usage: thread_pool_bench [tasks] [workers]
+#include "ThreadPool.h"
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <string>
+#include <vector>
+
+// The pool as it was before the work-stealing rewrite, kept as the baseline
+class MutexThreadPool {
+public:
+    MutexThreadPool(size_t threadCount) : running_(true) {
+        for (size_t i = 0; i < threadCount; ++i) {
+            workers.emplace_back([this]() { workerThread(); });
+        }
+    }
+
+    ~MutexThreadPool() {
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            running_ = false;
+        }
+        condition_.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    template<typename F, typename... Args>
+    auto enqueue(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
+        using return_type = std::invoke_result_t<F, Args...>;
+        auto task = std::make_shared<std::packaged_task<return_type()>>(
+            std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+        std::future<return_type> res = task->get_future();
+        {
+            std::unique_lock<std::mutex> lock(queueMutex_);
+            if (!running_) {
+                throw std::runtime_error("enqueue on stopped ThreadPool");
+            }
+            taskQueue_.push([task]() { (*task)(); });
+        }
+        condition_.notify_one();
+        return res;
+    }
+
+private:
+    void workerThread() {
+        while (true) {
+            std::function<void()> task;
+            {
+                std::unique_lock<std::mutex> lock(queueMutex_);
+                condition_.wait(lock, [this]() { return !taskQueue_.empty() || !running_; });
+                if (!running_ && taskQueue_.empty()) {
+                    return;
+                }
+                task = std::move(taskQueue_.front());
+                taskQueue_.pop();
+            }
+            task();
+        }
+    }
+
+    std::vector<std::thread> workers;
+    std::queue<std::function<void()>> taskQueue_;
+    std::mutex queueMutex_;
+    std::condition_variable condition_;
+    bool running_;
+};
+
+// A few dozen nanoseconds of work, so queueing dominates
+static int smallTask(int seed) {
+    int x = seed;
+    for (int i = 0; i < 16; ++i) {
+        x = x * 31 + 7;
+    }
+    return x;
+}
+
+// Tasks per second with producers threads submitting through submit(producer, first, count)
+template<typename Submit>
+static double measure(int producers, int tasks, Submit submit) {
+    const int perProducer = tasks / producers;
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; ++p) {
+        threads.emplace_back([&submit, p, perProducer]() { submit(p * perProducer, perProducer); });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    auto end = std::chrono::steady_clock::now();
+    return perProducer * producers / std::chrono::duration<double>(end - start).count();
+}
+
+int main(int argc, char* argv[]) {
+    const int tasks = argc > 1 ? std::atoi(argv[1]) : 640000;
+    const size_t workerCount = argc > 2 ? std::strtoul(argv[2], nullptr, 10)
+                                        : std::max(4u, std::thread::hardware_concurrency());
+
+    std::cout << "Workers: " << workerCount << ", tasks per run: " << tasks << "\n"
+              << "Million tasks/s (higher is better)\n"
+              << std::setw(10) << "producers" << std::setw(14) << "mutex pool" << std::setw(12) << "enqueue"
+              << std::setw(12) << "post" << std::setw(12) << "bulk" << "\n";
+
+    MutexThreadPool mutexPool(workerCount);
+    ThreadPool pool(workerCount);
+
+    for (int producers : {1, 2, 4, 8, 16, 32, 64}) {
+        const double mutexRate = measure(producers, tasks, [&mutexPool](int first, int count) {
+            std::vector<std::future<int>> futures;
+            futures.reserve(count);
+            for (int i = 0; i < count; ++i) {
+                futures.push_back(mutexPool.enqueue(smallTask, first + i));
+            }
+            for (auto& future : futures) {
+                future.get();
+            }
+        });
+
+        const double enqueueRate = measure(producers, tasks, [&pool](int first, int count) {
+            std::vector<std::future<int>> futures;
+            futures.reserve(count);
+            for (int i = 0; i < count; ++i) {
+                futures.push_back(pool.enqueue(smallTask, first + i));
+            }
+            for (auto& future : futures) {
+                future.get();
+            }
+        });
+
+        const double postRate = measure(producers, tasks, [&pool](int first, int count) {
+            std::vector<int> results(count);
+            WaitGroup done;
+            for (int i = 0; i < count; ++i) {
+                pool.post(done, [&results, first, i]() { results[i] = smallTask(first + i); });
+            }
+            done.wait();
+        });
+
+        const double bulkRate = measure(producers, tasks, [&pool](int first, int count) {
+            std::vector<int> results(count);
+            WaitGroup done;
+            pool.bulk(count, [&results, first](size_t i) { results[i] = smallTask(first + static_cast<int>(i)); }, done);
+            done.wait();
+        });
+
+        std::cout << std::fixed << std::setprecision(2) << std::setw(10) << producers
+                  << std::setw(14) << mutexRate / 1e6 << std::setw(12) << enqueueRate / 1e6
+                  << std::setw(12) << postRate / 1e6 << std::setw(12) << bulkRate / 1e6 << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,82 @@
+#ifndef AMEND_COALESCER_H
+#define AMEND_COALESCER_H
+
+#include "OrderRequests.h"
+#include "OrderResult.h"
+#include "Trading.h"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Outbound stage for edits that arrive faster than the exchange acknowledges them. Each order
+// has at most one edit in flight and one waiting behind it; a newer edit for the same order is
+// merged into the waiting one (last writer wins per field) instead of becoming a request of its
+// own. Every caller's callback gets the response of the edit that carried its fields.
+// The waiting edit is sent through post rather than from the thread completing the one in
+// flight, which is usually the engine's I/O thread: a rate-limit wait there would stall every
+// transfer. If that response shows the order is gone, the waiting edit is dropped and its
+// callers get the same response.
+class AmendCoalescer {
+public:
+    // Sends one edit and reports its response
+    using Send = std::function<void(const EditRequest& request, const std::string& token, Trading::ResultCallback onResult)>;
+
+    // Runs a promoted edit's send off the completing thread; null sends it inline
+    using Post = std::function<void(std::function<void()> work)>;
+
+    explicit AmendCoalescer(Send send, Post post = nullptr);
+    // Waits for every edit to complete
+    ~AmendCoalescer();
+
+    AmendCoalescer(const AmendCoalescer&) = delete;
+    AmendCoalescer& operator=(const AmendCoalescer&) = delete;
+
+    // onResult may be null; otherwise it runs on the completing thread and must not block
+    void modify(const EditRequest& request, const std::string& token, Trading::ResultCallback onResult);
+
+    // Block until no edit is in flight or waiting
+    void wait() const;
+    // Orders with an edit in flight
+    size_t active() const;
+
+    uint64_t submitted() const { return submittedCount.load(std::memory_order_relaxed); }
+    uint64_t sent() const { return sentCount.load(std::memory_order_relaxed); }
+    // Edits merged into a waiting one
+    uint64_t absorbed() const { return absorbedCount.load(std::memory_order_relaxed); }
+    // Edits left waiting and never sent because the order had closed
+    uint64_t dropped() const { return droppedCount.load(std::memory_order_relaxed); }
+
+private:
+    struct Waiting {
+        EditRequest request;
+        std::string token;
+        std::vector<Trading::ResultCallback> callers;
+    };
+
+    struct Entry {
+        std::vector<Trading::ResultCallback> inFlight; // Callers of the edit in flight
+        std::optional<Waiting> waiting;
+    };
+
+    static void merge(EditRequest& into, const EditRequest& newer);
+    void dispatch(const EditRequest& request, const std::string& token);
+    void finished(const std::string& orderId, const OrderResult& result);
+
+    const Send send;
+    const Post post;
+    mutable std::mutex mutex;
+    mutable std::condition_variable idle;
+    std::unordered_map<std::string, Entry> orders;
+    std::atomic<uint64_t> submittedCount{0};
+    std::atomic<uint64_t> sentCount{0};
+    std::atomic<uint64_t> absorbedCount{0};
+    std::atomic<uint64_t> droppedCount{0};
+};
+
+#endif // AMEND_COALESCER_H
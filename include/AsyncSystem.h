@@ -0,0 +1,56 @@
+#ifndef ASYNC_SYSTEM_H
+#define ASYNC_SYSTEM_H
+
+#include "System.h"
+#include <utility> // Before asio: some Boost versions use std::exchange in awaitable.hpp without it
+#include <boost/asio/associated_executor.hpp>
+#include <boost/asio/async_result.hpp>
+#include <boost/asio/awaitable.hpp>
+#include <boost/asio/post.hpp>
+#include <boost/asio/use_awaitable.hpp>
+#include <memory>
+#include <string>
+
+// Awaitable order entry for C++20 coroutines on an asio io_context (built with
+// GOQUANT_WITH_COROUTINES):
+//     OrderResult placed = co_await orders.placeOrder(request, token);
+// Requests go out on System's curl_multi engine and the coroutine resumes on the executor it
+// awaited from, so one io_context thread can keep thousands of orders in flight and chain
+// place, edit and cancel without parking a thread per request.
+// The request and token are read when the call starts, so they must live until it is awaited;
+// co_await the call directly and temporaries are fine.
+class AsyncSystem {
+public:
+    template<typename T>
+    using Awaitable = boost::asio::awaitable<T>;
+
+    explicit AsyncSystem(System& system) : system(system) {}
+
+    Awaitable<OrderResult> placeOrder(const BuyRequest& request, const std::string& token);
+    Awaitable<OrderResult> sellOrder(const SellRequest& request, const std::string& token);
+    Awaitable<OrderResult> modifyOrder(const EditRequest& request, const std::string& token);
+    Awaitable<OrderResult> cancelOrder(const CancelRequest& request, const std::string& token);
+
+    System& getSystem() { return system; }
+
+private:
+    // Start a System call that reports through a Trading::ResultCallback, and complete the
+    // awaiting coroutine with its result on the coroutine's own executor
+    template<typename Start>
+    static Awaitable<OrderResult> await(Start start) {
+        return boost::asio::async_initiate<const boost::asio::use_awaitable_t<>&, void(OrderResult)>(
+            [start = std::move(start)](auto handler) mutable {
+                auto executor = boost::asio::get_associated_executor(handler);
+                // ResultCallback must be copyable and the handler is move-only
+                auto shared = std::make_shared<decltype(handler)>(std::move(handler));
+                start([shared, executor](const OrderResult& result) {
+                    boost::asio::post(executor, [shared, result]() mutable { std::move(*shared)(result); });
+                });
+            },
+            boost::asio::use_awaitable);
+    }
+
+    System& system;
+};
+
+#endif // ASYNC_SYSTEM_H
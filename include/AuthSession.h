@@ -0,0 +1,87 @@
+#ifndef AUTH_SESSION_H
+#define AUTH_SESSION_H
+
+#include "Connection.h"
+#include "rapidjson/document.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class WebSocketClient;
+
+// Owns the OAuth tokens for one API key. start() authenticates with client credentials, then
+// a background thread refreshes with the refresh token once refreshFraction of the token's
+// lifetime has passed, well before it expires. Each refresh atomically swaps in new
+// credentials and Connection's pre-built Authorization header, so callers on the order path
+// only ever copy a pointer and never wait for a refresh.
+class AuthSession {
+public:
+    using Clock = std::chrono::steady_clock;
+
+    struct Credentials {
+        std::string accessToken;
+        std::string refreshToken;
+        Clock::time_point expiresAt;
+        std::chrono::seconds lifetime{0};
+    };
+
+    // Runs on the refresh thread after new credentials are installed
+    using RefreshHandler = std::function<void(const Credentials&)>;
+
+    AuthSession(Connection& conn, std::string clientId, std::string clientSecret, double refreshFraction = 0.5);
+    ~AuthSession();
+
+    AuthSession(const AuthSession&) = delete;
+    AuthSession& operator=(const AuthSession&) = delete;
+
+    // Authenticate (blocking) and start the refresh thread; false if no token was obtained
+    bool start();
+    void stop();
+
+    // Current credentials, null before start() succeeds
+    std::shared_ptr<const Credentials> credentials() const { return std::atomic_load(&current); }
+
+    // Current access token, empty before start() succeeds
+    std::string token() const;
+
+    // Refresh over this WebSocket while it is connected, so the connection is re-authenticated
+    // in place and keeps its subscriptions; REST is used otherwise. Pass null to detach.
+    void attachWebSocket(WebSocketClient* client);
+
+    void setRefreshHandler(RefreshHandler handler);
+
+    uint64_t refreshCount() const { return refreshes.load(std::memory_order_relaxed); }
+    uint64_t failedRefreshCount() const { return failedRefreshes.load(std::memory_order_relaxed); }
+
+private:
+    bool authenticate();
+    bool refreshOverRest(const std::string& refreshToken);
+    bool refreshOverWebSocket(WebSocketClient& client, const std::string& refreshToken);
+    bool install(const rapidjson::Value& response);
+    void run();
+
+    Connection& conn;
+    const std::string clientId;
+    const std::string clientSecret;
+    const double refreshFraction;
+
+    // Only accessed through std::atomic_load/std::atomic_store
+    std::shared_ptr<const Credentials> current;
+
+    std::mutex mutex; // Guards webSocket, refreshHandler and stopping
+    std::condition_variable wakeUp;
+    WebSocketClient* webSocket = nullptr;
+    RefreshHandler refreshHandler;
+    bool stopping = false;
+    std::thread refreshThread;
+
+    std::atomic<uint64_t> refreshes{0};
+    std::atomic<uint64_t> failedRefreshes{0};
+};
+
+#endif // AUTH_SESSION_H
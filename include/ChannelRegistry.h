@@ -0,0 +1,103 @@
+#ifndef CHANNEL_REGISTRY_H
+#define CHANNEL_REGISTRY_H
+
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Dense id of a subscription channel interned by ChannelRegistry
+using ChannelId = uint32_t;
+constexpr ChannelId NoChannelId = UINT32_MAX;
+
+// Immutable map from channel names to ids. At build time it picks the few byte positions
+// that tell the channels apart (for book.BTC-27DEC24-60000-C.100ms, the kind, currency,
+// expiry, strike and put/call bytes); a lookup reads the name's length and those bytes into
+// one key, probes an open-addressed table with it and confirms the match with a single
+// memcmp. Nothing walks or hashes the whole name, and a miss usually costs no comparison.
+class ChannelIndex {
+public:
+    // names[i] gets id i; names must be distinct
+    explicit ChannelIndex(std::vector<std::string> names);
+
+    // NoChannelId if channel is not in the index
+    ChannelId find(std::string_view channel) const {
+        const uint64_t key = keyOf(channel);
+        for (size_t slot = slotOf(key);; slot = (slot + 1) & mask) {
+            const Slot& entry = slots[slot];
+            if (entry.id == NoChannelId) {
+                return NoChannelId;
+            }
+            if (entry.key == key && entry.length == channel.size() &&
+                std::memcmp(text.data() + entry.offset, channel.data(), channel.size()) == 0) {
+                return entry.id;
+            }
+        }
+    }
+
+    const std::string& name(ChannelId id) const { return names[id]; }
+    size_t size() const { return names.size(); }
+
+private:
+    static constexpr size_t MaxPositions = 7; // Bytes in a key, after the length byte
+
+    struct Slot {
+        uint64_t key = 0;
+        uint32_t offset = 0;        // Name in text
+        uint32_t length = 0;
+        ChannelId id = NoChannelId; // NoChannelId for an empty slot
+    };
+
+    uint64_t keyOf(std::string_view channel) const {
+        uint64_t key = static_cast<uint8_t>(channel.size());
+        for (size_t i = 0; i < positionCount; ++i) {
+            const uint64_t byte = positions[i] < channel.size() ? static_cast<uint8_t>(channel[positions[i]]) : 0;
+            key |= byte << (8 * (i + 1));
+        }
+        return key;
+    }
+    size_t slotOf(uint64_t key) const { return static_cast<size_t>((key * 0x9E3779B97F4A7C15ull) >> shift); }
+
+    void choosePositions();
+
+    std::vector<std::string> names;
+    uint32_t positions[MaxPositions] = {};
+    size_t positionCount = 0;
+    std::vector<Slot> slots;
+    size_t mask = 0;
+    unsigned shift = 63;
+    std::string text; // Every name, back to back
+};
+
+// Channels interned to dense ids that never change, so subscribers can be kept in arrays
+// indexed by ChannelId. Interning rebuilds and publishes a new ChannelIndex; lookups use the
+// published one without a lock.
+class ChannelRegistry {
+public:
+    ChannelRegistry();
+
+    ChannelRegistry(const ChannelRegistry&) = delete;
+    ChannelRegistry& operator=(const ChannelRegistry&) = delete;
+
+    // Id of channel, adding it if needed
+    ChannelId intern(std::string_view channel);
+    // Same for many channels, with a single rebuild
+    std::vector<ChannelId> intern(const std::vector<std::string>& channels);
+
+    ChannelId find(std::string_view channel) const { return index()->find(channel); }
+    std::string name(ChannelId id) const;
+    size_t size() const { return index()->size(); }
+
+    // Current index, for callers that look up many channels or must see one consistent set
+    std::shared_ptr<const ChannelIndex> index() const;
+
+private:
+    std::mutex mutex; // Serialises writers
+    // Only accessed through std::atomic_load/std::atomic_store
+    std::shared_ptr<const ChannelIndex> current;
+};
+
+#endif // CHANNEL_REGISTRY_H
@@ -3,13 +3,50 @@
 
 #include <string>
 #include <unordered_map>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <chrono>
+#include <memory>
+#include <curl/curl.h>
 #include "rapidjson/document.h"
+#include "RequestTimings.h"
+#include "RateLimiter.h"
 
 class Connection {
-private:
-    std::string baseUrl;
 public:
-    Connection(const std::string& baseUrl);
+    // How curl easy handles are managed between requests
+    enum class Mode {
+        PerRequest, // New handle per request: fresh DNS lookup, TCP connect and TLS handshake every time
+        Pooled      // Reuse keep-alive handles that share a DNS/TLS-session/connection cache
+    };
+
+    // Counters used to confirm connection reuse under load
+    struct PoolStats {
+        uint64_t requests = 0;          // Requests performed
+        uint64_t handlesCreated = 0;    // curl easy handles created
+        uint64_t handlesReused = 0;     // Requests served by an already created handle
+        uint64_t newConnections = 0;    // Requests that had to open a new TCP/TLS connection
+        uint64_t reusedConnections = 0; // Requests sent on an already open connection
+    };
+
+    // Header list for one bearer token, built once and shared by every request that sends it
+    struct AuthHeaders {
+        explicit AuthHeaders(const std::string& token) : token(token), list(buildHeaders(token)) {}
+        ~AuthHeaders() { curl_slist_free_all(list); }
+        AuthHeaders(const AuthHeaders&) = delete;
+        AuthHeaders& operator=(const AuthHeaders&) = delete;
+
+        const std::string token;
+        struct curl_slist* const list;
+    };
+
+    Connection(const std::string& baseUrl, Mode mode = Mode::Pooled);
+    ~Connection();
+
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
 
     rapidjson::Document sendRequest(
         const std::string& endpoint,
@@ -17,8 +54,90 @@ public:
         const std::string& method,
         const std::string& token = "");
 
+    // GET a target encoded by RequestEncoder (API path plus query string)
+    rapidjson::Document sendEncoded(const std::string& target, const std::string& token = "");
+
+    // Same, but hands back the raw body for a typed decoder; false if no response was received
+    bool sendEncoded(const std::string& target, const std::string& token, std::string& response);
+
+    // Mode switch, safe to call while requests are in flight
+    void setMode(Mode newMode) { mode = newMode; }
+    Mode getMode() const { return mode; }
+
+    PoolStats getPoolStats() const;
+    void resetPoolStats();
+
+    // Requests sent with headers->token use this list instead of building their own.
+    // Swapped atomically (AuthSession does it on refresh); requests in flight keep the old one.
+    void setAuthHeaders(std::shared_ptr<const AuthHeaders> headers) { std::atomic_store(&authHeaders, std::move(headers)); }
+
+    // Requests take their credits from this limiter before they are sent; a rejected request
+    // gets the exchange's too_many_requests error as its response. Null (the default) disables it.
+    void setRateLimiter(RateLimiter* limiter) { rateLimiter.store(limiter, std::memory_order_relaxed); }
+    RateLimiter* getRateLimiter() const { return rateLimiter.load(std::memory_order_relaxed); }
+
+    // Per-endpoint stage latencies of every request sent through this connection
+    RequestTimings& timings() { return requestTimings; }
+    const RequestTimings& timings() const { return requestTimings; }
+
+    const std::string& getBaseUrl() const { return baseUrl; }
+
+    // Helpers shared with RequestEngine so both paths put the same bytes on the wire
+    static void appendQuery(std::string& url, const std::unordered_map<std::string, std::string>& params);
+    static struct curl_slist* buildHeaders(const std::string& token);
+    static rapidjson::Document parseResponse(const std::string& response);
+
 private:
+    // A reusable easy handle together with the header list built for it
+    struct PooledHandle {
+        CURL* curl = nullptr;
+        struct curl_slist* headers = nullptr; // Pre-built header list for headerToken
+        std::string headerToken;              // Token the header list was built for
+        bool hasHeaders = false;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    // started is when the caller entered Connection, the start of the Build stage
+    rapidjson::Document perform(
+        const std::string& url, const std::string& method, const std::string& data, const std::string& token,
+        Clock::time_point started);
+    bool transfer(
+        const std::string& url, const std::string& method, const std::string& data, const std::string& token,
+        std::string& response, Clock::time_point started);
+    void recordTimings(CURL* curl, const std::string& url, Clock::time_point started, Clock::time_point handedOff);
+    PooledHandle* acquireHandle();
+    void releaseHandle(PooledHandle* handle);
+    struct curl_slist* headersFor(PooledHandle* handle, const std::string& token);
+    void recordConnection(CURL* curl);
+
     static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp);
+    static void lockShare(CURL* handle, curl_lock_data data, curl_lock_access access, void* userp);
+    static void unlockShare(CURL* handle, curl_lock_data data, void* userp);
+
+    std::string baseUrl;
+    std::atomic<Mode> mode;
+
+    // DNS, TLS session and connection cache shared by every pooled handle
+    CURLSH* share;
+    std::mutex shareLocks[CURL_LOCK_DATA_LAST];
+
+    // Idle handles waiting to be checked out
+    std::mutex poolMutex;
+    std::vector<PooledHandle*> idleHandles;
+    std::vector<PooledHandle*> allHandles;
+
+    std::atomic<uint64_t> requestCount{0};
+    std::atomic<uint64_t> handlesCreated{0};
+    std::atomic<uint64_t> handlesReused{0};
+    std::atomic<uint64_t> newConnections{0};
+    std::atomic<uint64_t> reusedConnections{0};
+
+    RequestTimings requestTimings;
+    std::atomic<RateLimiter*> rateLimiter{nullptr};
+
+    // Only accessed through std::atomic_load/std::atomic_store
+    std::shared_ptr<const AuthHeaders> authHeaders;
 };
 
 #endif
@@ -0,0 +1,69 @@
+#ifndef INSITU_PARSER_H
+#define INSITU_PARSER_H
+
+#include <string>
+#include <memory>
+#include "rapidjson/document.h"
+
+// Reusable in-situ JSON parser for inbound WebSocket frames.
+// Strings are parsed in place inside the frame buffer (no DOM string copies), and
+// both the DOM values and the parser stack come from pools backed by buffers owned
+// by this object. Those pools are reset, not freed, between messages. A message that
+// does not fit spills into heap chunks, and the next parse replaces the buffers with
+// ones large enough for it, so once a message of the largest size seen has been
+// parsed, parsing allocates nothing.
+class InsituParser {
+public:
+    using Document = rapidjson::GenericDocument<
+        rapidjson::UTF8<>, rapidjson::MemoryPoolAllocator<>, rapidjson::MemoryPoolAllocator<>>;
+
+    explicit InsituParser(size_t valueBytes = 256 * 1024, size_t stackBytes = 64 * 1024)
+        : pools(std::make_unique<Pools>(valueBytes, stackBytes)) {}
+
+    InsituParser(const InsituParser&) = delete;
+    InsituParser& operator=(const InsituParser&) = delete;
+
+    // Parse buffer in place. The buffer is modified, must stay alive while the
+    // document is used, and the document is only valid until the next parse().
+    Document& parse(std::string& buffer) {
+        // The last message spilled; double what it took, leaving room for each chunk's unused tail
+        if (pools->valueAllocator.Capacity() > pools->valueBytes || pools->stackAllocator.Capacity() > pools->stackBytes) {
+            pools = std::make_unique<Pools>(2 * pools->valueAllocator.Capacity(), 2 * pools->stackAllocator.Capacity());
+        }
+        // Drops values of the previous message; keeps the user buffer. The document gives its
+        // stack back after every parse, but only Clear() lets the stack pool reuse it.
+        pools->valueAllocator.Clear();
+        pools->stackAllocator.Clear();
+        pools->document.ParseInsitu(&buffer[0]);
+        return pools->document;
+    }
+
+    // Bytes held by each pool; anything beyond the owned buffers came from the heap
+    size_t valuePoolBytes() const { return pools->valueAllocator.Capacity(); }
+    size_t stackPoolBytes() const { return pools->stackAllocator.Capacity(); }
+
+private:
+    // Replaced as a whole when a buffer grows, since the document points at the allocators
+    struct Pools {
+        Pools(size_t valueBytes, size_t stackBytes)
+            : valueBytes(valueBytes),
+              stackBytes(stackBytes),
+              valueBuffer(new char[valueBytes]),
+              stackBuffer(new char[stackBytes]),
+              valueAllocator(valueBuffer.get(), valueBytes),
+              stackAllocator(stackBuffer.get(), stackBytes),
+              document(&valueAllocator, stackBytes / 4, &stackAllocator) {}
+
+        size_t valueBytes;
+        size_t stackBytes;
+        std::unique_ptr<char[]> valueBuffer;
+        std::unique_ptr<char[]> stackBuffer;
+        rapidjson::MemoryPoolAllocator<> valueAllocator;
+        rapidjson::MemoryPoolAllocator<> stackAllocator;
+        Document document;
+    };
+
+    std::unique_ptr<Pools> pools;
+};
+
+#endif // INSITU_PARSER_H
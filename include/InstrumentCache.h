@@ -0,0 +1,100 @@
+#ifndef INSTRUMENT_CACHE_H
+#define INSTRUMENT_CACHE_H
+
+#include "OrderRequests.h"
+#include "rapidjson/document.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Reference data of one instrument, as get_instruments reports it
+struct InstrumentSpec {
+    enum class Kind : uint8_t { Unknown, Future, Option, Spot, FutureCombo, OptionCombo };
+
+    char name[64] = {};
+    char baseCurrency[8] = {};
+    char settlementCurrency[8] = {};
+    Kind kind = Kind::Unknown;
+    bool inverse = false;         // Coin-margined: amounts in USD, PnL in the coin
+    bool active = true;
+    double tickSize = 0.0;
+    double contractSize = 0.0;
+    double minTradeAmount = 0.0;
+    int64_t expiration = 0;       // expiration_timestamp, ms
+};
+
+// Every instrument of the loaded currencies, interned to dense ids so the order path can
+// validate and round with an array index instead of string lookups or requests.
+// Ids are handed out in load order and never reused; the cache file keeps them stable
+// across warm starts. Specs are immutable once published: a changed instrument gets a new
+// spec swapped in, so get() is one atomic load from any thread.
+class InstrumentCache {
+public:
+    static constexpr size_t MaxInstruments = 16384;
+
+    // Why check() refused an order
+    enum class Check { Ok, Inactive, BelowMinimum, NotContractMultiple, OffTick, MissingPrice };
+    static const char* toString(Check check);
+
+    InstrumentCache();
+    ~InstrumentCache();
+
+    InstrumentCache(const InstrumentCache&) = delete;
+    InstrumentCache& operator=(const InstrumentCache&) = delete;
+
+    // Add or update the instruments of a get_instruments result; returns how many were added
+    size_t apply(const rapidjson::Value& instruments);
+
+    // Id of a name, NoInstrumentId if it was never loaded
+    InstrumentId find(std::string_view name) const;
+    InstrumentId find(const std::string& name) const; // Same, without copying the name
+
+    // Spec for an id, null if unknown; lock-free
+    const InstrumentSpec* get(InstrumentId id) const {
+        return id < MaxInstruments ? specs[id].load(std::memory_order_acquire) : nullptr;
+    }
+
+    size_t size() const { return count.load(std::memory_order_acquire); }
+
+    // Whether any instrument with this base or settlement currency is loaded
+    bool hasCurrency(std::string_view currency) const;
+
+    // Price on the tick grid, toward the passive side (down for buys, up for sells)
+    double roundPrice(InstrumentId id, double price, bool buy) const;
+    // Amount down to a multiple of the minimum trade amount
+    double roundAmount(InstrumentId id, double amount) const;
+
+    // Set request.instrumentId and round its price and amount as above; false if the
+    // instrument is unknown
+    bool normalize(OrderRequest& request, bool buy) const;
+
+    // Validate against tick size and minimum amount; Ok for instruments that were never loaded,
+    // which are left to the exchange
+    Check check(const OrderRequest& request) const;
+    Check check(const OrderRequest& request, InstrumentId id) const; // id already looked up
+
+    // Compact binary snapshot for warm starts. load() rejects files older than maxAge or
+    // written with a different layout, and must run before anything else is loaded.
+    bool save(const std::string& path) const;
+    bool load(const std::string& path, std::chrono::seconds maxAge);
+
+private:
+    InstrumentId publish(const InstrumentSpec& spec);
+
+    std::unique_ptr<std::atomic<const InstrumentSpec*>[]> specs;
+    std::atomic<size_t> count{0};
+
+    // Name index and every spec ever published (replaced ones included, so readers holding
+    // an old pointer stay valid); writers only, plus find()
+    mutable std::shared_mutex mutex;
+    std::unordered_map<std::string, InstrumentId> ids;
+    std::vector<std::unique_ptr<InstrumentSpec>> storage;
+};
+
+#endif // INSTRUMENT_CACHE_H
@@ -0,0 +1,125 @@
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <algorithm>
+
+// HDR-style log-linear histogram of nanosecond values.
+// Each power of two is split into 64 linear sub-buckets, so any recorded value is
+// reported within 1/64 (~1.6%) of its true value, from 1 ns up to the full uint64 range.
+// Buckets are relaxed atomics: record() is lock-free and may be called from any
+// number of threads while another thread reads percentiles.
+class LatencyHistogram {
+public:
+    static constexpr int SubBucketBits = 7;                     // Values below 2^7 are exact
+    static constexpr uint64_t SubBuckets = 1ull << SubBucketBits;
+    static constexpr uint64_t HalfSubBuckets = SubBuckets / 2;
+    static constexpr size_t BucketCount = (64 - SubBucketBits + 2) * HalfSubBuckets;
+
+    LatencyHistogram() { reset(); }
+
+    LatencyHistogram(const LatencyHistogram&) = delete;
+    LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+    void record(uint64_t valueNs) {
+        counts[indexOf(valueNs)].fetch_add(1, std::memory_order_relaxed);
+        total.fetch_add(1, std::memory_order_relaxed);
+        sum.fetch_add(valueNs, std::memory_order_relaxed);
+        uint64_t seen = maxValue.load(std::memory_order_relaxed);
+        while (valueNs > seen && !maxValue.compare_exchange_weak(seen, valueNs, std::memory_order_relaxed)) {
+        }
+        seen = minValue.load(std::memory_order_relaxed);
+        while (valueNs < seen && !minValue.compare_exchange_weak(seen, valueNs, std::memory_order_relaxed)) {
+        }
+    }
+
+    uint64_t count() const { return total.load(std::memory_order_relaxed); }
+    uint64_t max() const { return maxValue.load(std::memory_order_relaxed); }
+    uint64_t min() const { return count() ? minValue.load(std::memory_order_relaxed) : 0; }
+    double mean() const { return count() ? static_cast<double>(sum.load(std::memory_order_relaxed)) / count() : 0.0; }
+
+    // Smallest bucket bound at or below which `percentile` percent of values fall (0-100)
+    uint64_t percentile(double percentile) const {
+        const uint64_t n = count();
+        if (n == 0) {
+            return 0;
+        }
+        const double clamped = std::min(std::max(percentile, 0.0), 100.0);
+        const uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(clamped / 100.0 * n + 0.5));
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BucketCount; ++i) {
+            seen += counts[i].load(std::memory_order_relaxed);
+            if (seen >= rank) {
+                return std::min(highestEquivalent(i), max());
+            }
+        }
+        return max();
+    }
+
+    // Add every value recorded in other
+    void merge(const LatencyHistogram& other) {
+        for (size_t i = 0; i < BucketCount; ++i) {
+            if (uint64_t c = other.counts[i].load(std::memory_order_relaxed)) {
+                counts[i].fetch_add(c, std::memory_order_relaxed);
+            }
+        }
+        total.fetch_add(other.count(), std::memory_order_relaxed);
+        sum.fetch_add(other.sum.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        if (other.count()) {
+            uint64_t seen = maxValue.load(std::memory_order_relaxed);
+            while (other.max() > seen && !maxValue.compare_exchange_weak(seen, other.max(), std::memory_order_relaxed)) {
+            }
+            seen = minValue.load(std::memory_order_relaxed);
+            while (other.min() < seen && !minValue.compare_exchange_weak(seen, other.min(), std::memory_order_relaxed)) {
+            }
+        }
+    }
+
+    // Not atomic with respect to concurrent record() calls
+    void reset() {
+        for (auto& bucket : counts) {
+            bucket.store(0, std::memory_order_relaxed);
+        }
+        total.store(0, std::memory_order_relaxed);
+        sum.store(0, std::memory_order_relaxed);
+        maxValue.store(0, std::memory_order_relaxed);
+        minValue.store(UINT64_MAX, std::memory_order_relaxed);
+    }
+
+    // Bucket layout: [0, 128) one value each, then 64 buckets per power of two
+    static size_t indexOf(uint64_t value) {
+        if (value < SubBuckets) {
+            return static_cast<size_t>(value);
+        }
+        const int msb = 63 - __builtin_clzll(value);
+        const int shift = msb - SubBucketBits + 1;
+        return static_cast<size_t>(shift) * HalfSubBuckets + static_cast<size_t>(value >> shift);
+    }
+
+    static uint64_t lowestEquivalent(size_t index) {
+        if (index < SubBuckets) {
+            return index;
+        }
+        const int shift = static_cast<int>(index / HalfSubBuckets) - 1;
+        return (index % HalfSubBuckets + HalfSubBuckets) << shift;
+    }
+
+    static uint64_t highestEquivalent(size_t index) {
+        if (index < SubBuckets) {
+            return index;
+        }
+        const int shift = static_cast<int>(index / HalfSubBuckets) - 1;
+        return lowestEquivalent(index) + ((1ull << shift) - 1);
+    }
+
+private:
+    std::array<std::atomic<uint64_t>, BucketCount> counts;
+    std::atomic<uint64_t> total{0};
+    std::atomic<uint64_t> sum{0};
+    std::atomic<uint64_t> maxValue{0};
+    std::atomic<uint64_t> minValue{UINT64_MAX};
+};
+
+#endif // LATENCY_HISTOGRAM_H
@@ -0,0 +1,75 @@
+#ifndef ORDER_BATCH_H
+#define ORDER_BATCH_H
+
+#include "OrderResult.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Handle to a batch of orders submitted together by System::placeOrders/sellOrders/cancelOrders.
+// Results stream in as each response arrives: through the batch's callback, through next() in
+// arrival order, or all at once after wait(). Copies of the handle share the same batch.
+class OrderBatch {
+public:
+    // Runs on a pool or I/O thread as each request completes; must not block
+    using Callback = std::function<void(size_t index, const OrderResult& result)>;
+
+    struct Completion {
+        size_t index = 0; // Position of the request in the submitted batch
+        OrderResult result;
+    };
+
+    OrderBatch() = default;
+
+    size_t size() const;
+    size_t completed() const;
+    bool done() const { return completed() == size(); }
+
+    void wait() const;
+    // False if the batch is still running after timeout
+    bool waitFor(std::chrono::milliseconds timeout) const;
+
+    // The next result in arrival order, waiting for one if needed; false once every result
+    // has been returned. Meant for one consuming thread.
+    bool next(Completion& out);
+
+    // Requests not yet sent complete with a local error instead. On the curl_multi backend the
+    // whole batch is handed to the engine at once, so only the thread pool has any left to stop.
+    void cancel();
+    bool isCancelled() const;
+
+    // Results by request index; only meaningful once done()
+    const std::vector<OrderResult>& results() const;
+
+private:
+    friend class System;
+
+    struct State {
+        State(size_t count, const std::string& token, Callback onResult);
+
+        void complete(size_t index, const OrderResult& result);
+
+        const std::string token; // Shared by every request of the batch
+        const Callback onResult;
+        std::atomic<bool> cancelled{false};
+        WaitGroup poolChunks;    // Chunks queued on the thread pool
+
+        mutable std::mutex mutex;
+        mutable std::condition_variable arrived;
+        std::vector<OrderResult> results;
+        std::vector<size_t> arrivals; // Completed indices in arrival order
+        size_t readPosition = 0;      // Next arrival next() returns
+    };
+
+    explicit OrderBatch(std::shared_ptr<State> state) : state(std::move(state)) {}
+
+    std::shared_ptr<State> state;
+};
+
+#endif // ORDER_BATCH_H
@@ -0,0 +1,97 @@
+#ifndef ORDER_BOOK_H
+#define ORDER_BOOK_H
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <cstdint>
+#include "rapidjson/document.h"
+
+// One aggregated price level
+struct PriceLevel {
+    double price;
+    double amount;
+};
+
+// One entry of a Deribit book notification: ["new"|"change"|"delete", price, amount]
+struct LevelUpdate {
+    enum class Action : uint8_t { New, Change, Delete };
+    Action action;
+    double price;
+    double amount;
+};
+
+// A parsed book.{instrument}.{interval} notification
+struct BookDelta {
+    std::string instrument;
+    bool snapshot = false;
+    int64_t timestamp = 0;
+    int64_t changeId = 0;
+    int64_t prevChangeId = 0;
+    std::vector<LevelUpdate> bids;
+    std::vector<LevelUpdate> asks;
+
+    // Fill from params.data, reusing this object's vectors; false if the message is malformed
+    bool parse(const rapidjson::Value& data);
+};
+
+// L2 order book for one instrument.
+// Each side is a flat vector sorted so the best price is at the back: top-of-book
+// updates (the vast majority) touch the end of the array and move almost nothing,
+// and a lookup is a binary search over contiguous memory instead of a tree walk.
+class OrderBook {
+public:
+    enum class Result { Applied, Gap, Ignored };
+
+    explicit OrderBook(const std::string& instrument = "");
+
+    // Apply a snapshot or change; a change whose prev_change_id does not follow
+    // the last applied change_id returns Gap and leaves the book unsynced until the next snapshot
+    Result apply(const BookDelta& delta);
+
+    void clear();
+
+    bool isSynced() const { return synced; }
+    int64_t lastChangeId() const { return changeId; }
+    int64_t lastTimestamp() const { return timestamp; }
+    const std::string& instrument() const { return name; }
+
+    size_t bidDepth() const { return bidLevels.size(); }
+    size_t askDepth() const { return askLevels.size(); }
+
+    // Level i counted from the top of the book (0 = best)
+    const PriceLevel& bid(size_t i) const { return bidLevels[bidLevels.size() - 1 - i]; }
+    const PriceLevel& ask(size_t i) const { return askLevels[askLevels.size() - 1 - i]; }
+    const PriceLevel* bestBid() const { return bidLevels.empty() ? nullptr : &bidLevels.back(); }
+    const PriceLevel* bestAsk() const { return askLevels.empty() ? nullptr : &askLevels.back(); }
+
+private:
+    // Bids ascending and asks descending, so the best level is always last
+    static void applyLevel(std::vector<PriceLevel>& levels, const LevelUpdate& update, bool ascending);
+
+    std::string name;
+    std::vector<PriceLevel> bidLevels;
+    std::vector<PriceLevel> askLevels;
+    int64_t changeId = 0;
+    int64_t timestamp = 0;
+    bool synced = false;
+};
+
+// Books for every subscribed instrument, fed from book.* notifications.
+// Owned by the thread that delivers notifications; not safe to share between threads.
+class OrderBookManager {
+public:
+    // Apply params.data of a book notification; returns the affected book or nullptr
+    // when the message could not be parsed. result reports Gap when a resync is needed.
+    OrderBook* apply(const rapidjson::Value& data, OrderBook::Result& result);
+    // Same for a delta that is already decoded
+    OrderBook* apply(const BookDelta& delta, OrderBook::Result& result);
+
+    OrderBook* find(const std::string& instrument);
+
+private:
+    std::unordered_map<std::string, OrderBook> books;
+    BookDelta scratch; // Reused between messages so parsing does not reallocate
+};
+
+#endif // ORDER_BOOK_H
@@ -0,0 +1,63 @@
+#ifndef ORDER_REQUESTS_H
+#define ORDER_REQUESTS_H
+
+#include <string>
+#include <optional>
+#include <cstdint>
+
+// Dense id of an instrument interned by InstrumentCache
+using InstrumentId = uint32_t;
+constexpr InstrumentId NoInstrumentId = UINT32_MAX;
+
+// Order types accepted by private/buy and private/sell
+enum class OrderType { Limit, Market, StopLimit, StopMarket, TakeLimit, TakeMarket, MarketLimit, TrailingStop };
+
+// Trigger sources for stop/take orders
+enum class TriggerType { IndexPrice, MarkPrice, LastPrice };
+
+enum class TimeInForce { GoodTilCancelled, GoodTilDay, FillOrKill, ImmediateOrCancel };
+
+const char* toString(OrderType type);
+const char* toString(TriggerType trigger);
+const char* toString(TimeInForce timeInForce);
+
+// Parse the strings used by the menu and the older string-based API
+std::optional<OrderType> parseOrderType(const std::string& type);
+std::optional<TriggerType> parseTriggerType(const std::string& trigger);
+
+// Parameters shared by private/buy and private/sell; unset optionals are not sent
+struct OrderRequest {
+    std::string instrument;
+    std::optional<double> amount;
+    std::optional<double> contracts;
+    OrderType type = OrderType::Limit;
+    std::optional<double> price;     // Sent for limit-style orders only
+    std::string label;               // Sent when not empty
+    std::optional<TimeInForce> timeInForce;
+    std::optional<bool> postOnly;
+    std::optional<bool> reduceOnly;
+    std::optional<TriggerType> trigger;
+    std::optional<double> triggerPrice;
+    InstrumentId instrumentId = NoInstrumentId; // Set from InstrumentCache to skip the name lookup in checks
+};
+
+struct BuyRequest : OrderRequest {};
+struct SellRequest : OrderRequest {};
+
+// Parameters of private/edit
+struct EditRequest {
+    std::string orderId;
+    std::optional<double> amount;
+    std::optional<double> contracts;
+    std::optional<double> price;
+    std::optional<std::string> advanced;
+    std::optional<bool> postOnly;
+    std::optional<bool> reduceOnly;
+};
+
+// Parameters of private/cancel
+struct CancelRequest {
+    std::string orderId;
+};
+
+#endif // ORDER_REQUESTS_H
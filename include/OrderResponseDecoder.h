@@ -0,0 +1,23 @@
+#ifndef ORDER_RESPONSE_DECODER_H
+#define ORDER_RESPONSE_DECODER_H
+
+#include "OrderResult.h"
+#include "rapidjson/document.h"
+#include <string>
+
+// Decodes buy/sell/edit/cancel/get_order_state responses into an OrderResult with a
+// rapidjson SAX reader: only the wanted fields are kept, nothing else is materialised,
+// and the reader's stack is reused per thread, so a decode does not allocate.
+class OrderResponseDecoder {
+public:
+    // Decode a JSON-RPC response body; false (errorCode LocalError) if it is not valid JSON
+    static bool decode(const std::string& json, OrderResult& result);
+
+    // Same fields from an already parsed DOM, for responses that arrive as documents
+    static void fromDocument(const rapidjson::Value& doc, OrderResult& result);
+
+    // Record a failure that happened before any response was received
+    static void setLocalError(OrderResult& result, const char* message);
+};
+
+#endif // ORDER_RESPONSE_DECODER_H
@@ -0,0 +1,32 @@
+#ifndef ORDER_RESULT_H
+#define ORDER_RESULT_H
+
+#include <cstdint>
+#include <string_view>
+
+// The fields of an order response the trading path acts on, decoded without a DOM.
+// Filled from result.order (buy/sell/edit) or result (cancel/get_order_state), or
+// from error.code/error.message when the exchange rejected the request.
+struct OrderResult {
+    enum class State : uint8_t { Unknown, Open, Filled, Rejected, Cancelled, Untriggered, Triggered };
+
+    // errorCode when no usable response arrived (transport failure or malformed JSON)
+    static constexpr int LocalError = -1;
+
+    char orderId[48] = {};
+    State state = State::Unknown;
+    double filledAmount = 0.0;
+    double averagePrice = 0.0;
+    int errorCode = 0;
+    char errorMessage[64] = {};
+
+    bool ok() const { return errorCode == 0 && orderId[0] != '\0'; }
+    std::string_view id() const { return orderId; }
+};
+
+const char* toString(OrderResult::State state);
+
+// State for an order_state string such as "open"; Unknown if it is not one
+OrderResult::State orderStateOf(std::string_view state);
+
+#endif // ORDER_RESULT_H
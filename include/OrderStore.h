@@ -0,0 +1,113 @@
+#ifndef ORDER_STORE_H
+#define ORDER_STORE_H
+
+#include "OrderResult.h"
+#include "rapidjson/document.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// One order as last reported by the exchange
+struct OrderRecord {
+    std::string orderId;
+    std::string instrument;
+    std::string label;
+    std::string orderType;
+    bool buy = true;
+    OrderResult::State state = OrderResult::State::Unknown;
+    double amount = 0.0;
+    double price = 0.0;
+    double filledAmount = 0.0;
+    double averagePrice = 0.0;
+    int64_t created = 0; // creation_timestamp, ms
+    int64_t updated = 0; // last_update_timestamp (or the latest trade's timestamp), ms
+
+    // Fills seen on user.trades, so a trade that arrives before its order update still counts
+    int64_t lastTradeSeq = -1;
+    double tradedAmount = 0.0;
+    double tradedNotional = 0.0;
+
+    bool isOpen() const {
+        return state == OrderResult::State::Open || state == OrderResult::State::Untriggered;
+    }
+};
+
+// Which open orders a query or mass cancel covers; empty fields match every order
+struct OrderFilter {
+    std::string instrument;
+    std::string labelPrefix;
+    std::optional<bool> buy; // Side: true for buys, false for sells
+
+    bool matches(const OrderRecord& record) const;
+};
+
+// In-process copy of the account's orders, written from user.orders / user.trades notifications
+// (and REST loads) and read from any thread. Lookups are hash lookups under a shared lock, and
+// every read sees the store between two updates, never half of one. Updates older than what is
+// stored are ignored, so notifications and REST responses can be applied in any order.
+// Closed orders are kept for lookups until maxClosedOrders newer ones have closed.
+class OrderStore {
+public:
+    explicit OrderStore(size_t maxClosedOrders = 10000);
+
+    OrderStore(const OrderStore&) = delete;
+    OrderStore& operator=(const OrderStore&) = delete;
+
+    // Apply one order object (user.orders data, or an order from a REST response); false if it has no order_id
+    bool applyOrder(const rapidjson::Value& order);
+    // Apply one user.trades entry; false if it has no order_id
+    bool applyTrade(const rapidjson::Value& trade);
+
+    // Notification data: one object on raw channels, an array on aggregated ones
+    void applyOrders(const rapidjson::Value& data);
+    void applyTrades(const rapidjson::Value& data);
+
+    // Take a get_open_orders result requested at requestedAtMs (exchange time). Orders the
+    // store holds as open that are missing from it, and have not changed since the request,
+    // closed while updates were missed; their ids are returned so the caller can fetch their
+    // final state.
+    std::vector<std::string> reconcile(const rapidjson::Value& openOrders, int64_t requestedAtMs);
+
+    // Called, under the store's lock, once for each order that closes or first arrives closed
+    using CloseHandler = std::function<void(const OrderRecord& record)>;
+    void setCloseHandler(CloseHandler handler);
+
+    bool find(const std::string& orderId, OrderRecord& out) const;
+    bool find(const std::string& orderId, OrderResult& out) const;
+
+    // Open orders, all or for one instrument
+    std::vector<OrderRecord> openOrders(const std::string& instrument = std::string()) const;
+    // Open orders matching filter; a label prefix is looked up in the label index
+    std::vector<OrderRecord> openOrders(const OrderFilter& filter) const;
+    // Distinct labels of open orders that start with prefix, in order
+    std::vector<std::string> openLabels(std::string_view prefix) const;
+
+    // Bumped by every applied update
+    uint64_t version() const;
+    size_t size() const;
+    void clear();
+
+private:
+    OrderRecord* applyOrderLocked(const rapidjson::Value& order);
+    void updateIndexLocked(OrderRecord& record, bool wasOpen, bool isNew, const std::string& previousLabel);
+
+    const size_t maxClosedOrders;
+    mutable std::shared_mutex mutex;
+    std::unordered_map<std::string, OrderRecord> orders;
+    std::unordered_set<const OrderRecord*> open; // Entries of orders that are open
+    // Open orders by label, ordered so a prefix is one range; unlabelled orders are left out
+    std::map<std::string, std::unordered_set<const OrderRecord*>, std::less<>> openByLabel;
+    std::deque<std::string> closed;              // Closed order ids, oldest first, for eviction
+    uint64_t updates = 0;
+    CloseHandler onClose;
+};
+
+#endif // ORDER_STORE_H
@@ -0,0 +1,68 @@
+#ifndef ORDER_TRACKER_H
+#define ORDER_TRACKER_H
+
+#include "OrderStore.h"
+#include "Trading.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+class WebSocketClient;
+
+// Keeps an OrderStore current: follows user.orders and user.trades on a WebSocket, loads the
+// open orders over REST once subscribed, and reconciles over REST every interval to repair
+// anything missed while the socket was down. Orders that vanished from the open list get one
+// get_order_state each, so they end in their real final state.
+class OrderTracker {
+public:
+    // Current access token, read before each REST call so refreshed tokens are picked up
+    using TokenSource = std::function<std::string()>;
+
+    OrderTracker(Trading& trading, OrderStore& store, TokenSource token,
+                 std::chrono::seconds reconcileInterval = std::chrono::seconds(30));
+    ~OrderTracker();
+
+    OrderTracker(const OrderTracker&) = delete;
+    OrderTracker& operator=(const OrderTracker&) = delete;
+
+    // Subscribe client to user.orders.<scope>.raw and user.trades.<scope>.raw, load the open
+    // orders and start reconciling. scope is "any.any", "<kind>.<currency>" or an instrument.
+    // client must be connected, and must outlive the tracker or a call to stop().
+    bool start(WebSocketClient& client, const std::string& scope = "any.any");
+    void stop();
+
+    // One REST pass; false if get_open_orders failed
+    bool reconcile();
+
+    bool isRunning() const { return running.load(std::memory_order_acquire); }
+    uint64_t reconcileCount() const { return reconciles.load(std::memory_order_relaxed); }
+    // Orders whose close was only learned through reconciliation
+    uint64_t repairedCount() const { return repaired.load(std::memory_order_relaxed); }
+
+private:
+    void run();
+
+    Trading& trading;
+    OrderStore& store;
+    TokenSource token;
+    const std::chrono::seconds reconcileInterval;
+
+    WebSocketClient* client = nullptr;
+    uint64_t orderHandler = 0;
+    uint64_t tradeHandler = 0;
+
+    std::mutex mutex; // Guards stopping
+    std::condition_variable wakeUp;
+    bool stopping = false;
+    std::thread reconcileThread;
+    std::atomic<bool> running{false};
+
+    std::atomic<uint64_t> reconciles{0};
+    std::atomic<uint64_t> repaired{0};
+};
+
+#endif // ORDER_TRACKER_H
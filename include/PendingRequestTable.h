@@ -0,0 +1,71 @@
+#ifndef PENDING_REQUEST_TABLE_H
+#define PENDING_REQUEST_TABLE_H
+
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include "rapidjson/document.h"
+
+// Lock-free table matching JSON-RPC responses to the callbacks waiting for them.
+// Request ids are handed out monotonically, so id % Capacity spreads them over the
+// slots and a slot only collides when more than Capacity requests are outstanding.
+// Each slot's id is claimed and released with compare-exchange, so the listener
+// thread completing a response and on_close failing everything never both run a callback.
+class PendingRequestTable {
+public:
+    using Callback = std::function<void(rapidjson::Document&&)>;
+    static constexpr size_t Capacity = 1024;
+
+    // Register a callback for a request id; false (callback left untouched) if its slot is still taken
+    bool add(uint64_t id, Callback& callback) {
+        Slot& slot = slots[id % Capacity];
+        uint64_t expected = Free;
+        if (!slot.id.compare_exchange_strong(expected, Busy, std::memory_order_acquire)) {
+            return false;
+        }
+        slot.callback = std::move(callback);
+        slot.id.store(id, std::memory_order_release); // Publish the callback
+        return true;
+    }
+
+    // Remove and return the callback for a request id; empty if it is not pending
+    Callback take(uint64_t id) {
+        Slot& slot = slots[id % Capacity];
+        uint64_t expected = id;
+        if (!slot.id.compare_exchange_strong(expected, Busy, std::memory_order_acquire)) {
+            return nullptr;
+        }
+        Callback callback = std::move(slot.callback);
+        slot.callback = nullptr;
+        slot.id.store(Free, std::memory_order_release);
+        return callback;
+    }
+
+    // Remove every pending callback, e.g. to fail them when the connection drops
+    template<typename F>
+    void drain(F&& onCallback) {
+        for (Slot& slot : slots) {
+            uint64_t id = slot.id.load(std::memory_order_acquire);
+            if (id != Free && id != Busy) {
+                if (Callback callback = take(id)) {
+                    onCallback(std::move(callback));
+                }
+            }
+        }
+    }
+
+private:
+    static constexpr uint64_t Free = 0;
+    static constexpr uint64_t Busy = std::numeric_limits<uint64_t>::max();
+
+    struct alignas(64) Slot {
+        std::atomic<uint64_t> id{Free};
+        Callback callback;
+    };
+
+    std::array<Slot, Capacity> slots;
+};
+
+#endif // PENDING_REQUEST_TABLE_H
@@ -0,0 +1,119 @@
+#ifndef POSITION_CACHE_H
+#define POSITION_CACHE_H
+
+#include "SeqLock.h"
+#include "rapidjson/document.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Positions and account figures kept current from user.changes.* and user.portfolio.*
+// notifications (seeded once over REST), readable from any thread without a lock.
+// Each instrument and currency has a fixed slot holding its figures in a SeqLock: the
+// listener thread writes, strategy threads copy the latest figures out. Slots are found in
+// open-addressed tables of atomic pointers and are never removed, so a position that goes
+// flat stays readable with size 0.
+class PositionCache {
+public:
+    struct Position {
+        char instrument[48] = {};
+        bool inverse = false;           // Size in USD and PnL in the coin (BTC-PERPETUAL) rather than linear
+        double size = 0.0;              // Signed: negative when short
+        double averagePrice = 0.0;
+        double markPrice = 0.0;
+        double floatingPnl = 0.0;       // Mark-to-market PnL of the open size
+        double realizedPnl = 0.0;
+        double initialMargin = 0.0;
+        double maintenanceMargin = 0.0;
+        double delta = 0.0;
+        int64_t updated = 0;            // Local time of the last update, ms since the epoch
+
+        std::string_view name() const { return instrument; }
+    };
+
+    struct Portfolio {
+        char currency[16] = {};
+        double equity = 0.0;
+        double balance = 0.0;
+        double availableFunds = 0.0;
+        double marginBalance = 0.0;
+        double initialMargin = 0.0;
+        double maintenanceMargin = 0.0;
+        double totalPnl = 0.0;
+        double sessionUpl = 0.0;        // Session unrealised PnL
+        double sessionRpl = 0.0;        // Session realised PnL
+        double deltaTotal = 0.0;
+        int64_t updated = 0;
+
+        std::string_view name() const { return currency; }
+    };
+
+    static constexpr size_t MaxInstruments = 512;
+    static constexpr size_t MaxCurrencies = 32;
+
+    PositionCache() = default;
+    ~PositionCache();
+
+    PositionCache(const PositionCache&) = delete;
+    PositionCache& operator=(const PositionCache&) = delete;
+
+    // Writers. Calls are serialised internally, but they are meant for one thread: the
+    // WebSocket listener, plus the REST seed.
+
+    // Notifications carry no timestamp to compare with a REST snapshot, so a seed instead
+    // passes the seedMark() taken before its request: instruments and currencies that a
+    // notification updated after that are left alone, as the notification is at least as new.
+    static constexpr uint64_t Live = UINT64_MAX; // Not a seed
+    uint64_t seedMark() const { return notifications.load(std::memory_order_acquire); }
+
+    // One position object, from get_positions/get_position or user.changes positions[]
+    void applyPosition(const rapidjson::Value& position, uint64_t seedMark = Live);
+    // An array of position objects, such as a get_positions result
+    void applyPositions(const rapidjson::Value& positions, uint64_t seedMark = Live);
+    // user.changes data: the positions it carries replace the cached ones
+    void applyChanges(const rapidjson::Value& data);
+    // user.portfolio data, or a get_account_summary result
+    void applyPortfolio(const rapidjson::Value& data, uint64_t seedMark = Live);
+    // Re-mark a position between notifications, e.g. from a ticker or markprice channel
+    void markToMarket(std::string_view instrument, double markPrice);
+
+    // Readers, lock-free from any thread; false if the instrument or currency was never seen
+    bool position(std::string_view instrument, Position& out) const;
+    bool portfolio(std::string_view currency, Portfolio& out) const;
+    std::vector<Position> positions(bool includeFlat = false) const;
+    std::vector<Portfolio> portfolios() const;
+
+    // Bumped by every applied update
+    uint64_t version() const { return updates.load(std::memory_order_acquire); }
+
+private:
+    template<typename T>
+    struct Slot {
+        explicit Slot(std::string_view key) : key(key) {}
+        const std::string key; // Never changes once the slot is published
+        SeqLock<T> value;
+        uint64_t notified = 0; // notifications count at the last live update; writers only
+    };
+    using PositionSlot = Slot<Position>;
+    using PortfolioSlot = Slot<Portfolio>;
+
+    // Open-addressed lookup; find never locks, insert runs under writeMutex
+    template<typename SlotT, size_t Capacity>
+    static SlotT* find(const std::atomic<SlotT*> (&table)[Capacity], std::string_view key);
+    PositionSlot* positionSlot(std::string_view instrument, bool inverse);
+    PortfolioSlot* portfolioSlot(std::string_view currency);
+
+    static double floatingPnl(const Position& position, double markPrice);
+
+    std::atomic<PositionSlot*> positionTable[MaxInstruments] = {};
+    std::atomic<PortfolioSlot*> portfolioTable[MaxCurrencies] = {};
+    std::mutex writeMutex; // Serialises writers and slot inserts
+    std::atomic<uint64_t> updates{0};
+    std::atomic<uint64_t> notifications{0}; // Live updates applied
+};
+
+#endif // POSITION_CACHE_H
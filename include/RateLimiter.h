@@ -0,0 +1,98 @@
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+// Client-side copy of the exchange's credit limits, so bursts wait a few milliseconds locally
+// instead of drawing too_many_requests (10028) errors. Matching-engine calls (order entry,
+// edits, cancels) and all other calls draw from separate buckets.
+// Each bucket is a token bucket kept as a single atomic "theoretical arrival time" (GCRA):
+// taking credits is one compare-and-swap, and a queued caller reserves its slot before it
+// sleeps, so waiters are admitted in arrival order without any lock.
+class RateLimiter {
+public:
+    enum class Bucket { MatchingEngine, NonMatchingEngine };
+    static constexpr int BucketCount = 2;
+
+    // What acquire() does when a bucket is out of credits
+    enum class Policy {
+        Queue, // Wait until the credits refill (up to maxWait, then reject)
+        Reject // Fail immediately
+    };
+
+    // Body a rejected request gets in place of a server response, the same error the exchange returns
+    static constexpr std::string_view rejectedResponse =
+        R"({"jsonrpc":"2.0","error":{"code":10028,"message":"too_many_requests"}})";
+
+    struct BucketConfig {
+        double capacity;        // Credits when full: the largest burst
+        double refillPerSecond; // Credits restored per second: the sustained rate
+        double cost;            // Credits taken by one request
+    };
+
+    struct Stats {
+        uint64_t admitted = 0;      // Requests let through, including after a wait
+        uint64_t throttled = 0;     // Requests that had to wait
+        uint64_t rejected = 0;      // Requests refused
+        uint64_t waitedNs = 0;      // Total time throttled requests waited
+        double credits = 0.0;       // Credits available now
+    };
+
+    // Defaults for a new account: matching engine 20 requests burst at 5/s, other calls 500
+    // credits each from 50000 refilled at 10000/s
+    static BucketConfig defaultConfig(Bucket bucket);
+
+    explicit RateLimiter(Policy policy = Policy::Queue);
+    RateLimiter(const BucketConfig& matchingEngine, const BucketConfig& nonMatchingEngine, Policy policy = Policy::Queue);
+
+    RateLimiter(const RateLimiter&) = delete;
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    // Bucket for a method name, or a URL/target containing one
+    static Bucket classify(std::string_view endpoint);
+
+    // Take the credits for one request; false if it was rejected
+    bool acquire(std::string_view endpoint) { return acquire(classify(endpoint)); }
+    bool acquire(Bucket bucket);
+
+    // Take the credits without sleeping; wait is how long the caller must hold the request
+    // before sending it (zero when it may go now). False if it was rejected.
+    bool reserve(std::string_view endpoint, std::chrono::nanoseconds& wait) { return reserve(classify(endpoint), wait); }
+    bool reserve(Bucket bucket, std::chrono::nanoseconds& wait);
+
+    // Refill the bucket and reset its state; not safe while other threads call acquire()
+    void configure(Bucket bucket, const BucketConfig& config);
+
+    void setPolicy(Policy newPolicy) { policy.store(newPolicy, std::memory_order_relaxed); }
+    Policy getPolicy() const { return policy.load(std::memory_order_relaxed); }
+
+    // Longest a queued request may wait before it is rejected instead
+    void setMaxWait(std::chrono::nanoseconds wait) { maxWaitNs.store(wait.count(), std::memory_order_relaxed); }
+
+    double credits(Bucket bucket) const;
+    Stats stats(Bucket bucket) const;
+    void resetStats();
+
+private:
+    struct State {
+        BucketConfig config{};
+        int64_t costNs = 0;      // Refill time of one request's credits
+        int64_t toleranceNs = 0; // How far ahead of now the arrival time may run: the burst
+        std::atomic<int64_t> arrivalNs{0};
+        std::atomic<uint64_t> admitted{0};
+        std::atomic<uint64_t> throttled{0};
+        std::atomic<uint64_t> rejected{0};
+        std::atomic<uint64_t> waitedNs{0};
+    };
+
+    static int64_t nowNs();
+
+    State buckets[BucketCount];
+    std::atomic<Policy> policy;
+    std::atomic<int64_t> maxWaitNs{2'000'000'000};
+};
+
+#endif // RATE_LIMITER_H
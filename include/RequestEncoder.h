@@ -0,0 +1,44 @@
+#ifndef REQUEST_ENCODER_H
+#define REQUEST_ENCODER_H
+
+#include "OrderRequests.h"
+#include <string>
+#include <string_view>
+#include <cstdint>
+
+// Writes typed requests straight into a caller-owned buffer, either as a REST target
+// ("/api/v2/private/buy?instrument_name=...&amount=...") or as a JSON-RPC request.
+// Numbers are formatted with std::to_chars and fields are emitted in a fixed order,
+// so encoding into a buffer that is reused between requests does not allocate.
+// Every encode call replaces the buffer contents.
+class RequestEncoder {
+public:
+    // JSON-RPC method names; the REST path is "/api/v2/" followed by the method
+    static const char* method(const BuyRequest&) { return "private/buy"; }
+    static const char* method(const SellRequest&) { return "private/sell"; }
+    static const char* method(const EditRequest&) { return "private/edit"; }
+    static const char* method(const CancelRequest&) { return "private/cancel"; }
+
+    // REST target (path and query string) to append to the base URL
+    static void encodeTarget(std::string& out, const BuyRequest& request);
+    static void encodeTarget(std::string& out, const SellRequest& request);
+    static void encodeTarget(std::string& out, const EditRequest& request);
+    static void encodeTarget(std::string& out, const CancelRequest& request);
+
+    // Target for calls with no parameters, or a single string parameter (key is null for none)
+    static void encodeTarget(std::string& out, const char* method, const char* key = nullptr, std::string_view value = {});
+
+    // JSON-RPC request; access_token is included in params when not empty
+    static void encodeJsonRpc(std::string& out, uint64_t id, std::string_view accessToken, const BuyRequest& request);
+    static void encodeJsonRpc(std::string& out, uint64_t id, std::string_view accessToken, const SellRequest& request);
+    static void encodeJsonRpc(std::string& out, uint64_t id, std::string_view accessToken, const EditRequest& request);
+    static void encodeJsonRpc(std::string& out, uint64_t id, std::string_view accessToken, const CancelRequest& request);
+
+    // Value formatting shared by both encodings
+    static void appendNumber(std::string& out, double value);
+    static void appendNumber(std::string& out, uint64_t value);
+    static void appendPercentEncoded(std::string& out, std::string_view value);
+    static void appendJsonEscaped(std::string& out, std::string_view value);
+};
+
+#endif // REQUEST_ENCODER_H
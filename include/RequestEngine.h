@@ -0,0 +1,100 @@
+#ifndef REQUEST_ENGINE_H
+#define REQUEST_ENGINE_H
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <functional>
+#include <curl/curl.h>
+#include "rapidjson/document.h"
+#include "RateLimiter.h"
+
+// Single-threaded, event-driven HTTP engine built on curl_multi.
+// Requests are handed to one I/O thread that keeps them all in flight on a
+// few (HTTP/2 multiplexed where the server allows it) connections and
+// completes them through a callback or a future.
+class RequestEngine {
+public:
+    using Callback = std::function<void(rapidjson::Document&&)>;
+    // Gets the raw body, or error set when no response arrived; the body may be consumed in place
+    using RawCallback = std::function<void(const char* error, std::string& body)>;
+
+    RequestEngine(const std::string& baseUrl, long maxHostConnections = 4, long maxConcurrentStreams = 100);
+    ~RequestEngine();
+
+    RequestEngine(const RequestEngine&) = delete;
+    RequestEngine& operator=(const RequestEngine&) = delete;
+
+    // Queue a GET for a target encoded by RequestEncoder (API path plus query string);
+    // the callback runs on the I/O thread and must not block
+    void submit(const std::string& target, const std::string& token, Callback callback);
+
+    // Queue a GET request and get its parsed response through a future
+    std::future<rapidjson::Document> submit(const std::string& target, const std::string& token = "");
+
+    // Queue a GET whose body goes to a typed decoder instead of a DOM
+    void submitRaw(const std::string& target, const std::string& token, RawCallback callback);
+
+    // Submitting threads take credits from this limiter without waiting: a queued request is held
+    // on the I/O thread until its slot, and a rejected one completes there with the exchange's
+    // too_many_requests error. Null disables it.
+    void setRateLimiter(RateLimiter* limiter) { rateLimiter.store(limiter, std::memory_order_relaxed); }
+
+    size_t inFlight() const { return inFlightCount.load(std::memory_order_relaxed); }
+    size_t completed() const { return completedCount.load(std::memory_order_relaxed); }
+
+private:
+    // One request and the easy handle carrying it; recycled after completion
+    using Clock = std::chrono::steady_clock;
+
+    struct Transfer {
+        CURL* curl = nullptr;
+        struct curl_slist* headers = nullptr;
+        std::string headerToken;
+        bool hasHeaders = false;
+        std::string url;
+        std::string response;
+        RawCallback callback;
+        Clock::time_point startAt; // Held until then by the rate limiter
+        bool rejected = false;     // Refused by the rate limiter; completes without being sent
+    };
+
+    void run();
+    void startPending();
+    void start(Transfer* transfer);
+    int pollTimeoutMs() const;
+    void completeDone();
+    Transfer* newTransfer();
+    void recycle(Transfer* transfer);
+    static rapidjson::Document errorDocument(const char* message);
+    static size_t WriteCallback(void* contents, size_t size, size_t nmemb, void* userp);
+
+    std::string baseUrl;
+    CURLM* multi;
+    std::thread ioThread;
+    std::atomic<bool> running;
+
+    // Requests submitted by other threads, picked up by the I/O thread
+    std::mutex submitMutex;
+    std::vector<Transfer*> pending;
+
+    // Only touched by the I/O thread
+    std::vector<Transfer*> startBatch;
+    std::vector<Transfer*> delayed; // Waiting for their rate-limit slot
+
+    // Idle transfers ready for reuse, and every transfer ever created
+    std::mutex allMutex;
+    std::vector<Transfer*> freeTransfers;
+    std::vector<Transfer*> allTransfers;
+
+    std::atomic<RateLimiter*> rateLimiter{nullptr};
+
+    std::atomic<size_t> inFlightCount{0};
+    std::atomic<size_t> completedCount{0};
+};
+
+#endif // REQUEST_ENGINE_H
@@ -0,0 +1,92 @@
+#ifndef REQUEST_TIMINGS_H
+#define REQUEST_TIMINGS_H
+
+#include "LatencyHistogram.h"
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Per-endpoint breakdown of where a REST request spends its time, one histogram per stage.
+// Endpoints are found in a fixed open-addressed table of atomic pointers, so recording
+// is lock-free and a monitoring thread can poll summary() while requests are running.
+class RequestTimings {
+public:
+    enum Stage {
+        Build,     // Entering Connection to handing the request to curl (URL, body, handle, headers)
+        Dns,       // Name lookup; only requests that opened a new connection
+        Connect,   // TCP connect; only requests that opened a new connection
+        Tls,       // TLS handshake; only new TLS connections
+        FirstByte, // Request sent to first response byte (server time plus one round trip)
+        Transfer,  // First byte to last byte of the response
+        Parse,     // Response body to Document or OrderResult
+        Total,     // Entering Connection to the body received; Parse is not included
+        StageCount
+    };
+
+    static const char* stageName(Stage stage);
+
+    // Durations of one request in nanoseconds; stages that did not happen are left at 0
+    struct Sample {
+        std::array<uint64_t, StageCount> ns{};
+        bool newConnection = false;
+        bool tls = false;
+    };
+
+    struct Endpoint {
+        explicit Endpoint(std::string_view name) : name(name) {}
+        const std::string name;
+        LatencyHistogram stages[StageCount];
+        std::atomic<uint64_t> errors{0};
+    };
+
+    struct StageSummary {
+        std::string endpoint;
+        Stage stage;
+        uint64_t count;
+        double mean;
+        uint64_t p50;
+        uint64_t p90;
+        uint64_t p99;
+        uint64_t p999;
+        uint64_t max;
+        uint64_t errors; // Failed transfers on the endpoint, repeated on each of its rows
+    };
+
+    RequestTimings();
+    ~RequestTimings();
+
+    RequestTimings(const RequestTimings&) = delete;
+    RequestTimings& operator=(const RequestTimings&) = delete;
+
+    // "private/buy" from a URL or target such as ".../api/v2/private/buy?amount=10"
+    static std::string_view endpointOf(std::string_view urlOrTarget);
+
+    // Histograms for an endpoint, created on first use; stable for the object's lifetime
+    Endpoint& endpoint(std::string_view name);
+
+    void record(std::string_view name, const Sample& sample);
+    void recordParse(std::string_view name, uint64_t ns) { endpoint(name).stages[Parse].record(ns); }
+    void recordError(std::string_view name) { endpoint(name).errors.fetch_add(1, std::memory_order_relaxed); }
+
+    // One row per endpoint and stage that has samples
+    std::vector<StageSummary> summary() const;
+
+    // Table of summary() in microseconds
+    void write(std::ostream& out) const;
+
+    // Not atomic with respect to requests in flight
+    void reset();
+
+private:
+    // Power of two; endpoints beyond this share the last-resort "other" entry
+    static constexpr size_t Capacity = 64;
+
+    std::array<std::atomic<Endpoint*>, Capacity> slots;
+    Endpoint overflow{"other"};
+};
+
+#endif // REQUEST_TIMINGS_H
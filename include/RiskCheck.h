@@ -0,0 +1,106 @@
+#ifndef RISK_CHECK_H
+#define RISK_CHECK_H
+
+#include "InstrumentCache.h"
+#include "OrderRequests.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+// Pre-trade limits applied to every typed order before it is encoded, so a fat-fingered size
+// or price is refused locally instead of reaching the exchange.
+// Limits and state live in a fixed array indexed by InstrumentCache ids, every field an atomic:
+// a check is a handful of relaxed loads plus one compare-and-swap each for the open-order slot
+// and the message rate, with no lock and no allocation. Orders whose instrument was never
+// loaded share one entry that uses the default limits.
+class RiskCheck {
+public:
+    enum class Result : uint8_t { Ok, OrderTooLarge, NotionalTooLarge, TooManyOpenOrders, OutsidePriceBand, MessageRate };
+    static constexpr int ResultCount = 6;
+    static const char* toString(Result result);
+
+    // Zero disables a limit
+    struct Limits {
+        double maxOrderAmount = 0.0; // In the order's amount units (USD for inverse futures)
+        double maxNotional = 0.0;    // amount * price, or the USD amount itself for inverse futures
+        uint32_t maxOpenOrders = 0;  // Orders this process has placed and not yet seen close
+        double priceBand = 0.0;      // Largest |price - reference| / reference, e.g. 0.05; needs a reference price
+    };
+
+    explicit RiskCheck(const InstrumentCache& instruments);
+    ~RiskCheck();
+
+    RiskCheck(const RiskCheck&) = delete;
+    RiskCheck& operator=(const RiskCheck&) = delete;
+
+    // Limits for instruments without their own
+    void setDefaultLimits(const Limits& limits);
+    void setLimits(InstrumentId id, const Limits& limits);
+    void clearLimits(InstrumentId id);
+    Limits limits(InstrumentId id) const;
+
+    // Orders and edits per second across all instruments, with bursts up to burst messages;
+    // a rate of zero disables it. Cancels are never refused, so a throttled strategy can
+    // still pull its orders.
+    void setMessageRate(double perSecond, double burst = 1.0);
+
+    // Price the band is measured from, typically the mark or mid price from a feed; zero clears it
+    void setReferencePrice(InstrumentId id, double price);
+    double referencePrice(InstrumentId id) const;
+
+    // Check a new order. Ok takes one of the instrument's open-order slots, which
+    // orderClosed() gives back once the order is rejected, filled or cancelled.
+    Result checkOrder(InstrumentId id, const OrderRequest& request);
+    // Edits only count against the message rate
+    Result checkMessage();
+
+    void orderClosed(InstrumentId id);
+    uint32_t openOrders(InstrumentId id) const;
+
+    // How often each result was returned; count(Result::Ok) is the orders and messages let through
+    uint64_t count(Result result) const { return results[static_cast<int>(result)].load(std::memory_order_relaxed); }
+    uint64_t rejected() const;
+    void resetStats();
+
+    // Counts per result as a small table
+    void write(std::ostream& out) const;
+
+private:
+    struct AtomicLimits {
+        std::atomic<double> maxOrderAmount{0.0};
+        std::atomic<double> maxNotional{0.0};
+        std::atomic<uint32_t> maxOpenOrders{0};
+        std::atomic<double> priceBand{0.0};
+
+        void store(const Limits& limits);
+        Limits load() const;
+    };
+
+    // One per instrument, on its own cache line so strategy threads trading different
+    // instruments do not contend
+    struct alignas(64) InstrumentState {
+        std::atomic<bool> custom{false};
+        AtomicLimits limits;
+        std::atomic<double> reference{0.0};
+        std::atomic<uint32_t> open{0};
+    };
+
+    InstrumentState& state(InstrumentId id);
+    const InstrumentState& state(InstrumentId id) const;
+    bool takeMessage();
+    Result finish(Result result);
+
+    const InstrumentCache& instruments;
+    std::unique_ptr<InstrumentState[]> states; // MaxInstruments entries, then the shared one for unknown instruments
+    AtomicLimits defaults;
+
+    // Message rate as a GCRA arrival time, like RateLimiter's buckets
+    std::atomic<int64_t> messageCostNs{0};
+    std::atomic<int64_t> messageToleranceNs{0};
+    alignas(64) std::atomic<int64_t> messageArrivalNs{0};
+
+    alignas(64) std::atomic<uint64_t> results[ResultCount] = {};
+};
+
+#endif // RISK_CHECK_H
@@ -0,0 +1,69 @@
+#ifndef SEQ_LOCK_H
+#define SEQ_LOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+// Single-writer sequence lock around a trivially copyable value.
+// The writer bumps the sequence to odd, copies the value in and bumps it to even; a reader
+// copies the value out and retries if the sequence was odd or moved meanwhile. Readers never
+// block the writer or each other. The value is held as relaxed atomic words, so a torn copy
+// is only ever thrown away, never a data race.
+template<typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable type");
+
+public:
+    SeqLock() { store(T{}); }
+
+    // Writer only; concurrent writers must be serialised by the caller
+    void store(const T& value) {
+        uint64_t buffer[Words] = {};
+        std::memcpy(buffer, &value, sizeof(T));
+
+        const uint64_t seq = sequence.load(std::memory_order_relaxed);
+        sequence.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        for (size_t i = 0; i < Words; ++i) {
+            words[i].store(buffer[i], std::memory_order_relaxed);
+        }
+        sequence.store(seq + 2, std::memory_order_release);
+    }
+
+    // Any thread; spins while a write is in progress
+    T load() const {
+        uint64_t buffer[Words];
+        for (unsigned spins = 0;; ++spins) {
+            const uint64_t before = sequence.load(std::memory_order_acquire);
+            if ((before & 1) == 0) {
+                for (size_t i = 0; i < Words; ++i) {
+                    buffer[i] = words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before) {
+                    break;
+                }
+            }
+            if (spins > 64) {
+                std::this_thread::yield();
+            }
+        }
+        T value;
+        std::memcpy(&value, buffer, sizeof(T));
+        return value;
+    }
+
+    // Number of completed writes
+    uint64_t version() const { return sequence.load(std::memory_order_acquire) / 2; }
+
+private:
+    static constexpr size_t Words = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+    alignas(64) std::atomic<uint64_t> sequence{0};
+    std::atomic<uint64_t> words[Words];
+};
+
+#endif // SEQ_LOCK_H
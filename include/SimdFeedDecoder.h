@@ -0,0 +1,38 @@
+#ifndef SIMD_FEED_DECODER_H
+#define SIMD_FEED_DECODER_H
+
+#include <memory>
+#include <string>
+#include <string_view>
+#include "OrderBook.h"
+
+// simdjson on-demand decoder for book.* notifications, the alternative to building an
+// InsituParser DOM for every frame. It walks the frame once and reads only channel,
+// type, timestamp, change_id, prev_change_id, instrument_name and the bid/ask arrays into
+// a BookDelta. simdjson reads past the end of its input, so the frame's spare capacity
+// serves as padding; a frame without enough is copied into a padded buffer the decoder
+// keeps for the next one. The frame itself is not modified, so after a false return it
+// can still be handed to the rapidjson path.
+// Available when built with GOQUANT_WITH_SIMDJSON; otherwise every decode returns false.
+class SimdFeedDecoder {
+public:
+    SimdFeedDecoder();
+    ~SimdFeedDecoder();
+
+    SimdFeedDecoder(const SimdFeedDecoder&) = delete;
+    SimdFeedDecoder& operator=(const SimdFeedDecoder&) = delete;
+
+    // Whether this build includes simdjson
+    static bool available();
+
+    // Decode a book notification into delta, reusing its vectors. channel points into the
+    // decoder and stays valid until the next decode. False if frame is not a well-formed
+    // book notification.
+    bool decodeBook(std::string& frame, std::string_view& channel, BookDelta& delta);
+
+private:
+    struct Impl; // Keeps simdjson.h out of this header
+    std::unique_ptr<Impl> impl;
+};
+
+#endif // SIMD_FEED_DECODER_H
@@ -0,0 +1,144 @@
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <chrono>
+#include <cstddef>
+
+// How the consumer waits when the ring is empty
+enum class WaitStrategy {
+    BusySpin,  // Never give up the core: lowest latency, burns a full CPU
+    SpinYield, // Spin briefly, then std::this_thread::yield between polls
+    Park       // Spin briefly, then sleep on a condition variable until the producer signals
+};
+
+// Bounded single-producer/single-consumer ring buffer.
+// The producer only writes tail and the consumer only writes head, each on its own
+// cache line, so a push or pop is one acquire load and one release store with no lock.
+template<typename T>
+class SpscRing {
+public:
+    explicit SpscRing(size_t capacity = 8192, WaitStrategy strategy = WaitStrategy::SpinYield)
+        : mask(roundUpPow2(capacity) - 1),
+          slots(new T[mask + 1]),
+          waitStrategy(strategy) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // Producer: enqueue if there is room
+    bool tryPush(T&& value) {
+        const size_t t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead == mask + 1) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead == mask + 1) {
+                return false;
+            }
+        }
+        slots[t & mask] = std::move(value);
+        tail.store(t + 1, std::memory_order_release);
+        if (waitStrategy == WaitStrategy::Park) {
+            wakeIfParked();
+        }
+        return true;
+    }
+
+    // Producer: enqueue, yielding while the consumer catches up (backpressure instead of dropping)
+    void push(T&& value) {
+        while (!tryPush(std::move(value))) {
+            std::this_thread::yield();
+        }
+    }
+
+    // Consumer: dequeue if anything is waiting
+    bool tryPop(T& out) {
+        const size_t h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) {
+                return false;
+            }
+        }
+        out = std::move(slots[h & mask]);
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer: dequeue, waiting per the wait strategy; false once running turns false (or a park timed out)
+    bool pop(T& out, const std::atomic<bool>& running) {
+        for (unsigned spins = 0; running.load(std::memory_order_relaxed); ++spins) {
+            if (tryPop(out)) {
+                return true;
+            }
+            if (waitStrategy == WaitStrategy::BusySpin || spins < SpinLimit) {
+                continue;
+            }
+            if (waitStrategy == WaitStrategy::SpinYield) {
+                std::this_thread::yield();
+                continue;
+            }
+            park();
+            return tryPop(out);
+        }
+        return false;
+    }
+
+    // Wake a parked consumer, e.g. when stopping
+    void wake() {
+        std::lock_guard<std::mutex> lock(parkMutex);
+        parkCondition.notify_one();
+    }
+
+    void setWaitStrategy(WaitStrategy strategy) { waitStrategy = strategy; }
+    WaitStrategy getWaitStrategy() const { return waitStrategy; }
+    size_t capacity() const { return mask + 1; }
+
+private:
+    static constexpr unsigned SpinLimit = 256;
+    static constexpr size_t CacheLine = 64;
+
+    static size_t roundUpPow2(size_t n) {
+        size_t p = 2;
+        while (p < n) {
+            p <<= 1;
+        }
+        return p;
+    }
+
+    // Sleep until the producer publishes something; the seq_cst flag/tail pair prevents lost wakeups
+    void park() {
+        std::unique_lock<std::mutex> lock(parkMutex);
+        parked.store(true, std::memory_order_seq_cst);
+        if (tail.load(std::memory_order_seq_cst) == head.load(std::memory_order_relaxed)) {
+            parkCondition.wait_for(lock, std::chrono::milliseconds(100));
+        }
+        parked.store(false, std::memory_order_relaxed);
+    }
+
+    void wakeIfParked() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (parked.load(std::memory_order_seq_cst)) {
+            wake();
+        }
+    }
+
+    const size_t mask;
+    std::unique_ptr<T[]> slots;
+    WaitStrategy waitStrategy;
+
+    alignas(CacheLine) std::atomic<size_t> head{0}; // Next slot to read, written by the consumer
+    size_t cachedTail = 0;                          // Consumer's last view of tail
+
+    alignas(CacheLine) std::atomic<size_t> tail{0}; // Next slot to write, written by the producer
+    size_t cachedHead = 0;                          // Producer's last view of head
+
+    alignas(CacheLine) std::atomic<bool> parked{false};
+    std::mutex parkMutex;
+    std::condition_variable parkCondition;
+};
+
+#endif // SPSC_RING_H
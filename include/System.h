@@ -4,30 +4,183 @@
 #include "Trading.h"
 #include "Connection.h"
 #include "ThreadPool.h"
+#include "RequestEngine.h"
+#include "OrderStore.h"
+#include "OrderTracker.h"
+#include "PositionCache.h"
+#include "InstrumentCache.h"
+#include "RiskCheck.h"
+#include "OrderBatch.h"
+#include "AmendCoalescer.h"
 #include "rapidjson/document.h"
 #include <vector>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <unordered_map>
+
+class WebSocketClient;
+
 class System {
 public:
+    // Where the *Async calls run: one blocking request per pool thread, or all in flight on the curl_multi engine
+    enum class AsyncBackend { ThreadPool, CurlMulti };
+
+    // Wire path for a single order call: REST over HTTP, or JSON-RPC on the attached WebSocket.
+    // WebSocket calls block until the listener thread delivers the response, so from a
+    // handler running on that thread they throw instead of deadlocking; handlers use the
+    // callback calls (placeOrderAsync, amendOrder, ...) or WebSocketClient's callback overloads.
+    enum class Transport { Rest, WebSocket };
+
+    // What a mass cancel sent and how many orders the exchange reported cancelled
+    struct MassCancelResult {
+        size_t requests = 0;  // REST calls made, including the open-orders fetch when one was needed
+        size_t cancelled = 0;
+        size_t failed = 0;    // Calls that came back with an error
+    };
+
     System(Connection& conn, size_t threadCount);
+    ~System();
      // Trading-related functions
-    rapidjson::Document placeOrder(const std::string& token, const std::string& instrument, const std::string& type, double amount, double price, const std::string& label = "");
+    rapidjson::Document placeOrder(const std::string& token, const std::string& instrument, const std::string& type, double amount, double price, const std::string& label = "", Transport transport = Transport::Rest);
     std::vector<rapidjson::Document> placeOrdersAsync(const std::string &token,const std::vector<std::tuple<std::string, std::string, double, double, std::string>>& orderParams);
-    rapidjson::Document modifyOrder(const std::string& order_id, const std::string& token, const std::optional<double>& amount = std::nullopt, const std::optional<double>& contracts = std::nullopt, const std::optional<double>& price = std::nullopt, const std::optional<std::string>& advanced = std::nullopt, const std::optional<bool>& post_only = std::nullopt, const std::optional<bool>& reduce_only = std::nullopt);
-    rapidjson::Document sellOrder(const std::string& token, const std::string& instrument, const std::optional<double>& amount = std::nullopt, const std::optional<double>& contracts = std::nullopt, const std::optional<double>& price = std::nullopt, const std::optional<std::string>& type = std::nullopt, const std::optional<std::string>& trigger = std::nullopt, const std::optional<double>& trigger_price = std::nullopt);
+    rapidjson::Document modifyOrder(const std::string& order_id, const std::string& token, const std::optional<double>& amount = std::nullopt, const std::optional<double>& contracts = std::nullopt, const std::optional<double>& price = std::nullopt, const std::optional<std::string>& advanced = std::nullopt, const std::optional<bool>& post_only = std::nullopt, const std::optional<bool>& reduce_only = std::nullopt, Transport transport = Transport::Rest);
+    rapidjson::Document sellOrder(const std::string& token, const std::string& instrument, const std::optional<double>& amount = std::nullopt, const std::optional<double>& contracts = std::nullopt, const std::optional<double>& price = std::nullopt, const std::optional<std::string>& type = std::nullopt, const std::optional<std::string>& trigger = std::nullopt, const std::optional<double>& trigger_price = std::nullopt, Transport transport = Transport::Rest);
     std::vector<rapidjson::Document> sellOrdersAsync(const std::string &token,const std::vector<std::tuple<std::string, std::optional<double>, std::optional<double>, std::optional<double>, std::optional<std::string>, std::optional<std::string>, std::optional<double>>>& orderParams);
-    rapidjson::Document cancelOrder(const std::string& orderid, const std::string& token);
+    rapidjson::Document cancelOrder(const std::string& orderid, const std::string& token, Transport transport = Transport::Rest);
     std::vector<rapidjson::Document> cancelOrdersAsync(const std::vector<std::string>& orderParams,const std::string &token);
     rapidjson::Document cancelAllOrder(const std::string& token);
+    rapidjson::Document cancelAllByInstrument(const std::string& instrument, const std::string& token);
+    rapidjson::Document cancelByLabel(const std::string& label, const std::string& token);
     rapidjson::Document getOpenOrder(const std::string& token);
     rapidjson::Document getOrderState(const std::string& orderid, const std::string& token);
     rapidjson::Document getInstruments(const std::string& currency);
     rapidjson::Document getOrderBook(const std::string& instrument_name);
     rapidjson::Document getPositions(const std::string& token);
     rapidjson::Document getPosition(const std::string& token, const std::string& instrument_name);
+
+    // Typed order entry; the request is encoded directly for the chosen transport
+    rapidjson::Document placeOrder(const BuyRequest& request, const std::string& token, Transport transport = Transport::Rest);
+    rapidjson::Document sellOrder(const SellRequest& request, const std::string& token, Transport transport = Transport::Rest);
+    rapidjson::Document modifyOrder(const EditRequest& request, const std::string& token, Transport transport = Transport::Rest);
+    rapidjson::Document cancelOrder(const CancelRequest& request, const std::string& token, Transport transport = Transport::Rest);
+
+    // Same calls decoded into an OrderResult; over REST the response never becomes a DOM
+    void placeOrder(const BuyRequest& request, const std::string& token, OrderResult& result, Transport transport = Transport::Rest);
+    void sellOrder(const SellRequest& request, const std::string& token, OrderResult& result, Transport transport = Transport::Rest);
+    void modifyOrder(const EditRequest& request, const std::string& token, OrderResult& result, Transport transport = Transport::Rest);
+    void cancelOrder(const CancelRequest& request, const std::string& token, OrderResult& result, Transport transport = Transport::Rest);
+    void getOrderState(const std::string& orderid, const std::string& token, OrderResult& result);
+
+    // Batches of typed requests on the async backend, with one handle to wait on, iterate or
+    // cancel, and results delivered as each response arrives rather than in submission order.
+    // The requests are copied once and the token is shared by the whole batch. Orders pass the
+    // same instrument and risk checks as single ones.
+    OrderBatch placeOrders(const std::vector<BuyRequest>& requests, const std::string& token, OrderBatch::Callback onResult = nullptr);
+    OrderBatch sellOrders(const std::vector<SellRequest>& requests, const std::string& token, OrderBatch::Callback onResult = nullptr);
+    OrderBatch cancelOrders(const std::vector<CancelRequest>& requests, const std::string& token, OrderBatch::Callback onResult = nullptr);
+
+    // Cancel every open order matching filter in as few requests as the exchange allows:
+    // cancel_all or cancel_all_by_instrument when only the instrument narrows it, one
+    // cancel_by_label per matching label whose open orders all match, and single cancels
+    // (sent as a batch) for the rest. Labels and sides come from orderStore() while orders
+    // are tracked, otherwise from one get_open_orders call; an order placed under a label
+    // after that snapshot is cancelled with it.
+    MassCancelResult massCancel(const OrderFilter& filter, const std::string& token);
+
+    // Non-blocking typed calls on the curl_multi engine, which is started on first use whatever
+    // the async backend. onResult runs on the engine's I/O thread and must not block. Orders
+    // pass the same checks as the blocking calls.
+    void placeOrderAsync(const BuyRequest& request, const std::string& token, Trading::ResultCallback onResult);
+    void sellOrderAsync(const SellRequest& request, const std::string& token, Trading::ResultCallback onResult);
+    void modifyOrderAsync(const EditRequest& request, const std::string& token, Trading::ResultCallback onResult);
+    void cancelOrderAsync(const CancelRequest& request, const std::string& token, Trading::ResultCallback onResult);
+
+    // Edits for quoting loops that change orders faster than the exchange acknowledges them:
+    // each order keeps one edit in flight, and newer ones merge into a single waiting edit
+    // instead of each becoming a request. onResult, if set, gets the response of the edit
+    // that carried this one's fields. Sent with modifyOrderAsync.
+    void amendOrder(const EditRequest& request, const std::string& token, Trading::ResultCallback onResult = nullptr);
+    const AmendCoalescer& amendQueue() const { return amends; }
+
+    Connection& getConnection() { return conn; }
+
+    // Reference data for every instrument of currencies: read from cachePath when it is newer
+    // than maxAge, and any currency the file does not cover is fetched with getInstruments
+    // and saved there with the rest. Typed order calls
+    // are then checked against tick size and minimum amount before they are sent.
+    bool loadInstruments(const std::vector<std::string>& currencies, const std::string& cachePath = "instruments.bin",
+                         std::chrono::seconds maxAge = std::chrono::hours(24));
+    const InstrumentCache& instruments() const { return instrumentCache; }
+
+    // Pre-trade limits every typed order passes before it is sent (edits only count
+    // against its message rate). No limit is set until one is configured here. Open
+    // orders are counted until they are seen to close, which needs trackOrders() for orders
+    // that rest.
+    RiskCheck& risk() { return riskCheck; }
+
+    // Limit the REST paths (blocking, thread pool and curl_multi) to the exchange's credits; null disables it
+    void setRateLimiter(RateLimiter* limiter);
+
+    void setAsyncBackend(AsyncBackend backend);
+    AsyncBackend getAsyncBackend() const { return asyncBackend; }
+
+    // WebSocket used by Transport::WebSocket calls; it must already be connected and authenticated
+    void attachWebSocket(WebSocketClient* client) { webSocket = client; }
+
+    // Keep orderStore() current from user.orders/user.trades on client, so getOpenOrder and
+    // getOrderState are answered locally; REST is only used for the initial load, periodic
+    // reconciliation and orders the store has not seen. Stop before client is destroyed.
+    bool trackOrders(WebSocketClient& client, OrderTracker::TokenSource token,
+                     std::chrono::seconds reconcileInterval = std::chrono::seconds(30));
+    void stopTrackingOrders();
+    bool isTrackingOrders() const { return orderTracker && orderTracker->isRunning(); }
+    OrderStore& orderStore() { return orders; }
+
+    // Seed positionCache() over REST, then keep it current from user.changes and
+    // user.portfolio.<currency> on client; getPositions and getPosition are answered from it
+    // while this runs. Stop before client is destroyed.
+    bool trackPositions(WebSocketClient& client, const std::string& token,
+                        const std::vector<std::string>& currencies = {"BTC", "ETH"});
+    void stopTrackingPositions();
+    bool isTrackingPositions() const { return positionClient != nullptr; }
+    const PositionCache& positionCache() const { return positionStore; }
 private:
+    WebSocketClient& requireWebSocket();
+    const char* preTradeCheck(const OrderRequest& request, InstrumentId& id);
+    void settleOrder(InstrumentId id, bool accepted, OrderResult::State state, std::string_view orderId);
+    void releaseCounted(const std::string& orderId);
+    void settleOrder(InstrumentId id, const rapidjson::Document& response);
+    void collectOrders(std::vector<std::future<rapidjson::Document>>& futures, const std::vector<InstrumentId>& ids,
+                       std::vector<rapidjson::Document>& results);
+
+    // How a batch sends request index: blocking on a pool thread, or submitted to the curl_multi engine
+    using BatchCall = std::function<void(size_t index, const std::string& token, OrderResult& result)>;
+    using BatchSubmit = std::function<void(size_t index, const std::string& token, Trading::ResultCallback onResult)>;
+    OrderBatch runBatch(size_t count, const std::string& token, OrderBatch::Callback onResult, BatchCall call, BatchSubmit submit);
+    RequestEngine& startEngine();
+    template<typename Request>
+    void submitOrder(const Request& request, const std::string& token, Trading::ResultCallback onResult);
+
     Connection& conn;
     Trading trading;
     ThreadPool threadPool;
+    std::unique_ptr<RequestEngine> engine;
+    std::once_flag engineStarted;
+    AsyncBackend asyncBackend = AsyncBackend::ThreadPool;
+    WebSocketClient* webSocket = nullptr;
+    OrderStore orders;
+    std::unique_ptr<OrderTracker> orderTracker;
+    PositionCache positionStore;
+    InstrumentCache instrumentCache;
+    RiskCheck riskCheck{instrumentCache};
+    // Resting orders placed here while orders are tracked, whose slot the feed gives back on close
+    std::mutex countedMutex;
+    std::unordered_map<std::string, InstrumentId> countedOrders;
+    WebSocketClient* positionClient = nullptr;
+    uint64_t changesHandler = 0;
+    uint64_t portfolioHandler = 0;
+    AmendCoalescer amends; // Last, so pending edits complete before anything they use is destroyed
 };
 
 #endif // SYSTEM_H
@@ -1,91 +1,414 @@
 #ifndef THREADPOOL_H
 #define THREADPOOL_H
 
-#include <future>   // For std::future and std::packaged_task
-#include <vector>   // For std::vector
-#include <queue>    // For std::queue
-#include <mutex>    // For std::mutex and std::unique_lock
-#include <condition_variable> // For std::condition_variable
-#include <functional> // For std::function and std::bind
-#include <thread>   // For std::thread
-#include <stdexcept> // For std::runtime_error
-#include <memory>   // For std::shared_ptr
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stdexcept>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
+// Counts outstanding tasks so a caller can wait for a batch without a future per task.
+// done() is one atomic decrement; only the last one takes the lock to wake the waiter.
+class WaitGroup {
+public:
+    WaitGroup() = default;
+    WaitGroup(const WaitGroup&) = delete;
+    WaitGroup& operator=(const WaitGroup&) = delete;
+
+    void add(size_t count = 1) { pending.fetch_add(count, std::memory_order_relaxed); }
+
+    void done() {
+        size_t current = pending.load(std::memory_order_relaxed);
+        while (current > 1) {
+            if (pending.compare_exchange_weak(current, current - 1, std::memory_order_acq_rel)) {
+                return;
+            }
+        }
+        // The last decrement happens under the lock, so wait() cannot return and destroy the
+        // group while it is still being notified
+        std::lock_guard<std::mutex> lock(mutex);
+        pending.fetch_sub(1, std::memory_order_acq_rel);
+        finished.notify_all();
+    }
+
+    // Block until every added task is done; what the tasks wrote is visible afterwards
+    void wait() {
+        std::unique_lock<std::mutex> lock(mutex);
+        finished.wait(lock, [this]() { return pending.load(std::memory_order_acquire) == 0; });
+    }
+
+private:
+    std::atomic<size_t> pending{0};
+    std::mutex mutex;
+    std::condition_variable finished;
+};
+
+// Move-only callable that keeps small captures inline, so queuing a task does not allocate.
+// Larger callables fall back to one heap allocation.
+class Task {
+public:
+    static constexpr size_t InlineSize = 48;
+
+    Task() = default;
+
+    template<typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, Task>>>
+    Task(F&& f) {
+        using Fn = std::decay_t<F>;
+        if constexpr (sizeof(Fn) <= InlineSize && alignof(Fn) <= alignof(std::max_align_t) &&
+                      std::is_nothrow_move_constructible_v<Fn>) {
+            new (storage) Fn(std::forward<F>(f));
+            ops = &inlineOps<Fn>;
+        } else {
+            new (storage) Fn*(new Fn(std::forward<F>(f)));
+            ops = &heapOps<Fn>;
+        }
+    }
+
+    Task(Task&& other) noexcept : ops(other.ops) {
+        if (ops) {
+            ops->relocate(other.storage, storage);
+            other.ops = nullptr;
+        }
+    }
+
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            reset();
+            ops = other.ops;
+            if (ops) {
+                ops->relocate(other.storage, storage);
+                other.ops = nullptr;
+            }
+        }
+        return *this;
+    }
+
+    ~Task() { reset(); }
+
+    explicit operator bool() const { return ops != nullptr; }
+    void operator()() { ops->invoke(storage); }
+
+    void reset() {
+        if (ops) {
+            ops->destroy(storage);
+            ops = nullptr;
+        }
+    }
+
+private:
+    struct Ops {
+        void (*invoke)(void* storage);
+        void (*relocate)(void* from, void* to); // Move into to and destroy from
+        void (*destroy)(void* storage);
+    };
+
+    template<typename Fn>
+    static constexpr Ops inlineOps = {
+        [](void* storage) { (*static_cast<Fn*>(storage))(); },
+        [](void* from, void* to) {
+            new (to) Fn(std::move(*static_cast<Fn*>(from)));
+            static_cast<Fn*>(from)->~Fn();
+        },
+        [](void* storage) { static_cast<Fn*>(storage)->~Fn(); }
+    };
+
+    template<typename Fn>
+    static constexpr Ops heapOps = {
+        [](void* storage) { (**static_cast<Fn**>(storage))(); },
+        [](void* from, void* to) { new (to) Fn*(*static_cast<Fn**>(from)); },
+        [](void* storage) { delete *static_cast<Fn**>(storage); }
+    };
+
+    alignas(std::max_align_t) unsigned char storage[InlineSize];
+    const Ops* ops = nullptr;
+};
+
+// Work-stealing pool. Each worker owns a queue; producers put a task in the first queue whose
+// lock they can take without waiting, so bursts from many threads spread out instead of
+// serialising on one mutex. A worker runs its own queue oldest first and, when it is empty,
+// steals the newest task of another worker. Idle workers sleep on a shared condition variable
+// that producers only touch when someone is asleep.
 class ThreadPool {
 public:
     // Constructor: Creates a thread pool with the specified number of threads.
-    ThreadPool(size_t threadCount) : running_(true) {
+    ThreadPool(size_t threadCount)
+        : queueCount(std::max<size_t>(threadCount, 1)), queues(new WorkQueue[std::max<size_t>(threadCount, 1)]) {
+        workers.reserve(threadCount);
         for (size_t i = 0; i < threadCount; ++i) {
-            // Create and start worker threads. Each thread executes workerThread().
-            workers.emplace_back([this]() { workerThread(); });
+            workers.emplace_back([this, i]() { workerThread(i); });
         }
     }
 
-    // Destructor: Stops the thread pool and joins all worker threads.
-    ~ThreadPool() {
+    // Destructor: Runs the tasks already queued, then joins all worker threads.
+    ~ThreadPool() { shutdown(); }
+
+    // Same, for owners that must drain the pool before destroying what its tasks use.
+    // Posting afterwards throws, as after destruction began.
+    void shutdown() {
         {
-            // Acquire lock to safely modify running_
-            std::unique_lock<std::mutex> lock(queueMutex_);
-            running_ = false; // Signal worker threads to stop
-        } // Lock is released here! Crucial to prevent deadlock.
-        condition_.notify_all(); // Wake up all waiting threads
+            std::lock_guard<std::mutex> lock(sleepMutex);
+            running.store(false, std::memory_order_seq_cst);
+        }
+        wake.notify_all();
         for (std::thread& worker : workers) {
-            worker.join(); // Wait for all worker threads to finish
+            if (worker.joinable()) {
+                worker.join();
+            }
         }
     }
 
-    // Enqueue: Adds a task to the thread pool.
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    // Enqueue: Adds a task to the thread pool and returns a future for its result.
     template<typename F, typename... Args>
     auto enqueue(F&& f, Args&&... args) -> std::future<std::invoke_result_t<F, Args...>> {
         using return_type = std::invoke_result_t<F, Args...>;
 
-        // Create a packaged task to manage the task and its result.
-        auto task = std::make_shared<std::packaged_task<return_type()>>(
-            std::bind(std::forward<F>(f), std::forward<Args>(args)...) // Bind function and arguments
-        );
+        // The packaged task moves into the queued task itself; only its shared state is allocated
+        std::packaged_task<return_type()> task(std::bind(std::forward<F>(f), std::forward<Args>(args)...));
+        std::future<return_type> res = task.get_future();
+        push(Task([task = std::move(task)]() mutable { task(); }));
+        return res;
+    }
+
+    // Fire and forget: no future, and no allocation for small callables
+    template<typename F>
+    void post(F&& f) {
+        push(Task(std::forward<F>(f)));
+    }
+
+    // Same, counted in group
+    template<typename F>
+    void post(WaitGroup& group, F&& f) {
+        group.add();
+        try {
+            push(Task([&group, f = std::forward<F>(f)]() mutable {
+                DoneGuard guard{group};
+                f();
+            }));
+        } catch (...) {
+            group.done();
+            throw;
+        }
+    }
+
+    // Run f(0) ... f(count - 1) and count them in group. The calls are split into a few chunks
+    // per worker, each holding its own copy of f, and every queue is locked once for the lot.
+    template<typename F>
+    void bulk(size_t count, const F& f, WaitGroup& group) {
+        if (count == 0) {
+            return;
+        }
+        if (!running.load(std::memory_order_acquire)) {
+            throw std::runtime_error("enqueue on stopped ThreadPool");
+        }
+        const size_t chunks = std::min(count, queueCount * ChunksPerWorker);
+        group.add(chunks);
+        const size_t start = nextQueue();
+        for (size_t q = 0; q < std::min(queueCount, chunks); ++q) {
+            WorkQueue& queue = queues[(start + q) % queueCount];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            // Chunks q, q + queueCount, ... go to this queue
+            size_t pushed = 0;
+            for (size_t chunk = q; chunk < chunks; chunk += queueCount, ++pushed) {
+                const size_t begin = count * chunk / chunks;
+                const size_t end = count * (chunk + 1) / chunks;
+                queue.pushLocked(Task([&group, f, begin, end]() {
+                    DoneGuard guard{group};
+                    for (size_t i = begin; i < end; ++i) {
+                        f(i);
+                    }
+                }));
+            }
+            queued.fetch_add(pushed, std::memory_order_seq_cst);
+        }
+        wakeSleepers(chunks);
+    }
+
+private:
+    static constexpr size_t InitialQueueCapacity = 256; // Power of two
+    static constexpr size_t ChunksPerWorker = 4;
+    static constexpr int SpinRounds = 64; // Polls before an idle worker sleeps
+
+    struct DoneGuard {
+        WaitGroup& group;
+        ~DoneGuard() { group.done(); }
+    };
+
+    // One worker's tasks in a ring buffer that only grows, so steady-state pushes do not allocate
+    struct alignas(64) WorkQueue {
+        std::mutex mutex;
+        std::vector<Task> ring = std::vector<Task>(InitialQueueCapacity);
+        size_t head = 0;
+        size_t count = 0;
+
+        void pushLocked(Task&& task) {
+            if (count == ring.size()) {
+                std::vector<Task> larger(ring.size() * 2);
+                for (size_t i = 0; i < count; ++i) {
+                    larger[i] = std::move(ring[(head + i) & (ring.size() - 1)]);
+                }
+                ring.swap(larger);
+                head = 0;
+            }
+            ring[(head + count) & (ring.size() - 1)] = std::move(task);
+            ++count;
+        }
+
+        bool popFrontLocked(Task& out) {
+            if (count == 0) {
+                return false;
+            }
+            out = std::move(ring[head]);
+            head = (head + 1) & (ring.size() - 1);
+            --count;
+            return true;
+        }
+
+        bool popBackLocked(Task& out) {
+            if (count == 0) {
+                return false;
+            }
+            --count;
+            out = std::move(ring[(head + count) & (ring.size() - 1)]);
+            return true;
+        }
+    };
 
-        std::future<return_type> res = task->get_future(); // Get the future for the result
+    // Workers push to their own queue; other threads rotate through the queues
+    size_t nextQueue() {
+        if (currentPool == this) {
+            return currentIndex;
+        }
+        if (producerTicket == 0) {
+            producerTicket = std::hash<std::thread::id>()(std::this_thread::get_id()) | 1;
+        }
+        return producerTicket++ % queueCount;
+    }
 
+    void push(Task&& task) {
+        if (!running.load(std::memory_order_acquire)) {
+            throw std::runtime_error("enqueue on stopped ThreadPool");
+        }
+        const size_t start = nextQueue();
+        for (size_t i = 0; i < queueCount; ++i) {
+            WorkQueue& queue = queues[(start + i) % queueCount];
+            std::unique_lock<std::mutex> lock(queue.mutex, std::try_to_lock);
+            if (lock.owns_lock()) {
+                queue.pushLocked(std::move(task));
+                queued.fetch_add(1, std::memory_order_seq_cst);
+                lock.unlock();
+                wakeSleepers(1);
+                return;
+            }
+        }
+        // Every queue is busy: wait for the first one
+        {
+            std::lock_guard<std::mutex> lock(queues[start].mutex);
+            queues[start].pushLocked(std::move(task));
+            queued.fetch_add(1, std::memory_order_seq_cst);
+        }
+        wakeSleepers(1);
+    }
+
+    // queued is raised before sleeping is read, and a worker raises sleeping before it reads
+    // queued, so either the producer sees the sleeper or the sleeper sees the task
+    void wakeSleepers(size_t tasks) {
+        if (sleeping.load(std::memory_order_seq_cst) == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(sleepMutex);
+        if (tasks == 1) {
+            wake.notify_one();
+        } else {
+            wake.notify_all();
+        }
+    }
+
+    // Own queue first, then steal from the others without waiting on their locks
+    bool takeTask(size_t index, Task& task) {
         {
-            // Acquire lock to safely access the task queue.
-            std::unique_lock<std::mutex> lock(queueMutex_);
-            if (!running_) {
-                throw std::runtime_error("enqueue on stopped ThreadPool"); // Throw if enqueue is called after destructor
+            std::lock_guard<std::mutex> lock(queues[index].mutex);
+            if (queues[index].popFrontLocked(task)) {
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+        for (size_t i = 1; i < queueCount; ++i) {
+            WorkQueue& victim = queues[(index + i) % queueCount];
+            std::unique_lock<std::mutex> lock(victim.mutex, std::try_to_lock);
+            if (lock.owns_lock() && victim.popBackLocked(task)) {
+                queued.fetch_sub(1, std::memory_order_relaxed);
+                return true;
             }
-            // Push the task onto the queue. Lambda captures the shared_ptr to the task.
-            taskQueue_.push([task]() { (*task)(); });
-        } // Lock is released here
+        }
+        return false;
+    }
 
-        condition_.notify_one(); // Notify one waiting worker thread
-        return res; // Return the future
+    void run(Task& task) {
+        try {
+            task();
+        } catch (const std::exception& e) {
+            std::cerr << "Uncaught exception in pool task: " << e.what() << std::endl;
+        } catch (...) {
+            std::cerr << "Uncaught exception in pool task" << std::endl;
+        }
+        task.reset(); // Release the captures now rather than when the next task replaces them
     }
 
-private:
-    // workerThread: Function executed by each worker thread.
-    void workerThread() {
+    void workerThread(size_t index) {
+        currentPool = this;
+        currentIndex = index;
+        Task task;
         while (true) {
-            std::function<void()> task;
-            {
-                // Acquire lock to access the task queue and running_ flag.
-                std::unique_lock<std::mutex> lock(queueMutex_);
-                // Wait for a task or for the thread pool to be stopped. Predicate prevents spurious wakeups.
-                condition_.wait(lock, [this]() { return !taskQueue_.empty() || !running_; });
-                if (!running_ && taskQueue_.empty()) {
-                    return; // Exit if the thread pool is stopped and there are no more tasks.
-                }
-                // Retrieve the task from the queue using move semantics.
-                task = std::move(taskQueue_.front());
-                taskQueue_.pop();
-            } // Lock is released here! Before executing the task.
-            task(); // Execute the task (outside the lock).
+            bool found = takeTask(index, task);
+            for (int spin = 0; !found && spin < SpinRounds; ++spin) {
+                std::this_thread::yield();
+                found = takeTask(index, task);
+            }
+            if (found) {
+                run(task);
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(sleepMutex);
+            sleeping.fetch_add(1, std::memory_order_seq_cst);
+            wake.wait(lock, [this]() {
+                return queued.load(std::memory_order_seq_cst) > 0 || !running.load(std::memory_order_seq_cst);
+            });
+            sleeping.fetch_sub(1, std::memory_order_relaxed);
+            if (!running.load(std::memory_order_relaxed) && queued.load(std::memory_order_relaxed) == 0) {
+                return; // Stopped and drained
+            }
         }
     }
 
-    std::vector<std::thread> workers; // Vector of worker threads
-    std::queue<std::function<void()>> taskQueue_; // Queue of tasks
-    std::mutex queueMutex_; // Mutex to protect shared data
-    std::condition_variable condition_; // Condition variable for thread synchronization
-    bool running_; // Flag to indicate if the thread pool is running
+    static inline thread_local const ThreadPool* currentPool = nullptr;
+    static inline thread_local size_t currentIndex = 0;
+    static inline thread_local size_t producerTicket = 0;
+
+    const size_t queueCount;
+    std::unique_ptr<WorkQueue[]> queues;
+    std::vector<std::thread> workers;
+
+    alignas(64) std::atomic<size_t> queued{0}; // Tasks in all queues
+    alignas(64) std::atomic<size_t> sleeping{0};
+    std::atomic<bool> running{true};
+    std::mutex sleepMutex;
+    std::condition_variable wake;
 };
 
-#endif
\ No newline at end of file
+#endif
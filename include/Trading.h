@@ -2,12 +2,19 @@
 #define TRADING_H
 
 #include "Connection.h"
+#include "RequestEngine.h"
+#include "OrderRequests.h"
+#include "OrderResult.h"
 #include "rapidjson/document.h"
-#include <unordered_map>
 #include <optional>
+#include <future>
+#include <functional>
 
 class Trading {
 public:
+    // Receives a decoded order response on the engine's I/O thread; must not block
+    using ResultCallback = std::function<void(const OrderResult&)>;
+
     Trading(Connection& conn);
 
     rapidjson::Document placeOrder(
@@ -40,13 +47,89 @@ public:
 
     rapidjson::Document cancelOrder(const std::string& orderid, const std::string& token);
     rapidjson::Document cancelAllOrder(const std::string& token);
+    // One request for every open order of an instrument, or with exactly this label; the result is the count cancelled
+    rapidjson::Document cancelAllByInstrument(const std::string& instrument, const std::string& token);
+    rapidjson::Document cancelByLabel(const std::string& label, const std::string& token);
     rapidjson::Document getOpenOrder(const std::string& token);
     rapidjson::Document getOrderState(const std::string& orderid, const std::string& token);
     rapidjson::Document getOrderBook(const std::string& instrument_name);
     rapidjson::Document getPositions(const std::string& token);
     rapidjson::Document getPosition(const std::string& token,const std::string& instrument_name);
+    rapidjson::Document getAccountSummary(const std::string& token, const std::string& currency);
+    rapidjson::Document getInstruments(const std::string& currency);
+
+    // Typed requests, encoded straight into a reused per-thread buffer
+    rapidjson::Document placeOrder(const BuyRequest& request, const std::string& token);
+    rapidjson::Document sellOrder(const SellRequest& request, const std::string& token);
+    rapidjson::Document modifyOrder(const EditRequest& request, const std::string& token);
+    rapidjson::Document cancelOrder(const CancelRequest& request, const std::string& token);
+
+    // Hot-path variants that decode only the fields in OrderResult, without building a DOM
+    void placeOrder(const BuyRequest& request, const std::string& token, OrderResult& result);
+    void sellOrder(const SellRequest& request, const std::string& token, OrderResult& result);
+    void modifyOrder(const EditRequest& request, const std::string& token, OrderResult& result);
+    void cancelOrder(const CancelRequest& request, const std::string& token, OrderResult& result);
+    void getOrderState(const std::string& order_id, const std::string& token, OrderResult& result);
+
+    // Non-blocking variants completed by the curl_multi engine (see setEngine)
+    std::future<rapidjson::Document> placeOrderAsync(
+        const std::string& token,
+        const std::string& instrument,
+        const std::string& type,
+        double amount = 0.0,
+        double price = 0.0,
+        const std::string& label = "");
+
+    std::future<rapidjson::Document> sellOrderAsync(
+        const std::string& token,
+        const std::string& instrument,
+        const std::optional<double>& amount = std::nullopt,
+        const std::optional<double>& contracts = std::nullopt,
+        const std::optional<double>& price = std::nullopt,
+        const std::optional<std::string>& type = std::nullopt,
+        const std::optional<std::string>& trigger = std::nullopt,
+        const std::optional<double>& trigger_price = std::nullopt);
+
+    std::future<rapidjson::Document> cancelOrderAsync(const std::string& orderid, const std::string& token);
+
+    std::future<rapidjson::Document> placeOrderAsync(const BuyRequest& request, const std::string& token);
+    std::future<rapidjson::Document> sellOrderAsync(const SellRequest& request, const std::string& token);
+    std::future<rapidjson::Document> modifyOrderAsync(const EditRequest& request, const std::string& token);
+    std::future<rapidjson::Document> cancelOrderAsync(const CancelRequest& request, const std::string& token);
+
+    void placeOrderAsync(const BuyRequest& request, const std::string& token, ResultCallback onResult);
+    void sellOrderAsync(const SellRequest& request, const std::string& token, ResultCallback onResult);
+    void modifyOrderAsync(const EditRequest& request, const std::string& token, ResultCallback onResult);
+    void cancelOrderAsync(const CancelRequest& request, const std::string& token, ResultCallback onResult);
+
+    // Requests built from the string-based arguments; nullopt if a type or trigger name is unknown
+    static std::optional<BuyRequest> buyRequest(
+        const std::string& instrument, const std::string& type, double amount, double price, const std::string& label);
+    static std::optional<SellRequest> sellRequest(
+        const std::string& instrument,
+        const std::optional<double>& amount,
+        const std::optional<double>& contracts,
+        const std::optional<double>& price,
+        const std::optional<std::string>& type,
+        const std::optional<std::string>& trigger,
+        const std::optional<double>& trigger_price);
+    static EditRequest editRequest(
+        const std::string& order_id,
+        const std::optional<double>& amount,
+        const std::optional<double>& contracts,
+        const std::optional<double>& price,
+        const std::optional<std::string>& advanced,
+        const std::optional<bool>& post_only,
+        const std::optional<bool>& reduce_only);
+
+    void setEngine(RequestEngine* requestEngine) { engine = requestEngine; }
 private:
+    RequestEngine& requireEngine();
+    void sendForResult(const std::string& target, const std::string& token, OrderResult& result);
+    void submitForResult(const std::string& target, const std::string& token, ResultCallback onResult);
+
     Connection& conn;
+    RequestEngine* engine = nullptr;
 };
 
 #endif // TRADING_H
@@ -25,5 +25,4 @@ using namespace std;
 string jsonToString(const rapidjson::Document& doc);
 void showNetworkMenu();
 void showTradeMenu();
-void testOrderPlacement(int numCalls, string token, System& system);
 #endif
\ No newline at end of file
@@ -1,17 +1,40 @@
+#ifndef WEBSOCKET_CLIENT_H
+#define WEBSOCKET_CLIENT_H
+
 #include <websocketpp/client.hpp>
 #include <websocketpp/config/asio_client.hpp>
 #include <atomic>
+#include <memory>
+#include <vector>
 #include <mutex>
 #include <thread>
-#include <queue>
 #include <functional>
+#include <future>
+#include <optional>
+#include "PendingRequestTable.h"
+#include "OrderBook.h"
+#include "SpscRing.h"
+#include "InsituParser.h"
+#include "OrderRequests.h"
+#include "RateLimiter.h"
+#include "ChannelRegistry.h"
+#include "SimdFeedDecoder.h"
+#include <string_view>
+#include "rapidjson/document.h"
+#include "rapidjson/writer.h"
+#include "rapidjson/stringbuffer.h"
 
 class WebSocketClient {
 public:
     // Type definitions for WebSocket client
     using Client = websocketpp::client<websocketpp::config::asio_tls_client>;
     using MessagePtr = websocketpp::config::asio_client::message_type::ptr;
-    using MessageHandler = std::function<void(const std::string&)>;
+    // Receives each raw frame before it is parsed; the view is only valid during the call
+    using MessageHandler = std::function<void(std::string_view)>;
+    using RpcCallback = PendingRequestTable::Callback;
+    using BookHandler = std::function<void(const OrderBook&)>;
+    // Receives the data of a subscription notification; both are only valid during the call
+    using ChannelHandler = std::function<void(std::string_view channel, const rapidjson::Value& data)>;
 
     WebSocketClient();
     ~WebSocketClient();
@@ -19,16 +42,101 @@ public:
     // Connection management
     bool connect(const std::string& host, const std::string& port);
     bool subscribe(const std::string& channel, const std::string& token);
+    // Subscribe to many channels, MAX_CHANNELS_PER_SUBSCRIBE to a request. Every channel is
+    // interned first, so its notifications are routed by id.
+    bool subscribe(const std::vector<std::string>& channels, const std::string& token);
     void listen();
     void close();
     void startWebSocketSession(const std::string& token);
 
+    // Connect and start the listener without the interactive subscription prompt
+    bool startSession(const std::string& host, const std::string& port, const std::string& token);
+
+    // JSON-RPC order entry over the authenticated connection, encoded without a DOM.
+    // Responses are delivered by the listener thread, so waiting on one of these futures from
+    // a message, book or channel handler never returns; handlers use the callback overloads.
+    std::future<rapidjson::Document> buy(const BuyRequest& request);
+    std::future<rapidjson::Document> sell(const SellRequest& request);
+    std::future<rapidjson::Document> edit(const EditRequest& request);
+    std::future<rapidjson::Document> cancel(const CancelRequest& request);
+
+    // Same, completing through a callback on the listener thread; returns the request id, 0 if not sent
+    uint64_t buy(const BuyRequest& request, RpcCallback callback);
+    uint64_t sell(const SellRequest& request, RpcCallback callback);
+    uint64_t edit(const EditRequest& request, RpcCallback callback);
+    uint64_t cancel(const CancelRequest& request, RpcCallback callback);
+
+    // Send any JSON-RPC method; params is written by the caller between StartObject/EndObject
+    using ParamsWriter = std::function<void(rapidjson::Writer<rapidjson::StringBuffer>&)>;
+    uint64_t sendRpc(const std::string& method, const ParamsWriter& writeParams, RpcCallback callback);
+
+    void setAccessToken(const std::string& token);
+
+    // JSON-RPC requests take their credits from this limiter before they are sent; a rejected
+    // request completes with the exchange's too_many_requests error. Null disables it.
+    void setRateLimiter(RateLimiter* limiter) { rateLimiter.store(limiter, std::memory_order_relaxed); }
+
+    // public/auth with a refresh token on this connection; subscriptions are kept and the
+    // new access token is used from then on. Returns the request id, 0 if not sent
+    uint64_t refreshAuth(const std::string& refreshToken, RpcCallback callback);
+
     // Callback setters
     void setMessageHandler(MessageHandler handler) { messageHandler = handler; }
+    // Called on the listener thread after each book update is applied
+    void setBookHandler(BookHandler handler) { bookHandler = handler; }
+
+    // Called on the listener thread for notifications on channels starting with prefix.
+    // Safe to call while the session runs; returns an id for removeChannelHandler
+    uint64_t addChannelHandler(const std::string& prefix, ChannelHandler handler);
+    // Same for exactly these channels, which are interned
+    uint64_t addExactChannelHandler(const std::vector<std::string>& channels, ChannelHandler handler);
+    void removeChannelHandler(uint64_t id);
+
+    // Channels interned by subscribe() and addExactChannelHandler()
+    const ChannelRegistry& channels() const { return channelRegistry; }
+
+    // Local books built from book.* notifications; only touch them from the listener thread
+    OrderBookManager& orderBooks() { return orderBookManager; }
     
     // Status checks
     bool isConnected() const { return connected; }
     bool isRunning() const { return m_isRunning; }
+    // Whether the caller is the listener thread, which runs the handlers and delivers responses
+    bool onListenerThread() const { return std::this_thread::get_id() == listenerThreadId.load(); }
+
+    // How the listener and shard threads wait for messages; set before the session starts
+    void setWaitStrategy(WaitStrategy strategy);
+
+    // JSON parser for the feed. With Simdjson, book.* notifications that no channel handler
+    // listens to are decoded by SimdFeedDecoder straight into the order book without building
+    // a DOM; responses and every other notification still go through rapidjson. Simdjson is
+    // the default in builds with GOQUANT_WITH_SIMDJSON. Set before the session starts;
+    // returns false if this build has no simdjson.
+    enum class FeedParser { RapidJson, Simdjson };
+    bool setFeedParser(FeedParser backend);
+    FeedParser getFeedParser() const { return feedParser; }
+
+    // Market data across several cores: notifications on public channels (book, trades,
+    // ticker, ...) are parsed and handled by count shard workers instead of the listener.
+    // Each shard owns the instruments that hash to it, so one instrument's messages keep
+    // their order, and shard i is pinned to cores[i] when given. Responses and user.*
+    // channels stay on the listener. Book and channel handlers for market data then run on
+    // the shard threads, for different instruments at once, and the message handler no longer
+    // sees those frames. Set before the session starts; 0 keeps everything on the listener.
+    void setMarketDataShards(size_t count, std::vector<int> cores = {});
+    size_t marketDataShards() const { return shards.size(); }
+    // Notifications each shard has handled
+    std::vector<uint64_t> shardMessageCounts() const;
+    // Books of the instruments a shard owns; only touch them from that shard's handlers
+    OrderBookManager& shardOrderBooks(size_t shard) { return shards[shard]->books; }
+
+    // Time from on_message enqueueing a frame to the listener dequeuing it
+    struct QueueLatency {
+        uint64_t count = 0;
+        double meanNs = 0.0;
+        uint64_t maxNs = 0;
+    };
+    QueueLatency getQueueLatency() const;
 
 private:
     // WebSocket callbacks
@@ -39,8 +147,24 @@ private:
 
     // Helper methods
     bool reconnect();
-    void processMessage(const std::string& message);
-    std::string constructSubscriptionMessage(const std::string& channel, const std::string& token);
+    void processMessage(std::string& message);
+    void handleNotification(const rapidjson::Value& params, OrderBookManager& books);
+    bool decodeBookFrame(std::string& frame, SimdFeedDecoder& decoder, BookDelta& delta, OrderBookManager& books);
+    void onBookResult(std::string_view channel, const OrderBook* book, OrderBook::Result result);
+    std::string constructSubscriptionMessage(const std::string* channels, size_t count, const std::string& token,
+                                             const char* method = "private/subscribe");
+    bool sendSubscriptions(const std::vector<std::string>& channels, const std::string& token);
+    void resubscribe(const std::string& channel);
+    void startListener();
+    void failPendingRequests(const char* reason);
+    std::future<rapidjson::Document> sendRpcFuture(const std::string& method, const ParamsWriter& writeParams);
+    template <typename Request>
+    uint64_t sendEncoded(const Request& request, RpcCallback callback);
+    template <typename Request>
+    std::future<rapidjson::Document> sendEncoded(const Request& request);
+    uint64_t registerRpc(RpcCallback& callback, RateLimiter::Bucket bucket);
+    bool sendFrame(uint64_t id, const char* data, size_t size);
+    static rapidjson::Document errorDocument(const char* message);
 
     // WebSocket client and connection
     Client client;
@@ -48,6 +172,7 @@ private:
     
     // Thread management
     std::thread m_listenerThread;
+    std::atomic<std::thread::id> listenerThreadId{}; // Kept after the thread is detached
     std::mutex mutex_;
     
     // Status flags
@@ -59,12 +184,88 @@ private:
     std::string m_host;
     std::string m_port;
     
-    // Message handling
+    // A received frame and when on_message queued it
+    struct QueuedMessage {
+        std::string payload;
+        int64_t enqueuedNs = 0;
+    };
+    static int64_t nowNs();
+
+    // Message handling: on_message (ASIO thread) produces, the listener thread consumes
     MessageHandler messageHandler;
-    std::queue<std::string> messageQueue;
-    std::mutex queueMutex;
+    SpscRing<QueuedMessage> messageQueue;
+    std::atomic<uint64_t> queueLatencyCount{0};
+    std::atomic<uint64_t> queueLatencyTotalNs{0};
+    std::atomic<uint64_t> queueLatencyMaxNs{0};
+    InsituParser parser; // Listener thread only
+    SimdFeedDecoder feedDecoder; // Listener thread only
+    BookDelta decodedBook;       // Listener thread only
+    FeedParser feedParser;
+
+    // One market-data worker. Only on_message pushes to its queue, and the parser and books
+    // are only touched by its own thread.
+    struct FeedShard {
+        FeedShard(size_t capacity, WaitStrategy strategy) : queue(capacity, strategy) {}
+        SpscRing<QueuedMessage> queue;
+        InsituParser parser;
+        SimdFeedDecoder decoder;
+        BookDelta decoded;
+        OrderBookManager books;
+        std::thread worker;
+        int core = -1;                   // Pinned core, -1 for none
+        std::atomic<uint64_t> handled{0};
+    };
+    static constexpr size_t NoShard = SIZE_MAX;
+    size_t shardFor(std::string_view frame) const;
+    void runShard(FeedShard& shard);
+    void startShards();
+    void stopShards();
+    std::vector<std::unique_ptr<FeedShard>> shards; // Fixed while a session runs
+    std::atomic<bool> shardsRunning{false};
+
+    // Local order books
+    OrderBookManager orderBookManager;
+    BookHandler bookHandler;
+
+    // Channel handlers, copied on change so the listener reads them without a lock.
+    // A handler takes either a prefix or a set of interned channels.
+    struct ChannelSubscriber {
+        uint64_t id;
+        std::string prefix;
+        std::vector<ChannelId> exact; // Sorted; empty for a prefix handler
+        ChannelHandler handler;
+
+        bool matches(ChannelId channel, std::string_view name) const;
+    };
+    // The handlers plus, for every channel of index, which of them it goes to, so a
+    // notification on an interned channel costs one index lookup and no prefix scan.
+    // Channels interned after the table was built fall back to the prefix scan.
+    struct ChannelTable {
+        std::shared_ptr<const ChannelIndex> index;
+        std::vector<ChannelSubscriber> subscribers;
+        std::vector<std::vector<uint32_t>> byChannel; // Positions in subscribers, by ChannelId
+    };
+    void publishChannelTableLocked(std::vector<ChannelSubscriber> subscribers);
+    void dispatchChannel(std::string_view channel, const rapidjson::Value& data);
+    bool hasChannelHandlers(std::string_view channel) const;
+
+    ChannelRegistry channelRegistry;
+    // Only accessed through std::atomic_load/std::atomic_store
+    std::shared_ptr<const ChannelTable> channelHandlers;
+    std::mutex channelHandlersMutex; // Serialises writers
+    uint64_t nextChannelHandlerId = 1;
+
+    // JSON-RPC request ids and the requests still waiting for a response
+    std::atomic<uint64_t> nextRequestId{1};
+    PendingRequestTable pendingRequests;
+    std::string accessToken;
+    std::mutex tokenMutex;
+    std::atomic<RateLimiter*> rateLimiter{nullptr};
     
     // Constants
     static constexpr int RECONNECT_DELAY_MS = 5000;
     static constexpr int MAX_RECONNECT_ATTEMPTS = 5;
-};
\ No newline at end of file
+    static constexpr size_t MAX_CHANNELS_PER_SUBSCRIBE = 256;
+};
+
+#endif // WEBSOCKET_CLIENT_H
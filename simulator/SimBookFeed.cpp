@@ -0,0 +1,114 @@
+#include "SimBookFeed.h"
+#include "RequestEncoder.h"
+#include <chrono>
+#include <cmath>
+
+namespace {
+
+int64_t nowMillis() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void appendLevel(std::string& out, const char* action, double price, double amount) {
+    out += "[\"";
+    out += action;
+    out += "\",";
+    RequestEncoder::appendNumber(out, price);
+    out += ',';
+    RequestEncoder::appendNumber(out, amount);
+    out += ']';
+}
+
+template <typename Side>
+void appendSide(std::string& out, const Side& side) {
+    out += '[';
+    bool first = true;
+    for (const auto& level : side) {
+        if (!first) {
+            out += ',';
+        }
+        first = false;
+        appendLevel(out, "new", level.first, level.second);
+    }
+    out += ']';
+}
+
+} // namespace
+
+SimBookFeed::SimBookFeed(std::string channel, std::string instrument, double mid, double tick, int depth, uint64_t seed)
+    : channelName(std::move(channel)), instrument(std::move(instrument)), tick(tick),
+      minLevels(static_cast<size_t>(depth) / 10 + 1), rng(seed) {
+    for (int i = 0; i < depth; ++i) {
+        bids[mid - (i + 1) * tick] = std::round(size(rng));
+        asks[mid + (i + 1) * tick] = std::round(size(rng));
+    }
+}
+
+void SimBookFeed::writeHeader(std::string& out, bool isSnapshot) {
+    out.assign("{\"jsonrpc\":\"2.0\",\"method\":\"subscription\",\"params\":{\"channel\":\"");
+    RequestEncoder::appendJsonEscaped(out, channelName);
+    out += "\",\"data\":{\"type\":\"";
+    out += isSnapshot ? "snapshot" : "change";
+    out += "\",\"timestamp\":";
+    RequestEncoder::appendNumber(out, static_cast<uint64_t>(nowMillis()));
+    out += ",\"instrument_name\":\"";
+    RequestEncoder::appendJsonEscaped(out, instrument);
+    out += "\",\"change_id\":";
+    RequestEncoder::appendNumber(out, static_cast<uint64_t>(changeId));
+    if (!isSnapshot) {
+        out += ",\"prev_change_id\":";
+        RequestEncoder::appendNumber(out, static_cast<uint64_t>(changeId - 1));
+    }
+}
+
+void SimBookFeed::snapshot(std::string& out) {
+    writeHeader(out, true);
+    out += ",\"bids\":";
+    appendSide(out, bids);
+    out += ",\"asks\":";
+    appendSide(out, asks);
+    out += "}}}";
+}
+
+void SimBookFeed::change(std::string& out) {
+    ++changeId;
+    writeHeader(out, false);
+
+    // Pick a level a geometric number of ticks behind the touch, on its own side
+    const bool bidSide = coin(rng) < 5;
+    const double best = bidSide ? bids.begin()->first : asks.begin()->first;
+    const double offset = levelFromTop(rng) * tick;
+    const double price = bidSide ? best - offset : best + offset;
+    const int roll = coin(rng);
+
+    const char* action = "change";
+    double amount = 0.0;
+    auto update = [&](auto& side) {
+        auto it = side.find(price);
+        if (it == side.end()) {
+            action = "new";
+            amount = side[price] = std::round(size(rng));
+        } else if (roll < 2 && side.size() > minLevels) {
+            action = "delete";
+            side.erase(it);
+        } else {
+            amount = it->second = std::round(size(rng));
+        }
+    };
+    if (bidSide) {
+        update(bids);
+    } else {
+        update(asks);
+    }
+
+    out += ",\"bids\":[";
+    if (bidSide) {
+        appendLevel(out, action, price, amount);
+    }
+    out += "],\"asks\":[";
+    if (!bidSide) {
+        appendLevel(out, action, price, amount);
+    }
+    out += "]}}}";
+}
@@ -0,0 +1,41 @@
+#ifndef SIM_BOOK_FEED_H
+#define SIM_BOOK_FEED_H
+
+#include <string>
+#include <map>
+#include <random>
+#include <functional>
+#include <cstdint>
+
+// Synthetic book.{instrument}.{interval} stream for one channel. Keeps a full ladder
+// around a mid price and mutates it near the top of the book like a live feed, so
+// change_id/prev_change_id chain correctly and the client's OrderBook stays consistent.
+class SimBookFeed {
+public:
+    SimBookFeed(std::string channel, std::string instrument, double mid, double tick, int depth, uint64_t seed);
+
+    const std::string& channel() const { return channelName; }
+
+    // Write the current book as a "snapshot" notification
+    void snapshot(std::string& out);
+
+    // Apply one random level update and write it as a "change" notification
+    void change(std::string& out);
+
+private:
+    void writeHeader(std::string& out, bool isSnapshot);
+
+    std::string channelName;
+    std::string instrument;
+    double tick;
+    size_t minLevels;
+    std::map<double, double, std::greater<double>> bids;
+    std::map<double, double> asks;
+    int64_t changeId = 1000;
+    std::mt19937_64 rng;
+    std::geometric_distribution<int> levelFromTop{0.25};
+    std::uniform_real_distribution<double> size{10.0, 50000.0};
+    std::uniform_int_distribution<int> coin{0, 9};
+};
+
+#endif // SIM_BOOK_FEED_H
@@ -0,0 +1,495 @@
+#include "SimExchange.h"
+#include "RequestEncoder.h"
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+int64_t nowMicros() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+void appendText(std::string& out, const char* key, std::string_view value) {
+    out += '"';
+    out += key;
+    out += "\":\"";
+    RequestEncoder::appendJsonEscaped(out, value);
+    out += "\",";
+}
+
+void appendNumber(std::string& out, const char* key, double value) {
+    out += '"';
+    out += key;
+    out += "\":";
+    RequestEncoder::appendNumber(out, value);
+    out += ',';
+}
+
+void appendInteger(std::string& out, const char* key, int64_t value) {
+    out += '"';
+    out += key;
+    out += "\":";
+    RequestEncoder::appendNumber(out, static_cast<uint64_t>(value));
+    out += ',';
+}
+
+void appendFlag(std::string& out, const char* key, bool value) {
+    out += '"';
+    out += key;
+    out += "\":";
+    out += value ? "true," : "false,";
+}
+
+// Replace the trailing comma of an object or array body with its closing bracket
+void close(std::string& out, char bracket) {
+    if (!out.empty() && out.back() == ',') {
+        out.back() = bracket;
+    } else {
+        out += bracket;
+    }
+}
+
+// Open and close the JSON-RPC envelope around a result or error written in between
+void beginResponse(std::string& out, int64_t id) {
+    out.assign("{\"jsonrpc\":\"2.0\",");
+    if (id >= 0) {
+        appendInteger(out, "id", id);
+    }
+}
+
+void endResponse(std::string& out, int64_t usIn) {
+    const int64_t usOut = nowMicros();
+    out += ',';
+    appendInteger(out, "usIn", usIn);
+    appendInteger(out, "usOut", usOut);
+    appendInteger(out, "usDiff", usOut - usIn);
+    appendFlag(out, "testnet", true);
+    close(out, '}');
+}
+
+bool isOpen(const char* state) {
+    return std::string_view(state) == "open" || std::string_view(state) == "untriggered";
+}
+
+} // namespace
+
+SimExchange::SimExchange(const Config& config) : config(config) {}
+
+uint64_t SimExchange::rateLimitedCount() const {
+    return limiter.stats(RateLimiter::Bucket::MatchingEngine).rejected
+        + limiter.stats(RateLimiter::Bucket::NonMatchingEngine).rejected;
+}
+
+bool SimExchange::authorized(const std::string& token) const {
+    if (token.empty()) {
+        return false;
+    }
+    if (!config.strictAuth) {
+        return true;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    return issuedTokens.count(token) != 0;
+}
+
+bool SimExchange::handle(std::string_view method, const SimParams& params, const std::string& token, int64_t id, std::string& out) {
+    requests.fetch_add(1, std::memory_order_relaxed);
+    const int64_t usIn = nowMicros();
+    beginResponse(out, id);
+
+    bool ok = false;
+    if (method.substr(0, 8) == "private/" && !authorized(token)) {
+        ok = error(13009, "unauthorized", out);
+    } else if (config.rateLimit && !limiter.acquire(method)) {
+        ok = error(10028, "too_many_requests", out);
+    } else if (method == "public/auth") {
+        ok = auth(params, out);
+    } else if (method == "private/buy" || method == "private/sell") {
+        ok = placeOrder(method == "private/buy", params, out);
+    } else if (method == "private/edit") {
+        ok = editOrder(params, out);
+    } else if (method == "private/cancel") {
+        ok = cancelOrder(params, out);
+    } else if (method == "private/cancel_all" || method == "private/cancel_all_by_instrument" ||
+               method == "private/cancel_by_label") {
+        ok = cancelAll(params, out);
+    } else if (method == "private/get_open_orders_by_instrument" || method == "private/get_open_orders") {
+        ok = getOpenOrders(params, out);
+    } else if (method == "private/get_order_state") {
+        ok = getOrderState(params, out);
+    } else if (method == "private/get_positions") {
+        ok = getPositions(params, out);
+    } else if (method == "private/get_position") {
+        ok = getPosition(params, out);
+    } else if (method == "public/get_order_book") {
+        ok = getOrderBook(params, out);
+    } else if (method == "public/test" || method == "public/get_time") {
+        out += "\"result\":";
+        RequestEncoder::appendNumber(out, static_cast<uint64_t>(usIn / 1000));
+        ok = true;
+    } else {
+        ok = error(-32601, "Method not found", out);
+    }
+
+    endResponse(out, usIn);
+    return ok;
+}
+
+bool SimExchange::error(int code, const char* message, std::string& out) {
+    out += "\"error\":{\"code\":";
+    if (code < 0) {
+        out += '-';
+    }
+    RequestEncoder::appendNumber(out, static_cast<uint64_t>(std::abs(code)));
+    out += ",\"message\":\"";
+    out += message;
+    out += "\"}";
+    return false;
+}
+
+bool SimExchange::auth(const SimParams& params, std::string& out) {
+    const std::string_view grant = params.text("grant_type");
+    if (grant == "client_credentials") {
+        if (params.text("client_id").empty() || params.text("client_secret").empty()) {
+            return error(-32602, "Invalid params", out);
+        }
+    } else if (grant == "refresh_token") {
+        if (params.text("refresh_token").empty()) {
+            return error(-32602, "Invalid params", out);
+        }
+    } else {
+        return error(-32602, "Invalid params", out);
+    }
+
+    std::string accessToken = "sim-access-";
+    std::string refreshToken = "sim-refresh-";
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        const uint64_t n = nextToken++;
+        RequestEncoder::appendNumber(accessToken, n);
+        RequestEncoder::appendNumber(refreshToken, n);
+        issuedTokens.insert(accessToken);
+    }
+
+    out += "\"result\":{";
+    appendText(out, "access_token", accessToken);
+    appendInteger(out, "expires_in", config.tokenLifetime);
+    appendText(out, "refresh_token", refreshToken);
+    appendText(out, "scope", "connection mainaccount trade:read_write");
+    appendText(out, "token_type", "bearer");
+    close(out, '}');
+    return true;
+}
+
+void SimExchange::fillIfMarketable(Order& order, int64_t now, std::string& trades) {
+    const double touch = order.buy ? config.mid + config.tick : config.mid - config.tick;
+    const bool marketable = order.type == "market" || order.type == "market_limit"
+        || (order.buy ? order.price >= touch : order.price <= touch);
+    if (!marketable || order.filled >= order.amount) {
+        return;
+    }
+
+    const double quantity = order.amount - order.filled;
+    order.averagePrice = (order.averagePrice * order.filled + touch * quantity) / order.amount;
+    order.filled = order.amount;
+    order.state = "filled";
+    order.updated = now;
+
+    // Positions are signed; average price follows the side that is being added to
+    Position& position = positions[order.instrument];
+    const double signedQuantity = order.buy ? quantity : -quantity;
+    if (position.size == 0.0 || (position.size > 0) == (signedQuantity > 0)) {
+        position.averagePrice = (position.averagePrice * std::fabs(position.size) + touch * quantity)
+            / (std::fabs(position.size) + quantity);
+    } else if (std::fabs(signedQuantity) > std::fabs(position.size)) {
+        position.averagePrice = touch;
+    }
+    position.size += signedQuantity;
+    if (position.size == 0.0) {
+        position.averagePrice = 0.0;
+    }
+
+    trades += '{';
+    std::string tradeId = "SIM-T-";
+    RequestEncoder::appendNumber(tradeId, nextTradeId++);
+    appendText(trades, "trade_id", tradeId);
+    appendInteger(trades, "timestamp", now / 1000);
+    appendText(trades, "state", order.state);
+    appendNumber(trades, "price", touch);
+    appendText(trades, "order_type", order.type);
+    appendText(trades, "order_id", order.id);
+    appendText(trades, "liquidity", "T");
+    appendText(trades, "label", order.label);
+    appendText(trades, "instrument_name", order.instrument);
+    appendText(trades, "direction", order.buy ? "buy" : "sell");
+    appendNumber(trades, "amount", quantity);
+    close(trades, '}');
+}
+
+void SimExchange::writeOrder(const Order& order, std::string& out) const {
+    out += '{';
+    appendText(out, "order_id", order.id);
+    appendText(out, "order_state", order.state);
+    appendText(out, "order_type", order.type);
+    appendText(out, "instrument_name", order.instrument);
+    appendText(out, "direction", order.buy ? "buy" : "sell");
+    appendText(out, "label", order.label);
+    appendNumber(out, "amount", order.amount);
+    appendNumber(out, "filled_amount", order.filled);
+    if (order.type == "market") {
+        out += "\"price\":\"market_price\",";
+    } else {
+        appendNumber(out, "price", order.price);
+    }
+    appendNumber(out, "average_price", order.averagePrice);
+    appendText(out, "time_in_force", "good_til_cancelled");
+    appendFlag(out, "api", true);
+    appendInteger(out, "creation_timestamp", order.created / 1000);
+    appendInteger(out, "last_update_timestamp", order.updated / 1000);
+    close(out, '}');
+}
+
+void SimExchange::writePosition(const std::string& instrument, const Position& position, std::string& out) const {
+    out += '{';
+    appendText(out, "instrument_name", instrument);
+    appendText(out, "kind", "future");
+    appendText(out, "direction", position.size > 0 ? "buy" : position.size < 0 ? "sell" : "zero");
+    appendNumber(out, "size", position.size);
+    appendNumber(out, "average_price", position.averagePrice);
+    appendNumber(out, "mark_price", config.mid);
+    appendNumber(out, "index_price", config.mid);
+    appendNumber(out, "floating_profit_loss", position.size * (config.mid - position.averagePrice) / config.mid);
+    close(out, '}');
+}
+
+bool SimExchange::placeOrder(bool buy, const SimParams& params, std::string& out) {
+    const std::string_view instrument = params.text("instrument_name");
+    const std::optional<double> amount = params.number("amount") ? params.number("amount") : params.number("contracts");
+    const std::string_view type = params.find("type") ? params.text("type") : std::string_view("limit");
+    const std::optional<double> price = params.number("price");
+    if (instrument.empty() || !amount || *amount <= 0.0) {
+        return error(-32602, "Invalid params", out);
+    }
+    if (type != "market" && type != "market_limit" && !price) {
+        return error(-32602, "Invalid params", out);
+    }
+
+    const int64_t now = nowMicros();
+    Order order;
+    order.instrument = std::string(instrument);
+    order.label = std::string(params.text("label"));
+    order.type = std::string(type);
+    order.buy = buy;
+    order.amount = *amount;
+    order.price = price.value_or(0.0);
+    order.created = order.updated = now;
+    if (type.substr(0, 5) == "stop_" || type.substr(0, 5) == "take_" || type == "trailing_stop") {
+        order.state = "untriggered";
+    }
+
+    std::string trades;
+    std::lock_guard<std::mutex> lock(mutex);
+    order.id = "SIM-";
+    RequestEncoder::appendNumber(order.id, nextOrderId++);
+    if (std::string_view(order.state) == "open") {
+        fillIfMarketable(order, now, trades);
+    }
+    if (std::string_view(order.state) == "open" && params.text("time_in_force") == "immediate_or_cancel") {
+        order.state = "cancelled";
+    }
+
+    out += "\"result\":{\"trades\":[";
+    out += trades;
+    out += "],\"order\":";
+    writeOrder(order, out);
+    out += '}';
+    if (isOpen(order.state)) {
+        orders.emplace(order.id, std::move(order));
+    }
+    return true;
+}
+
+bool SimExchange::editOrder(const SimParams& params, std::string& out) {
+    const std::string* orderId = params.find("order_id");
+    const std::optional<double> amount = params.number("amount") ? params.number("amount") : params.number("contracts");
+    if (!orderId) {
+        return error(-32602, "Invalid params", out);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = orders.find(*orderId);
+    if (it == orders.end()) {
+        return error(10004, "order_not_found", out);
+    }
+    Order& order = it->second;
+    if (amount) {
+        if (*amount <= order.filled) {
+            return error(-32602, "Invalid params", out);
+        }
+        order.amount = *amount;
+    }
+    if (const std::optional<double> price = params.number("price")) {
+        order.price = *price;
+    }
+    const int64_t now = nowMicros();
+    order.updated = now;
+
+    std::string trades;
+    if (std::string_view(order.state) == "open") {
+        fillIfMarketable(order, now, trades);
+    }
+    out += "\"result\":{\"trades\":[";
+    out += trades;
+    out += "],\"order\":";
+    writeOrder(order, out);
+    out += '}';
+    if (!isOpen(order.state)) {
+        orders.erase(it);
+    }
+    return true;
+}
+
+bool SimExchange::cancelOrder(const SimParams& params, std::string& out) {
+    const std::string* orderId = params.find("order_id");
+    if (!orderId) {
+        return error(-32602, "Invalid params", out);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = orders.find(*orderId);
+    if (it == orders.end()) {
+        return error(10004, "order_not_found", out);
+    }
+    it->second.state = "cancelled";
+    it->second.updated = nowMicros();
+    out += "\"result\":";
+    writeOrder(it->second, out);
+    orders.erase(it);
+    return true;
+}
+
+// cancel_all, cancel_all_by_instrument and cancel_by_label: each narrows by the parameter it takes
+bool SimExchange::cancelAll(const SimParams& params, std::string& out) {
+    const std::string_view instrument = params.text("instrument_name");
+    const std::string_view label = params.text("label");
+    uint64_t cancelled = 0;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto it = orders.begin(); it != orders.end();) {
+        if ((instrument.empty() || it->second.instrument == instrument) && (label.empty() || it->second.label == label)) {
+            it = orders.erase(it);
+            ++cancelled;
+        } else {
+            ++it;
+        }
+    }
+    out += "\"result\":";
+    RequestEncoder::appendNumber(out, cancelled);
+    return true;
+}
+
+bool SimExchange::getOpenOrders(const SimParams& params, std::string& out) {
+    const std::string_view instrument = params.text("instrument_name");
+
+    std::lock_guard<std::mutex> lock(mutex);
+    out += "\"result\":[";
+    for (const auto& entry : orders) {
+        if (instrument.empty() || entry.second.instrument == instrument) {
+            writeOrder(entry.second, out);
+            out += ',';
+        }
+    }
+    close(out, ']');
+    return true;
+}
+
+bool SimExchange::getOrderState(const SimParams& params, std::string& out) {
+    const std::string* orderId = params.find("order_id");
+    if (!orderId) {
+        return error(-32602, "Invalid params", out);
+    }
+
+    // Only open orders are kept, so filled and cancelled ones are reported as not found
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = orders.find(*orderId);
+    if (it == orders.end()) {
+        return error(10004, "order_not_found", out);
+    }
+    out += "\"result\":";
+    writeOrder(it->second, out);
+    return true;
+}
+
+bool SimExchange::getPositions(const SimParams& params, std::string& out) {
+    const std::string_view currency = params.text("currency");
+
+    std::lock_guard<std::mutex> lock(mutex);
+    out += "\"result\":[";
+    for (const auto& entry : positions) {
+        if (currency.empty() || currency == "any" || entry.first.compare(0, currency.size(), currency) == 0) {
+            writePosition(entry.first, entry.second, out);
+            out += ',';
+        }
+    }
+    close(out, ']');
+    return true;
+}
+
+bool SimExchange::getPosition(const SimParams& params, std::string& out) {
+    const std::string* instrument = params.find("instrument_name");
+    if (!instrument || instrument->empty()) {
+        return error(-32602, "Invalid params", out);
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = positions.find(*instrument);
+    out += "\"result\":";
+    writePosition(*instrument, it != positions.end() ? it->second : Position{}, out);
+    return true;
+}
+
+bool SimExchange::getOrderBook(const SimParams& params, std::string& out) {
+    const std::string_view instrument = params.text("instrument_name");
+    if (instrument.empty()) {
+        return error(-32602, "Invalid params", out);
+    }
+    int depth = config.bookDepth;
+    if (const std::optional<double> requested = params.number("depth")) {
+        depth = std::max(1, std::min(static_cast<int>(*requested), 10000));
+    }
+
+    // A static ladder around the mid; the streaming feed is what moves
+    const double bestBid = config.mid - config.tick;
+    const double bestAsk = config.mid + config.tick;
+    out += "\"result\":{";
+    appendInteger(out, "timestamp", nowMicros() / 1000);
+    appendText(out, "state", "open");
+    appendText(out, "instrument_name", instrument);
+    appendInteger(out, "change_id", 1);
+    appendNumber(out, "best_bid_price", bestBid);
+    appendNumber(out, "best_ask_price", bestAsk);
+    appendNumber(out, "mark_price", config.mid);
+    appendNumber(out, "index_price", config.mid);
+    appendNumber(out, "last_price", config.mid);
+    out += "\"bids\":[";
+    for (int i = 0; i < depth; ++i) {
+        out += '[';
+        RequestEncoder::appendNumber(out, bestBid - i * config.tick);
+        out += ',';
+        RequestEncoder::appendNumber(out, static_cast<uint64_t>(1000 * (i + 1)));
+        out += "],";
+    }
+    close(out, ']');
+    out += ",\"asks\":[";
+    for (int i = 0; i < depth; ++i) {
+        out += '[';
+        RequestEncoder::appendNumber(out, bestAsk + i * config.tick);
+        out += ',';
+        RequestEncoder::appendNumber(out, static_cast<uint64_t>(1000 * (i + 1)));
+        out += "],";
+    }
+    close(out, ']');
+    out += '}';
+    return true;
+}
@@ -0,0 +1,94 @@
+#ifndef SIM_EXCHANGE_H
+#define SIM_EXCHANGE_H
+
+#include "SimParams.h"
+#include "RateLimiter.h"
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// In-memory stand-in for the Deribit matching engine and account, shared by the HTTP and
+// WebSocket front ends. Every instrument is quoted one tick either side of a fixed mid price:
+// marketable orders fill in full at the touch, the rest rest as open orders.
+class SimExchange {
+public:
+    struct Config {
+        double mid = 30000.0;     // Mid price of every instrument
+        double tick = 0.5;        // Tick size; the touch is one tick from the mid
+        int bookDepth = 20;       // Levels per side returned by get_order_book
+        bool strictAuth = false;  // Only accept tokens issued by public/auth
+        int tokenLifetime = 900;  // expires_in of issued tokens, in seconds
+        bool rateLimit = false;   // Enforce the default credit limits, answering too_many_requests (10028)
+    };
+
+    explicit SimExchange(const Config& config);
+
+    // Handle one API call and write the complete JSON-RPC response into out.
+    // id < 0 leaves the id out (plain HTTP). token is the bearer or access_token presented
+    // with the call. Returns false if the response is an error.
+    bool handle(std::string_view method, const SimParams& params, const std::string& token, int64_t id, std::string& out);
+
+    // Whether token may call private methods
+    bool authorized(const std::string& token) const;
+
+    uint64_t requestCount() const { return requests.load(std::memory_order_relaxed); }
+
+    // Calls refused with too_many_requests
+    uint64_t rateLimitedCount() const;
+
+private:
+    struct Order {
+        std::string id;
+        std::string instrument;
+        std::string label;
+        std::string type;
+        bool buy = true;
+        double amount = 0.0;
+        double price = 0.0;
+        double filled = 0.0;
+        double averagePrice = 0.0;
+        const char* state = "open";
+        int64_t created = 0;
+        int64_t updated = 0;
+    };
+
+    struct Position {
+        double size = 0.0;
+        double averagePrice = 0.0;
+    };
+
+    bool auth(const SimParams& params, std::string& out);
+    bool placeOrder(bool buy, const SimParams& params, std::string& out);
+    bool editOrder(const SimParams& params, std::string& out);
+    bool cancelOrder(const SimParams& params, std::string& out);
+    bool cancelAll(const SimParams& params, std::string& out);
+    bool getOpenOrders(const SimParams& params, std::string& out);
+    bool getOrderState(const SimParams& params, std::string& out);
+    bool getPositions(const SimParams& params, std::string& out);
+    bool getPosition(const SimParams& params, std::string& out);
+    bool getOrderBook(const SimParams& params, std::string& out);
+
+    // Fill a marketable order in full at the touch, appending its trade to out
+    void fillIfMarketable(Order& order, int64_t now, std::string& trades);
+    void writeOrder(const Order& order, std::string& out) const;
+    void writePosition(const std::string& instrument, const Position& position, std::string& out) const;
+    static bool error(int code, const char* message, std::string& out);
+
+    Config config;
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, Order> orders;
+    std::unordered_map<std::string, Position> positions;
+    std::unordered_set<std::string> issuedTokens;
+    uint64_t nextOrderId = 1;
+    uint64_t nextTradeId = 1;
+    uint64_t nextToken = 1;
+    std::atomic<uint64_t> requests{0};
+    RateLimiter limiter{RateLimiter::Policy::Reject};
+};
+
+#endif // SIM_EXCHANGE_H
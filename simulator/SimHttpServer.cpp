@@ -0,0 +1,182 @@
+#include "SimHttpServer.h"
+#include "RequestEncoder.h"
+#include "rapidjson/document.h"
+#include <iostream>
+#include <memory>
+#include <string_view>
+#include <strings.h>
+
+using boost::asio::ip::tcp;
+
+namespace {
+
+// Case-insensitive header lookup in the raw header block
+std::string_view headerValue(std::string_view headers, std::string_view name) {
+    size_t pos = headers.find("\r\n");
+    while (pos != std::string_view::npos && pos + 2 < headers.size()) {
+        const size_t start = pos + 2;
+        const size_t end = headers.find("\r\n", start);
+        const std::string_view line = headers.substr(start, end - start);
+        if (line.size() > name.size() && line[name.size()] == ':'
+            && strncasecmp(line.data(), name.data(), name.size()) == 0) {
+            std::string_view value = line.substr(name.size() + 1);
+            while (!value.empty() && value.front() == ' ') {
+                value.remove_prefix(1);
+            }
+            return value;
+        }
+        pos = end;
+    }
+    return {};
+}
+
+} // namespace
+
+class SimHttpServer::Session : public std::enable_shared_from_this<SimHttpServer::Session> {
+public:
+    Session(tcp::socket socket, SimExchange& exchange) : socket(std::move(socket)), exchange(exchange) {
+        this->socket.set_option(tcp::no_delay(true));
+    }
+
+    void start() { readHeaders(); }
+
+private:
+    void readHeaders() {
+        auto self = shared_from_this();
+        boost::asio::async_read_until(socket, boost::asio::dynamic_buffer(input), "\r\n\r\n",
+            [this, self](const boost::system::error_code& ec, size_t headerSize) {
+                if (!ec) {
+                    onHeaders(headerSize);
+                }
+            });
+    }
+
+    void onHeaders(size_t headerSize) {
+        const std::string_view headers(input.data(), headerSize);
+        const std::string_view contentLength = headerValue(headers, "Content-Length");
+        const size_t bodySize = contentLength.empty() ? 0 : std::strtoul(std::string(contentLength).c_str(), nullptr, 10);
+        if (input.size() < headerSize + bodySize) {
+            // Wait for the whole body; it may carry the parameters
+            auto self = shared_from_this();
+            boost::asio::async_read(socket, boost::asio::dynamic_buffer(input),
+                boost::asio::transfer_exactly(headerSize + bodySize - input.size()),
+                [this, self, headerSize](const boost::system::error_code& ec, size_t) {
+                    if (!ec) {
+                        respond(headerSize);
+                    }
+                });
+            return;
+        }
+        respond(headerSize);
+    }
+
+    void respond(size_t headerSize) {
+        const std::string_view headers(input.data(), headerSize);
+        const std::string_view contentLength = headerValue(headers, "Content-Length");
+        const size_t bodySize = contentLength.empty() ? 0 : std::strtoul(std::string(contentLength).c_str(), nullptr, 10);
+
+        // Request line: METHOD SP target SP version
+        const size_t lineEnd = headers.find("\r\n");
+        const std::string_view requestLine = headers.substr(0, lineEnd);
+        const size_t targetStart = requestLine.find(' ');
+        const size_t targetEnd = requestLine.rfind(' ');
+        std::string_view target;
+        if (targetStart != std::string_view::npos && targetEnd > targetStart) {
+            target = requestLine.substr(targetStart + 1, targetEnd - targetStart - 1);
+        }
+
+        const size_t queryStart = target.find('?');
+        std::string_view path = target.substr(0, queryStart);
+        params.clear();
+        if (queryStart != std::string_view::npos) {
+            params.parseQuery(target.substr(queryStart + 1));
+        }
+
+        // POST bodies carry the parameters as a JSON object, either bare (as Connection sends
+        // them) or inside a JSON-RPC "params" member
+        if (bodySize > 0) {
+            rapidjson::Document json;
+            json.Parse(input.data() + headerSize, bodySize);
+            if (!json.HasParseError() && json.IsObject()) {
+                auto rpcParams = json.FindMember("params");
+                if (rpcParams != json.MemberEnd() && rpcParams->value.IsObject()) {
+                    params.setFromJson(rpcParams->value);
+                } else {
+                    params.setFromJson(json);
+                }
+            }
+        }
+
+        token.clear();
+        const std::string_view authorization = headerValue(headers, "Authorization");
+        if (authorization.size() > 7 && strncasecmp(authorization.data(), "Bearer ", 7) == 0) {
+            token.assign(authorization.substr(7));
+        }
+        const std::string_view connection = headerValue(headers, "Connection");
+        keepAlive = !(connection.size() == 5 && strncasecmp(connection.data(), "close", 5) == 0)
+            && !requestLine.empty() && requestLine.substr(targetEnd + 1) != "HTTP/1.0";
+
+        int status = 200;
+        if (path.substr(0, 8) == "/api/v2/") {
+            path.remove_prefix(8);
+            if (!exchange.handle(path, params, token, -1, body)) {
+                status = body.find("\"code\":13009") != std::string::npos ? 401
+                    : body.find("\"code\":10028") != std::string::npos ? 429 : 400;
+            }
+        } else {
+            status = 404;
+            body = "{\"jsonrpc\":\"2.0\",\"error\":{\"code\":-32601,\"message\":\"Method not found\"}}";
+        }
+
+        output.assign("HTTP/1.1 ");
+        output += status == 200 ? "200 OK" : status == 400 ? "400 Bad Request" : status == 401 ? "401 Unauthorized"
+            : status == 429 ? "429 Too Many Requests" : "404 Not Found";
+        output += "\r\nContent-Type: application/json\r\nContent-Length: ";
+        RequestEncoder::appendNumber(output, static_cast<uint64_t>(body.size()));
+        output += keepAlive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+        output += body;
+        input.erase(0, headerSize + bodySize);
+
+        auto self = shared_from_this();
+        boost::asio::async_write(socket, boost::asio::buffer(output),
+            [this, self](const boost::system::error_code& ec, size_t) {
+                if (ec) {
+                    return;
+                }
+                if (keepAlive) {
+                    readHeaders();
+                } else {
+                    boost::system::error_code ignored;
+                    socket.shutdown(tcp::socket::shutdown_both, ignored);
+                }
+            });
+    }
+
+    tcp::socket socket;
+    SimExchange& exchange;
+    // Reused across the requests of one connection
+    std::string input;
+    std::string output;
+    std::string body;
+    std::string token;
+    SimParams params;
+    bool keepAlive = true;
+};
+
+SimHttpServer::SimHttpServer(boost::asio::io_context& io, uint16_t port, SimExchange& exchange)
+    : acceptor(io, tcp::endpoint(tcp::v4(), port)), exchange(exchange) {
+    accept();
+}
+
+void SimHttpServer::accept() {
+    acceptor.async_accept([this](const boost::system::error_code& ec, tcp::socket socket) {
+        if (!ec) {
+            std::make_shared<Session>(std::move(socket), exchange)->start();
+        } else if (ec != boost::asio::error::operation_aborted) {
+            std::cerr << "HTTP accept failed: " << ec.message() << std::endl;
+        }
+        if (acceptor.is_open()) {
+            accept();
+        }
+    });
+}
@@ -0,0 +1,26 @@
+#ifndef SIM_HTTP_SERVER_H
+#define SIM_HTTP_SERVER_H
+
+#include "SimExchange.h"
+#include <boost/asio.hpp>
+#include <cstdint>
+
+// Plain HTTP/1.1 front end for SimExchange: GET or POST /api/v2/<method>?<query> with an
+// optional "Authorization: Bearer <token>" header, the same shape Connection sends.
+// Connections are kept alive and every response carries a JSON-RPC body.
+class SimHttpServer {
+public:
+    SimHttpServer(boost::asio::io_context& io, uint16_t port, SimExchange& exchange);
+
+    uint16_t port() const { return acceptor.local_endpoint().port(); }
+
+private:
+    class Session;
+
+    void accept();
+
+    boost::asio::ip::tcp::acceptor acceptor;
+    SimExchange& exchange;
+};
+
+#endif // SIM_HTTP_SERVER_H
@@ -0,0 +1,113 @@
+#ifndef SIM_PARAMS_H
+#define SIM_PARAMS_H
+
+#include <string>
+#include <string_view>
+#include <vector>
+#include <utility>
+#include <optional>
+#include <cstdlib>
+#include <cstdio>
+
+// Parameters of one API call, from a query string or a JSON-RPC params object, kept as text.
+// Calls carry a handful of parameters, so a linear scan beats hashing here.
+class SimParams {
+public:
+    void clear() { values.clear(); }
+
+    void set(std::string key, std::string value) { values.emplace_back(std::move(key), std::move(value)); }
+
+    const std::string* find(std::string_view key) const {
+        for (const auto& entry : values) {
+            if (entry.first == key) {
+                return &entry.second;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string_view text(std::string_view key) const {
+        const std::string* value = find(key);
+        return value ? std::string_view(*value) : std::string_view();
+    }
+
+    std::optional<double> number(std::string_view key) const {
+        const std::string* value = find(key);
+        if (!value || value->empty()) {
+            return std::nullopt;
+        }
+        char* end = nullptr;
+        const double parsed = std::strtod(value->c_str(), &end);
+        if (end != value->c_str() + value->size()) {
+            return std::nullopt;
+        }
+        return parsed;
+    }
+
+    bool flag(std::string_view key) const { return text(key) == "true"; }
+
+    // Parse "a=1&b=two" with percent-decoding, appending to the current values
+    void parseQuery(std::string_view query) {
+        while (!query.empty()) {
+            const size_t end = query.find('&');
+            const std::string_view pair = query.substr(0, end);
+            const size_t eq = pair.find('=');
+            if (eq != std::string_view::npos) {
+                set(decode(pair.substr(0, eq)), decode(pair.substr(eq + 1)));
+            } else if (!pair.empty()) {
+                set(decode(pair), std::string());
+            }
+            if (end == std::string_view::npos) {
+                break;
+            }
+            query.remove_prefix(end + 1);
+        }
+    }
+
+    // Copy the scalar members of a JSON object (a rapidjson::Value), formatting numbers and flags as text
+    template <typename Object>
+    void setFromJson(const Object& object) {
+        for (auto it = object.MemberBegin(); it != object.MemberEnd(); ++it) {
+            const auto& value = it->value;
+            if (value.IsString()) {
+                set(it->name.GetString(), std::string(value.GetString(), value.GetStringLength()));
+            } else if (value.IsBool()) {
+                set(it->name.GetString(), value.GetBool() ? "true" : "false");
+            } else if (value.IsInt64()) {
+                set(it->name.GetString(), std::to_string(value.GetInt64()));
+            } else if (value.IsNumber()) {
+                char number[32];
+                std::snprintf(number, sizeof(number), "%.17g", value.GetDouble());
+                set(it->name.GetString(), number);
+            }
+        }
+    }
+
+private:
+    static int hexValue(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    static std::string decode(std::string_view text) {
+        std::string out;
+        out.reserve(text.size());
+        for (size_t i = 0; i < text.size(); ++i) {
+            if (text[i] == '+') {
+                out += ' ';
+            } else if (text[i] == '%' && i + 2 < text.size() && hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0) {
+                out += static_cast<char>(hexValue(text[i + 1]) * 16 + hexValue(text[i + 2]));
+                i += 2;
+            } else {
+                out += text[i];
+            }
+        }
+        return out;
+    }
+
+    std::vector<std::pair<std::string, std::string>> values;
+};
+
+#endif // SIM_PARAMS_H
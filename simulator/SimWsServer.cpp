@@ -0,0 +1,363 @@
+#include "SimWsServer.h"
+#include "RequestEncoder.h"
+#include <openssl/ec.h>
+#include <openssl/ssl.h>
+#include <algorithm>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+
+namespace {
+
+// Instrument of a book.{instrument}.{...} channel, empty for any other channel
+std::string bookInstrument(const std::string& channel) {
+    if (channel.compare(0, 5, "book.") != 0) {
+        return {};
+    }
+    const size_t end = channel.find('.', 5);
+    return channel.substr(5, end == std::string::npos ? std::string::npos : end - 5);
+}
+
+void beginResult(std::string& out, int64_t id) {
+    out.assign("{\"jsonrpc\":\"2.0\",");
+    if (id >= 0) {
+        out += "\"id\":";
+        RequestEncoder::appendNumber(out, static_cast<uint64_t>(id));
+        out += ',';
+    }
+}
+
+void writeError(std::string& out, int64_t id, int code, const char* message) {
+    beginResult(out, id);
+    out += "\"error\":{\"code\":";
+    if (code < 0) {
+        out += '-';
+    }
+    RequestEncoder::appendNumber(out, static_cast<uint64_t>(std::abs(code)));
+    out += ",\"message\":\"";
+    out += message;
+    out += "\"},\"testnet\":true}";
+}
+
+} // namespace
+
+SimWsServer::SimWsServer(const Config& config, SimExchange& exchange) : config(config), exchange(exchange) {
+    server.clear_access_channels(websocketpp::log::alevel::all);
+    server.clear_error_channels(websocketpp::log::elevel::all);
+    server.init_asio();
+    server.set_reuse_addr(true);
+
+    using std::placeholders::_1;
+    using std::placeholders::_2;
+    server.set_tls_init_handler(std::bind(&SimWsServer::onTlsInit, this, _1));
+    server.set_open_handler(std::bind(&SimWsServer::onOpen, this, _1));
+    server.set_close_handler(std::bind(&SimWsServer::onClose, this, _1));
+    server.set_message_handler(std::bind(&SimWsServer::onMessage, this, _1, _2));
+}
+
+SimWsServer::~SimWsServer() {
+    stop();
+    X509_free(certificate);
+    EVP_PKEY_free(key);
+}
+
+bool SimWsServer::generateCertificate() {
+    EVP_PKEY_CTX* keyContext = EVP_PKEY_CTX_new_id(EVP_PKEY_EC, nullptr);
+    bool ok = keyContext && EVP_PKEY_keygen_init(keyContext) > 0
+        && EVP_PKEY_CTX_set_ec_paramgen_curve_nid(keyContext, NID_X9_62_prime256v1) > 0
+        && EVP_PKEY_keygen(keyContext, &key) > 0;
+    EVP_PKEY_CTX_free(keyContext);
+    if (!ok) {
+        return false;
+    }
+
+    certificate = X509_new();
+    X509_set_version(certificate, 2);
+    ASN1_INTEGER_set(X509_get_serialNumber(certificate), 1);
+    X509_gmtime_adj(X509_getm_notBefore(certificate), 0);
+    X509_gmtime_adj(X509_getm_notAfter(certificate), 365L * 24 * 3600);
+    X509_set_pubkey(certificate, key);
+    X509_NAME* name = X509_get_subject_name(certificate);
+    X509_NAME_add_entry_by_txt(name, "CN", MBSTRING_ASC, reinterpret_cast<const unsigned char*>("localhost"), -1, -1, 0);
+    X509_set_issuer_name(certificate, name);
+    return X509_sign(certificate, key, EVP_sha256()) > 0;
+}
+
+bool SimWsServer::start() {
+    if (config.certFile.empty() && !generateCertificate()) {
+        std::cerr << "Failed to generate a TLS certificate" << std::endl;
+        return false;
+    }
+
+    websocketpp::lib::error_code ec;
+    server.listen(config.port, ec);
+    if (!ec) {
+        server.start_accept(ec);
+    }
+    if (ec) {
+        std::cerr << "WebSocket listen failed: " << ec.message() << std::endl;
+        return false;
+    }
+
+    running = true;
+    onTimer();
+    thread = std::thread([this]() {
+        try {
+            server.run();
+        } catch (const std::exception& e) {
+            std::cerr << "Error in WebSocket server loop: " << e.what() << std::endl;
+        }
+    });
+    return true;
+}
+
+void SimWsServer::stop() {
+    if (!running.exchange(false)) {
+        return;
+    }
+    server.stop();
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+
+std::shared_ptr<boost::asio::ssl::context> SimWsServer::onTlsInit(Hdl) {
+    auto context = std::make_shared<boost::asio::ssl::context>(boost::asio::ssl::context::tls_server);
+    context->set_options(boost::asio::ssl::context::default_workarounds | boost::asio::ssl::context::no_sslv2
+        | boost::asio::ssl::context::no_sslv3 | boost::asio::ssl::context::single_dh_use);
+    if (!config.certFile.empty()) {
+        context->use_certificate_chain_file(config.certFile);
+        context->use_private_key_file(config.keyFile.empty() ? config.certFile : config.keyFile, boost::asio::ssl::context::pem);
+    } else {
+        SSL_CTX_use_certificate(context->native_handle(), certificate);
+        SSL_CTX_use_PrivateKey(context->native_handle(), key);
+    }
+    return context;
+}
+
+void SimWsServer::onOpen(Hdl hdl) {
+    sessions[hdl];
+}
+
+void SimWsServer::onClose(Hdl hdl) {
+    auto it = sessions.find(hdl);
+    if (it != sessions.end()) {
+        unsubscribeAll(hdl, it->second);
+        sessions.erase(it);
+    }
+}
+
+void SimWsServer::send(Hdl hdl, const std::string& message) {
+    websocketpp::lib::error_code ec;
+    server.send(hdl, message.data(), message.size(), websocketpp::frame::opcode::text, ec);
+    if (!ec) {
+        sent.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+void SimWsServer::onMessage(Hdl hdl, Server::message_ptr msg) {
+    auto sessionIt = sessions.find(hdl);
+    if (sessionIt == sessions.end()) {
+        return;
+    }
+    Session& session = sessionIt->second;
+
+    rapidjson::Document request;
+    request.Parse(msg->get_payload().c_str());
+    if (request.HasParseError() || !request.IsObject()) {
+        writeError(response, -1, -32700, "Parse error");
+        send(hdl, response);
+        return;
+    }
+
+    int64_t id = -1;
+    auto idMember = request.FindMember("id");
+    if (idMember != request.MemberEnd() && idMember->value.IsInt64()) {
+        id = idMember->value.GetInt64();
+    }
+    auto methodMember = request.FindMember("method");
+    if (methodMember == request.MemberEnd() || !methodMember->value.IsString()) {
+        writeError(response, id, -32600, "Invalid Request");
+        send(hdl, response);
+        return;
+    }
+    const std::string_view method(methodMember->value.GetString(), methodMember->value.GetStringLength());
+
+    static const rapidjson::Value emptyObject(rapidjson::kObjectType);
+    auto paramsMember = request.FindMember("params");
+    const rapidjson::Value& rpcParams = paramsMember != request.MemberEnd() && paramsMember->value.IsObject()
+        ? paramsMember->value : emptyObject;
+
+    // An access_token in params wins over the one the connection authenticated with
+    params.clear();
+    params.setFromJson(rpcParams);
+    const std::string* accessToken = params.find("access_token");
+    const std::string& token = accessToken ? *accessToken : session.token;
+
+    auto channels = rpcParams.FindMember("channels");
+    const bool hasChannels = channels != rpcParams.MemberEnd() && channels->value.IsArray();
+    if (method == "public/subscribe" || method == "private/subscribe") {
+        if (!hasChannels) {
+            writeError(response, id, -32602, "Invalid params");
+            send(hdl, response);
+        } else if (method == "private/subscribe" && !exchange.authorized(token)) {
+            writeError(response, id, 13009, "unauthorized");
+            send(hdl, response);
+        } else {
+            subscribe(hdl, session, channels->value, id);
+        }
+        return;
+    }
+    if (method == "public/unsubscribe" || method == "private/unsubscribe") {
+        if (!hasChannels) {
+            writeError(response, id, -32602, "Invalid params");
+            send(hdl, response);
+        } else {
+            unsubscribe(hdl, session, channels->value, id);
+        }
+        return;
+    }
+
+    const bool ok = exchange.handle(method, params, token, id, response);
+    if (ok && method == "public/auth") {
+        // Later calls on this connection may leave out access_token, as on the exchange
+        rapidjson::Document result;
+        result.Parse(response.c_str());
+        auto resultMember = result.FindMember("result");
+        if (resultMember != result.MemberEnd() && resultMember->value.IsObject()) {
+            auto issued = resultMember->value.FindMember("access_token");
+            if (issued != resultMember->value.MemberEnd() && issued->value.IsString()) {
+                session.token = issued->value.GetString();
+            }
+        }
+    }
+    send(hdl, response);
+}
+
+// Book channels are public, but private/subscribe accepts them too, as the exchange does
+void SimWsServer::subscribe(Hdl hdl, Session& session, const rapidjson::Value& channels, int64_t id) {
+    std::vector<Feed*> snapshots;
+    beginResult(response, id);
+    response += "\"result\":[";
+    for (const auto& value : channels.GetArray()) {
+        if (!value.IsString()) {
+            continue;
+        }
+        const std::string channel(value.GetString(), value.GetStringLength());
+        if (std::find(session.channels.begin(), session.channels.end(), channel) == session.channels.end()) {
+            session.channels.push_back(channel);
+            const std::string instrument = bookInstrument(channel);
+            if (!instrument.empty()) {
+                Feed& feed = feeds[channel];
+                if (!feed.book) {
+                    feed.book = std::make_unique<SimBookFeed>(channel, instrument, config.mid, config.tick,
+                        config.depth, std::hash<std::string>()(channel));
+                    feed.started = std::chrono::steady_clock::now();
+                }
+                feed.subscribers.push_back(hdl);
+                snapshots.push_back(&feed);
+            }
+        }
+        response += '"';
+        RequestEncoder::appendJsonEscaped(response, channel);
+        response += "\",";
+    }
+    if (response.back() == ',') {
+        response.back() = ']';
+    } else {
+        response += ']';
+    }
+    response += ",\"testnet\":true}";
+    send(hdl, response);
+
+    // The client rebuilds its book from the snapshot before applying changes
+    for (Feed* feed : snapshots) {
+        feed->book->snapshot(notification);
+        send(hdl, notification);
+    }
+}
+
+void SimWsServer::unsubscribe(Hdl hdl, Session& session, const rapidjson::Value& channels, int64_t id) {
+    beginResult(response, id);
+    response += "\"result\":[";
+    for (const auto& value : channels.GetArray()) {
+        if (!value.IsString()) {
+            continue;
+        }
+        const std::string channel(value.GetString(), value.GetStringLength());
+        auto it = std::find(session.channels.begin(), session.channels.end(), channel);
+        if (it == session.channels.end()) {
+            continue;
+        }
+        session.channels.erase(it);
+        auto feed = feeds.find(channel);
+        if (feed != feeds.end()) {
+            auto& subscribers = feed->second.subscribers;
+            subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+                [&hdl](const Hdl& other) { return !other.owner_before(hdl) && !hdl.owner_before(other); }),
+                subscribers.end());
+        }
+        response += '"';
+        RequestEncoder::appendJsonEscaped(response, channel);
+        response += "\",";
+    }
+    if (response.back() == ',') {
+        response.back() = ']';
+    } else {
+        response += ']';
+    }
+    response += ",\"testnet\":true}";
+    send(hdl, response);
+}
+
+void SimWsServer::unsubscribeAll(Hdl hdl, Session& session) {
+    for (const std::string& channel : session.channels) {
+        auto feed = feeds.find(channel);
+        if (feed == feeds.end()) {
+            continue;
+        }
+        auto& subscribers = feed->second.subscribers;
+        subscribers.erase(std::remove_if(subscribers.begin(), subscribers.end(),
+            [&hdl](const Hdl& other) { return !other.owner_before(hdl) && !hdl.owner_before(other); }),
+            subscribers.end());
+    }
+    session.channels.clear();
+}
+
+// Runs every millisecond: each channel publishes however many changes its rate says are due.
+// A channel that fell behind (e.g. the loop stalled) skips ahead instead of bursting.
+void SimWsServer::onTimer() {
+    if (!running) {
+        return;
+    }
+    const auto now = std::chrono::steady_clock::now();
+    const uint64_t maxBurst = std::max<uint64_t>(1, static_cast<uint64_t>(config.bookRate / 100));
+    for (auto& entry : feeds) {
+        Feed& feed = entry.second;
+        if (feed.subscribers.empty()) {
+            continue;
+        }
+        const double elapsed = std::chrono::duration<double>(now - feed.started).count();
+        const uint64_t due = static_cast<uint64_t>(elapsed * config.bookRate);
+        if (due > feed.published + maxBurst) {
+            feed.published = due - maxBurst;
+        }
+        for (; feed.published < due; ++feed.published) {
+            feed.book->change(notification);
+            for (const Hdl& hdl : feed.subscribers) {
+                websocketpp::lib::error_code ec;
+                Server::connection_ptr connection = server.get_con_from_hdl(hdl, ec);
+                if (ec || connection->get_buffered_amount() > MaxBuffered) {
+                    dropped.fetch_add(1, std::memory_order_relaxed);
+                    continue;
+                }
+                send(hdl, notification);
+            }
+        }
+    }
+    server.set_timer(1, [this](const websocketpp::lib::error_code& ec) {
+        if (!ec) {
+            onTimer();
+        }
+    });
+}
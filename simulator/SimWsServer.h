@@ -0,0 +1,95 @@
+#ifndef SIM_WS_SERVER_H
+#define SIM_WS_SERVER_H
+
+#include "SimExchange.h"
+#include "SimBookFeed.h"
+#include <websocketpp/server.hpp>
+#include <websocketpp/config/asio.hpp>
+#include "rapidjson/document.h"
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+#include <atomic>
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+// WebSocket (TLS) JSON-RPC front end for SimExchange, at the same /ws/api/v2 endpoint
+// WebSocketClient connects to. Besides the order API it answers public/private subscribe
+// and unsubscribe, and streams synthetic book.* notifications at a fixed rate per channel.
+// All connection and feed state is owned by the server's single event-loop thread.
+class SimWsServer {
+public:
+    using Server = websocketpp::server<websocketpp::config::asio_tls>;
+
+    struct Config {
+        uint16_t port = 8443;
+        double bookRate = 1000.0;  // Change notifications per second on each subscribed book.* channel
+        int depth = 500;           // Levels per side in book snapshots
+        double mid = 30000.0;
+        double tick = 0.5;
+        std::string certFile;      // PEM certificate and key; a self-signed pair is generated if empty
+        std::string keyFile;
+    };
+
+    SimWsServer(const Config& config, SimExchange& exchange);
+    ~SimWsServer();
+
+    // Listen and run the event loop on a background thread
+    bool start();
+    void stop();
+
+    uint64_t messagesSent() const { return sent.load(std::memory_order_relaxed); }
+    // Notifications skipped because a client had more than MaxBuffered bytes unsent
+    uint64_t messagesDropped() const { return dropped.load(std::memory_order_relaxed); }
+
+private:
+    using Hdl = websocketpp::connection_hdl;
+
+    struct Session {
+        std::string token;   // Set by public/auth on this connection
+        std::vector<std::string> channels;
+    };
+
+    struct Feed {
+        std::unique_ptr<SimBookFeed> book;
+        std::vector<Hdl> subscribers;
+        uint64_t published = 0;
+        std::chrono::steady_clock::time_point started;
+    };
+
+    static constexpr size_t MaxBuffered = 64 << 20;
+
+    std::shared_ptr<boost::asio::ssl::context> onTlsInit(Hdl hdl);
+    void onOpen(Hdl hdl);
+    void onClose(Hdl hdl);
+    void onMessage(Hdl hdl, Server::message_ptr msg);
+    void onTimer();
+
+    void subscribe(Hdl hdl, Session& session, const rapidjson::Value& channels, int64_t id);
+    void unsubscribe(Hdl hdl, Session& session, const rapidjson::Value& channels, int64_t id);
+    void unsubscribeAll(Hdl hdl, Session& session);
+    void send(Hdl hdl, const std::string& message);
+    bool generateCertificate();
+
+    Config config;
+    SimExchange& exchange;
+    Server server;
+    std::thread thread;
+    std::map<Hdl, Session, std::owner_less<Hdl>> sessions;
+    std::unordered_map<std::string, Feed> feeds;
+    EVP_PKEY* key = nullptr;
+    X509* certificate = nullptr;
+    // Reused by the event-loop thread
+    std::string response;
+    std::string notification;
+    SimParams params;
+    std::atomic<uint64_t> sent{0};
+    std::atomic<uint64_t> dropped{0};
+    std::atomic<bool> running{false};
+};
+
+#endif // SIM_WS_SERVER_H
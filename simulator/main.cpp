@@ -0,0 +1,117 @@
+// Loopback stand-in for test.deribit.com, so the client can be load-tested without the
+// exchange's WAN latency, and without its rate limits unless --rate-limit is given.
+// Usage: deribit_simulator [--http-port 8080] [--ws-port 8443] [--threads 1] [--book-rate 1000]
+//                          [--depth 500] [--mid 30000] [--tick 0.5] [--strict-auth] [--rate-limit]
+//                          [--cert file.pem] [--key file.pem]
+// Point Connection at http://127.0.0.1:<http-port> and WebSocketClient at 127.0.0.1:<ws-port>.
+#include "SimExchange.h"
+#include "SimHttpServer.h"
+#include "SimWsServer.h"
+#include <boost/asio.hpp>
+#include <chrono>
+#include <csignal>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <algorithm>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+int main(int argc, char* argv[]) {
+    uint16_t httpPort = 8080;
+    unsigned threads = 1;
+    SimExchange::Config exchangeConfig;
+    SimWsServer::Config wsConfig;
+
+    for (int i = 1; i < argc; ++i) {
+        const char* option = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!std::strcmp(option, "--strict-auth")) {
+            exchangeConfig.strictAuth = true;
+            continue;
+        }
+        if (!std::strcmp(option, "--rate-limit")) {
+            exchangeConfig.rateLimit = true;
+            continue;
+        }
+        if (!value) {
+            std::cerr << "Missing value for " << option << std::endl;
+            return 1;
+        }
+        ++i;
+        if (!std::strcmp(option, "--http-port")) {
+            httpPort = static_cast<uint16_t>(std::atoi(value));
+        } else if (!std::strcmp(option, "--ws-port")) {
+            wsConfig.port = static_cast<uint16_t>(std::atoi(value));
+        } else if (!std::strcmp(option, "--threads")) {
+            threads = std::max(1, std::atoi(value));
+        } else if (!std::strcmp(option, "--book-rate")) {
+            wsConfig.bookRate = std::atof(value);
+        } else if (!std::strcmp(option, "--depth")) {
+            wsConfig.depth = std::max(1, std::atoi(value));
+        } else if (!std::strcmp(option, "--mid")) {
+            exchangeConfig.mid = wsConfig.mid = std::atof(value);
+        } else if (!std::strcmp(option, "--tick")) {
+            exchangeConfig.tick = wsConfig.tick = std::atof(value);
+        } else if (!std::strcmp(option, "--cert")) {
+            wsConfig.certFile = value;
+        } else if (!std::strcmp(option, "--key")) {
+            wsConfig.keyFile = value;
+        } else {
+            std::cerr << "Unknown option " << option << std::endl;
+            return 1;
+        }
+    }
+
+    SimExchange exchange(exchangeConfig);
+
+    boost::asio::io_context io;
+    SimHttpServer http(io, httpPort, exchange);
+    SimWsServer ws(wsConfig, exchange);
+    if (!ws.start()) {
+        return 1;
+    }
+
+    boost::asio::signal_set signals(io, SIGINT, SIGTERM);
+    signals.async_wait([&](const boost::system::error_code&, int) { io.stop(); });
+
+    // Once a second: request and notification counts since the last report
+    boost::asio::steady_timer report(io);
+    uint64_t lastRequests = 0;
+    uint64_t lastSent = 0;
+    std::function<void()> scheduleReport = [&]() {
+        report.expires_after(std::chrono::seconds(1));
+        report.async_wait([&](const boost::system::error_code& ec) {
+            if (ec) {
+                return;
+            }
+            const uint64_t requests = exchange.requestCount();
+            const uint64_t sent = ws.messagesSent();
+            if (requests != lastRequests || sent != lastSent) {
+                std::cout << "requests/s: " << requests - lastRequests << ", ws messages/s: " << sent - lastSent
+                          << ", dropped: " << ws.messagesDropped() << ", rate limited: " << exchange.rateLimitedCount()
+                          << std::endl;
+            }
+            lastRequests = requests;
+            lastSent = sent;
+            scheduleReport();
+        });
+    };
+    scheduleReport();
+
+    std::cout << "Simulator listening: http://127.0.0.1:" << http.port() << ", wss://127.0.0.1:" << wsConfig.port
+              << "/ws/api/v2 (" << threads << " HTTP thread" << (threads > 1 ? "s" : "") << ", "
+              << wsConfig.bookRate << " book changes/s per channel)" << std::endl;
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 1; i < threads; ++i) {
+        workers.emplace_back([&io]() { io.run(); });
+    }
+    io.run();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    ws.stop();
+    return 0;
+}
@@ -0,0 +1,136 @@
+#include "AmendCoalescer.h"
+#include <iostream>
+#include <iterator>
+
+// Exchange errors meaning the order can no longer be edited
+static constexpr int OrderNotFound = 10004;
+static constexpr int NotOpenOrder = 11044;
+
+static bool orderGone(const OrderResult& result) {
+    if (result.ok()) {
+        return result.state == OrderResult::State::Filled || result.state == OrderResult::State::Cancelled ||
+               result.state == OrderResult::State::Rejected;
+    }
+    return result.errorCode == OrderNotFound || result.errorCode == NotOpenOrder;
+}
+
+static void notify(const std::vector<Trading::ResultCallback>& callers, const OrderResult& result) {
+    for (const Trading::ResultCallback& onResult : callers) {
+        if (!onResult) {
+            continue;
+        }
+        try {
+            onResult(result);
+        } catch (const std::exception& e) {
+            std::cerr << "Error in amend callback: " << e.what() << std::endl;
+        }
+    }
+}
+
+AmendCoalescer::AmendCoalescer(Send send, Post post) : send(std::move(send)), post(std::move(post)) {}
+
+AmendCoalescer::~AmendCoalescer() {
+    wait();
+}
+
+// Fields the newer edit sets replace the older ones. Amount and contracts size the order
+// together, so a newer size replaces both rather than leaving a mismatched pair.
+void AmendCoalescer::merge(EditRequest& into, const EditRequest& newer) {
+    if (newer.amount || newer.contracts) {
+        into.amount = newer.amount;
+        into.contracts = newer.contracts;
+    }
+    if (newer.price) {
+        into.price = newer.price;
+    }
+    if (newer.advanced) {
+        into.advanced = newer.advanced;
+    }
+    if (newer.postOnly) {
+        into.postOnly = newer.postOnly;
+    }
+    if (newer.reduceOnly) {
+        into.reduceOnly = newer.reduceOnly;
+    }
+}
+
+void AmendCoalescer::modify(const EditRequest& request, const std::string& token, Trading::ResultCallback onResult) {
+    submittedCount.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto inserted = orders.try_emplace(request.orderId);
+        Entry& entry = inserted.first->second;
+        if (!inserted.second) {
+            if (entry.waiting) {
+                merge(entry.waiting->request, request);
+                entry.waiting->token = token;
+                entry.waiting->callers.push_back(std::move(onResult));
+                absorbedCount.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                entry.waiting = Waiting{request, token, {}};
+                entry.waiting->callers.push_back(std::move(onResult));
+            }
+            return;
+        }
+        entry.inFlight.push_back(std::move(onResult));
+    }
+    dispatch(request, token);
+}
+
+void AmendCoalescer::dispatch(const EditRequest& request, const std::string& token) {
+    sentCount.fetch_add(1, std::memory_order_relaxed);
+    send(request, token, [this, orderId = request.orderId](const OrderResult& result) { finished(orderId, result); });
+}
+
+// The edit in flight completed: promote the waiting one, or retire the order's entry
+void AmendCoalescer::finished(const std::string& orderId, const OrderResult& result) {
+    std::vector<Trading::ResultCallback> callers;
+    std::optional<Waiting> next;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = orders.find(orderId);
+        if (it == orders.end()) {
+            return;
+        }
+        Entry& entry = it->second;
+        callers = std::move(entry.inFlight);
+        if (entry.waiting && !orderGone(result)) {
+            next = std::move(entry.waiting);
+            entry.waiting.reset();
+            entry.inFlight = std::move(next->callers);
+        } else {
+            if (entry.waiting) {
+                droppedCount.fetch_add(entry.waiting->callers.size(), std::memory_order_relaxed);
+                callers.insert(callers.end(), std::make_move_iterator(entry.waiting->callers.begin()),
+                               std::make_move_iterator(entry.waiting->callers.end()));
+            }
+            orders.erase(it);
+            // Under the lock, so a destructor woken by it cannot free the condition variable mid-call
+            if (orders.empty()) {
+                idle.notify_all();
+            }
+        }
+    }
+    // Send the waiting edit before running callbacks, so it is not held up by them. The entry
+    // stays in orders until its response, so wait() also covers an edit still being posted.
+    if (next) {
+        if (post) {
+            post([this, request = std::move(next->request), token = std::move(next->token)]() {
+                dispatch(request, token);
+            });
+        } else {
+            dispatch(next->request, next->token);
+        }
+    }
+    notify(callers, result);
+}
+
+void AmendCoalescer::wait() const {
+    std::unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this]() { return orders.empty(); });
+}
+
+size_t AmendCoalescer::active() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return orders.size();
+}
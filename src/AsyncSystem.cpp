@@ -0,0 +1,25 @@
+#include "AsyncSystem.h"
+
+AsyncSystem::Awaitable<OrderResult> AsyncSystem::placeOrder(const BuyRequest& request, const std::string& token) {
+    return await([this, &request, &token](Trading::ResultCallback onResult) {
+        system.placeOrderAsync(request, token, std::move(onResult));
+    });
+}
+
+AsyncSystem::Awaitable<OrderResult> AsyncSystem::sellOrder(const SellRequest& request, const std::string& token) {
+    return await([this, &request, &token](Trading::ResultCallback onResult) {
+        system.sellOrderAsync(request, token, std::move(onResult));
+    });
+}
+
+AsyncSystem::Awaitable<OrderResult> AsyncSystem::modifyOrder(const EditRequest& request, const std::string& token) {
+    return await([this, &request, &token](Trading::ResultCallback onResult) {
+        system.modifyOrderAsync(request, token, std::move(onResult));
+    });
+}
+
+AsyncSystem::Awaitable<OrderResult> AsyncSystem::cancelOrder(const CancelRequest& request, const std::string& token) {
+    return await([this, &request, &token](Trading::ResultCallback onResult) {
+        system.cancelOrderAsync(request, token, std::move(onResult));
+    });
+}
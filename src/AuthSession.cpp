@@ -0,0 +1,170 @@
+#include "AuthSession.h"
+#include "RequestEncoder.h"
+#include "WebSocketClient.h"
+#include <algorithm>
+#include <future>
+#include <iostream>
+
+AuthSession::AuthSession(Connection& conn, std::string clientId, std::string clientSecret, double refreshFraction)
+    : conn(conn), clientId(std::move(clientId)), clientSecret(std::move(clientSecret)),
+      refreshFraction(std::min(std::max(refreshFraction, 0.1), 0.9)) {}
+
+AuthSession::~AuthSession() {
+    stop();
+}
+
+bool AuthSession::start() {
+    if (!authenticate()) {
+        return false;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+    }
+    if (!refreshThread.joinable()) {
+        refreshThread = std::thread(&AuthSession::run, this);
+    }
+    return true;
+}
+
+void AuthSession::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    if (refreshThread.joinable()) {
+        refreshThread.join();
+    }
+}
+
+std::string AuthSession::token() const {
+    std::shared_ptr<const Credentials> credentials = std::atomic_load(&current);
+    return credentials ? credentials->accessToken : std::string();
+}
+
+void AuthSession::attachWebSocket(WebSocketClient* client) {
+    // Waits for a refresh in progress on the previous client, so it can be destroyed after this
+    std::lock_guard<std::mutex> lock(mutex);
+    webSocket = client;
+}
+
+void AuthSession::setRefreshHandler(RefreshHandler handler) {
+    std::lock_guard<std::mutex> lock(mutex);
+    refreshHandler = std::move(handler);
+}
+
+// client_credentials grant over REST
+bool AuthSession::authenticate() {
+    std::string target = "/api/v2/public/auth?grant_type=client_credentials&client_id=";
+    RequestEncoder::appendPercentEncoded(target, clientId);
+    target += "&client_secret=";
+    RequestEncoder::appendPercentEncoded(target, clientSecret);
+    return install(conn.sendEncoded(target));
+}
+
+bool AuthSession::refreshOverRest(const std::string& refreshToken) {
+    std::string target = "/api/v2/public/auth?grant_type=refresh_token&refresh_token=";
+    RequestEncoder::appendPercentEncoded(target, refreshToken);
+    return install(conn.sendEncoded(target));
+}
+
+// The WebSocket swaps its own access token when the response arrives
+bool AuthSession::refreshOverWebSocket(WebSocketClient& client, const std::string& refreshToken) {
+    auto promise = std::make_shared<std::promise<rapidjson::Document>>();
+    std::future<rapidjson::Document> response = promise->get_future();
+    if (client.refreshAuth(refreshToken, [promise](rapidjson::Document&& document) {
+            promise->set_value(std::move(document));
+        }) == 0) {
+        return false;
+    }
+    if (response.wait_for(std::chrono::seconds(5)) != std::future_status::ready) {
+        std::cerr << "WebSocket token refresh timed out" << std::endl;
+        return false;
+    }
+    return install(response.get());
+}
+
+// Take the tokens from a public/auth response and publish them
+bool AuthSession::install(const rapidjson::Value& response) {
+    if (!response.IsObject() || !response.HasMember("result") || !response["result"].IsObject()) {
+        if (response.IsObject() && response.HasMember("error")) {
+            std::cerr << "Authentication failed: " << (response["error"].HasMember("message") && response["error"]["message"].IsString()
+                                                          ? response["error"]["message"].GetString() : "unknown error") << std::endl;
+        }
+        return false;
+    }
+    const rapidjson::Value& result = response["result"];
+    if (!result.HasMember("access_token") || !result["access_token"].IsString()) {
+        std::cerr << "Authentication response has no access_token" << std::endl;
+        return false;
+    }
+
+    auto credentials = std::make_shared<Credentials>();
+    credentials->accessToken = result["access_token"].GetString();
+    if (result.HasMember("refresh_token") && result["refresh_token"].IsString()) {
+        credentials->refreshToken = result["refresh_token"].GetString();
+    }
+    const int64_t expiresIn = result.HasMember("expires_in") && result["expires_in"].IsInt64()
+        ? result["expires_in"].GetInt64() : 900;
+    credentials->lifetime = std::chrono::seconds(std::max<int64_t>(expiresIn, 1));
+    credentials->expiresAt = Clock::now() + credentials->lifetime;
+
+    // Header first, so a caller that sees the new token also finds its pre-built header
+    conn.setAuthHeaders(std::make_shared<const Connection::AuthHeaders>(credentials->accessToken));
+    std::atomic_store(&current, std::shared_ptr<const Credentials>(std::move(credentials)));
+    return true;
+}
+
+// Sleep until refreshFraction of the lifetime has passed, then refresh. Failed attempts are
+// retried with backoff (capped so there are several tries before expiry), falling back to
+// client credentials when the refresh token is rejected.
+void AuthSession::run() {
+    std::chrono::seconds backoff(1);
+    std::shared_ptr<const Credentials> credentials = std::atomic_load(&current);
+    Clock::time_point nextRefresh = credentials->expiresAt
+        - std::chrono::duration_cast<Clock::duration>(credentials->lifetime * (1.0 - refreshFraction));
+
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (wakeUp.wait_until(lock, nextRefresh, [this]() { return stopping; })) {
+            break;
+        }
+
+        credentials = std::atomic_load(&current);
+        bool refreshed = false;
+        if (webSocket && webSocket->isConnected() && !credentials->refreshToken.empty()) {
+            refreshed = refreshOverWebSocket(*webSocket, credentials->refreshToken);
+        }
+        WebSocketClient* client = webSocket;
+        lock.unlock();
+        if (!refreshed && !credentials->refreshToken.empty()) {
+            refreshed = refreshOverRest(credentials->refreshToken);
+        }
+        if (!refreshed) {
+            refreshed = authenticate();
+        }
+        lock.lock();
+
+        if (refreshed) {
+            backoff = std::chrono::seconds(1);
+            refreshes.fetch_add(1, std::memory_order_relaxed);
+            credentials = std::atomic_load(&current);
+            // A REST refresh cannot re-auth the socket, but its requests can carry the new token
+            if (client && client == webSocket) {
+                client->setAccessToken(credentials->accessToken);
+            }
+            if (refreshHandler) {
+                refreshHandler(*credentials);
+            }
+            nextRefresh = credentials->expiresAt
+                - std::chrono::duration_cast<Clock::duration>(credentials->lifetime * (1.0 - refreshFraction));
+        } else {
+            failedRefreshes.fetch_add(1, std::memory_order_relaxed);
+            const auto remaining = std::chrono::duration_cast<std::chrono::seconds>(credentials->expiresAt - Clock::now());
+            nextRefresh = Clock::now() + std::max(std::chrono::seconds(1), std::min(backoff, remaining / 4));
+            backoff = std::min(backoff * 2, std::chrono::seconds(30));
+            std::cerr << "Token refresh failed, retrying" << std::endl;
+        }
+    }
+}
@@ -0,0 +1,120 @@
+#include "ChannelRegistry.h"
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
+
+ChannelIndex::ChannelIndex(std::vector<std::string> channelNames) : names(std::move(channelNames)) {
+    choosePositions();
+
+    // At most half full, so probe runs stay short
+    size_t capacity = 2;
+    while (capacity < names.size() * 2) {
+        capacity *= 2;
+    }
+    slots.resize(capacity);
+    mask = capacity - 1;
+    shift = 64;
+    for (size_t bits = capacity; bits > 1; bits /= 2) {
+        --shift;
+    }
+
+    for (size_t i = 0; i < names.size(); ++i) {
+        Slot entry;
+        entry.key = keyOf(names[i]);
+        entry.offset = static_cast<uint32_t>(text.size());
+        entry.length = static_cast<uint32_t>(names[i].size());
+        entry.id = static_cast<ChannelId>(i);
+        text += names[i];
+        size_t slot = slotOf(entry.key);
+        while (slots[slot].id != NoChannelId) {
+            slot = (slot + 1) & mask;
+        }
+        slots[slot] = entry;
+    }
+}
+
+// Greedily add the byte position that splits the names into the most distinct keys, until
+// every name has its own key or the key is full. Names left sharing a key are told apart by
+// the memcmp in find().
+void ChannelIndex::choosePositions() {
+    size_t longest = 0;
+    for (const std::string& channel : names) {
+        longest = std::max(longest, channel.size());
+    }
+
+    std::vector<uint64_t> keys(names.size());
+    auto distinctKeys = [this, &keys]() {
+        for (size_t i = 0; i < names.size(); ++i) {
+            keys[i] = keyOf(names[i]);
+        }
+        std::sort(keys.begin(), keys.end());
+        return static_cast<size_t>(std::unique(keys.begin(), keys.end()) - keys.begin());
+    };
+
+    size_t distinct = distinctKeys();
+    while (distinct < names.size() && positionCount < MaxPositions) {
+        size_t bestDistinct = distinct;
+        uint32_t bestPosition = 0;
+        ++positionCount;
+        for (uint32_t position = 0; position < longest; ++position) {
+            positions[positionCount - 1] = position;
+            const size_t candidate = distinctKeys();
+            if (candidate > bestDistinct) {
+                bestDistinct = candidate;
+                bestPosition = position;
+            }
+        }
+        if (bestDistinct == distinct) {
+            --positionCount; // No single byte splits the rest any further
+            break;
+        }
+        positions[positionCount - 1] = bestPosition;
+        distinct = bestDistinct;
+    }
+}
+
+ChannelRegistry::ChannelRegistry() : current(std::make_shared<const ChannelIndex>(std::vector<std::string>())) {}
+
+ChannelId ChannelRegistry::intern(std::string_view channel) {
+    const ChannelId id = find(channel);
+    return id != NoChannelId ? id : intern(std::vector<std::string>{std::string(channel)}).front();
+}
+
+std::vector<ChannelId> ChannelRegistry::intern(const std::vector<std::string>& channels) {
+    std::vector<ChannelId> ids(channels.size(), NoChannelId);
+    std::lock_guard<std::mutex> lock(mutex);
+    std::shared_ptr<const ChannelIndex> index = std::atomic_load(&current);
+    std::vector<std::string> names;
+    std::unordered_map<std::string_view, ChannelId> added; // Views into channels, for repeats within it
+    for (size_t i = 0; i < channels.size(); ++i) {
+        ids[i] = index->find(channels[i]);
+        if (ids[i] != NoChannelId) {
+            continue;
+        }
+        auto inserted = added.emplace(channels[i], static_cast<ChannelId>(index->size() + names.size()));
+        ids[i] = inserted.first->second;
+        if (inserted.second) {
+            names.push_back(channels[i]);
+        }
+    }
+    if (names.empty()) {
+        return ids;
+    }
+    std::vector<std::string> all;
+    all.reserve(index->size() + names.size());
+    for (size_t i = 0; i < index->size(); ++i) {
+        all.push_back(index->name(static_cast<ChannelId>(i)));
+    }
+    all.insert(all.end(), std::make_move_iterator(names.begin()), std::make_move_iterator(names.end()));
+    std::atomic_store(&current, std::shared_ptr<const ChannelIndex>(std::make_shared<const ChannelIndex>(std::move(all))));
+    return ids;
+}
+
+std::string ChannelRegistry::name(ChannelId id) const {
+    std::shared_ptr<const ChannelIndex> index = this->index();
+    return id < index->size() ? index->name(id) : std::string();
+}
+
+std::shared_ptr<const ChannelIndex> ChannelRegistry::index() const {
+    return std::atomic_load(&current);
+}
@@ -4,9 +4,41 @@
 #include "rapidjson/document.h"
 #include "rapidjson/error/en.h"
 #include <mutex>
+#include <algorithm>
 
-// Constructor to store the base URL
-Connection::Connection(const std::string& baseUrl) : baseUrl(baseUrl) {} 
+// curl_global_init is not thread-safe, so run it once for the whole process
+static std::once_flag curlGlobalInitFlag;
+
+// Constructor stores the base URL and sets up the shared DNS/TLS/connection cache
+Connection::Connection(const std::string& baseUrl, Mode mode) : baseUrl(baseUrl), mode(mode), share(nullptr) {
+    std::call_once(curlGlobalInitFlag, []() { curl_global_init(CURL_GLOBAL_DEFAULT); });
+
+    share = curl_share_init();
+    if (share) {
+        curl_share_setopt(share, CURLSHOPT_LOCKFUNC, lockShare);
+        curl_share_setopt(share, CURLSHOPT_UNLOCKFUNC, unlockShare);
+        curl_share_setopt(share, CURLSHOPT_USERDATA, this);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_SSL_SESSION);
+        curl_share_setopt(share, CURLSHOPT_SHARE, CURL_LOCK_DATA_CONNECT);
+    } else {
+        std::cerr << "curl_share_init() failed, pooled handles will not share caches" << std::endl;
+    }
+}
+
+// Destructor releases every pooled handle before the share object they point to
+Connection::~Connection() {
+    for (PooledHandle* handle : allHandles) {
+        curl_easy_cleanup(handle->curl);
+        if (handle->headers) {
+            curl_slist_free_all(handle->headers);
+        }
+        delete handle;
+    }
+    if (share) {
+        curl_share_cleanup(share);
+    }
+}
 
 // Callback function for writing received data to a string
 size_t Connection::WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
@@ -19,6 +51,159 @@ size_t Connection::WriteCallback(void* contents, size_t size, size_t nmemb, void
     return totalSize; // Return the number of bytes processed
 }
 
+// Lock callbacks for the curl share object (one mutex per shared data kind)
+void Connection::lockShare(CURL*, curl_lock_data data, curl_lock_access, void* userp) {
+    static_cast<Connection*>(userp)->shareLocks[data].lock();
+}
+
+void Connection::unlockShare(CURL*, curl_lock_data data, void* userp) {
+    static_cast<Connection*>(userp)->shareLocks[data].unlock();
+}
+
+// Build the header list sent with every request
+struct curl_slist* Connection::buildHeaders(const std::string& token) {
+    struct curl_slist* headers = nullptr; 
+    if (!token.empty()) {
+        std::string auth_header = "Authorization: Bearer " + token;
+        headers = curl_slist_append(headers, auth_header.c_str());
+    }
+    headers = curl_slist_append(headers, "Content-Type: application/json");
+    return headers;
+}
+
+// Append params to a GET URL as a query string
+void Connection::appendQuery(std::string& url, const std::unordered_map<std::string, std::string>& params) {
+    if (params.empty()) {
+        return;
+    }
+    url += "?"; 
+    for (const auto& param : params) {
+        url += param.first + "=" + param.second + "&";
+    }
+    url.pop_back(); 
+}
+
+// Parse a JSON response body, returning an empty document on error
+rapidjson::Document Connection::parseResponse(const std::string& response) {
+    rapidjson::Document doc; 
+    rapidjson::ParseResult ok = doc.Parse(response.c_str());
+    if (!ok) {
+        std::cerr << "JSON Parse error: " << rapidjson::GetParseError_En(ok.Code()) 
+                  << " (" << ok.Offset() << ")" << std::endl;
+        std::cerr << "Response String: " << response << std::endl; 
+        return rapidjson::Document(); // Return empty document on error
+    }
+    return doc;
+}
+
+// Check out an idle handle, or create a new one bound to the shared cache
+Connection::PooledHandle* Connection::acquireHandle() {
+    {
+        std::lock_guard<std::mutex> lock(poolMutex);
+        if (!idleHandles.empty()) {
+            PooledHandle* handle = idleHandles.back();
+            idleHandles.pop_back();
+            handlesReused.fetch_add(1, std::memory_order_relaxed);
+            return handle;
+        }
+    }
+
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        return nullptr;
+    }
+    if (share) {
+        curl_easy_setopt(curl, CURLOPT_SHARE, share);
+    }
+    // Keep the connection open and probe it while idle
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+
+    PooledHandle* handle = new PooledHandle();
+    handle->curl = curl;
+    handlesCreated.fetch_add(1, std::memory_order_relaxed);
+
+    std::lock_guard<std::mutex> lock(poolMutex);
+    allHandles.push_back(handle);
+    return handle;
+}
+
+// Return a handle to the pool so the next request can reuse its connection
+void Connection::releaseHandle(PooledHandle* handle) {
+    std::lock_guard<std::mutex> lock(poolMutex);
+    idleHandles.push_back(handle);
+}
+
+// Header list for a pooled handle, rebuilt only when the token changes
+struct curl_slist* Connection::headersFor(PooledHandle* handle, const std::string& token) {
+    if (!handle->hasHeaders || handle->headerToken != token) {
+        if (handle->headers) {
+            curl_slist_free_all(handle->headers);
+        }
+        handle->headers = buildHeaders(token);
+        handle->headerToken = token;
+        handle->hasHeaders = true;
+    }
+    return handle->headers;
+}
+
+// Count whether the last transfer on this handle needed a new connection
+void Connection::recordConnection(CURL* curl) {
+    long connects = 0;
+    if (curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects) == CURLE_OK && connects == 0) {
+        reusedConnections.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        newConnections.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+// Split a finished transfer into stages. curl reports each *_TIME_T as microseconds from the
+// start of curl_easy_perform to the end of that phase, so each stage is a difference.
+void Connection::recordTimings(CURL* curl, const std::string& url, Clock::time_point started, Clock::time_point handedOff) {
+    curl_off_t nameLookup = 0, connect = 0, appConnect = 0, preTransfer = 0, startTransfer = 0, total = 0;
+    long connects = 0;
+    curl_easy_getinfo(curl, CURLINFO_NAMELOOKUP_TIME_T, &nameLookup);
+    curl_easy_getinfo(curl, CURLINFO_CONNECT_TIME_T, &connect);
+    curl_easy_getinfo(curl, CURLINFO_APPCONNECT_TIME_T, &appConnect);
+    curl_easy_getinfo(curl, CURLINFO_PRETRANSFER_TIME_T, &preTransfer);
+    curl_easy_getinfo(curl, CURLINFO_STARTTRANSFER_TIME_T, &startTransfer);
+    curl_easy_getinfo(curl, CURLINFO_TOTAL_TIME_T, &total);
+    curl_easy_getinfo(curl, CURLINFO_NUM_CONNECTS, &connects);
+
+    auto elapsedNs = [](curl_off_t from, curl_off_t to) -> uint64_t { return to > from ? static_cast<uint64_t>(to - from) * 1000 : 0; };
+
+    RequestTimings::Sample sample;
+    sample.newConnection = connects > 0;
+    sample.tls = appConnect > 0;
+    sample.ns[RequestTimings::Build] = std::chrono::duration_cast<std::chrono::nanoseconds>(handedOff - started).count();
+    sample.ns[RequestTimings::Dns] = elapsedNs(0, nameLookup);
+    sample.ns[RequestTimings::Connect] = elapsedNs(nameLookup, connect);
+    sample.ns[RequestTimings::Tls] = elapsedNs(connect, appConnect);
+    sample.ns[RequestTimings::FirstByte] = elapsedNs(std::max(preTransfer, std::max(connect, appConnect)), startTransfer);
+    sample.ns[RequestTimings::Transfer] = elapsedNs(startTransfer, total);
+    sample.ns[RequestTimings::Total] = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - started).count();
+    requestTimings.record(RequestTimings::endpointOf(url), sample);
+}
+
+Connection::PoolStats Connection::getPoolStats() const {
+    PoolStats stats;
+    stats.requests = requestCount.load(std::memory_order_relaxed);
+    stats.handlesCreated = handlesCreated.load(std::memory_order_relaxed);
+    stats.handlesReused = handlesReused.load(std::memory_order_relaxed);
+    stats.newConnections = newConnections.load(std::memory_order_relaxed);
+    stats.reusedConnections = reusedConnections.load(std::memory_order_relaxed);
+    return stats;
+}
+
+void Connection::resetPoolStats() {
+    requestCount = 0;
+    handlesCreated = 0;
+    handlesReused = 0;
+    newConnections = 0;
+    reusedConnections = 0;
+}
+
 // Send a request to the server and parse the JSON response
 rapidjson::Document Connection::sendRequest(
     const std::string& endpoint, 
@@ -26,19 +211,11 @@ rapidjson::Document Connection::sendRequest(
     const std::string& method, 
     const std::string& token) {
 
-    CURL* curl; // Handle for libcurl
-    CURLcode res; // Result code from libcurl operations
+    const Clock::time_point started = Clock::now();
 
     // Construct the full URL
     std::string url = baseUrl + endpoint; 
 
-    // Initialize curl
-    curl = curl_easy_init(); 
-    if (!curl) {
-        std::cerr << "curl_easy_init() failed!" << std::endl;
-        return rapidjson::Document(); // Return empty document on error
-    }
-
     // Create JSON data for POST requests
     std::string data = "{"; 
     for (const auto& param : params) {
@@ -49,69 +226,151 @@ rapidjson::Document Connection::sendRequest(
     }
     data += "}";
 
+    if (method == "GET") {
+        appendQuery(url, params);
+    }
+    return perform(url, method, data, token, started);
+}
+
+// Send a GET for a target already encoded by RequestEncoder (path plus query string)
+rapidjson::Document Connection::sendEncoded(const std::string& target, const std::string& token) {
+    const Clock::time_point started = Clock::now();
+    // Reused per thread so building the URL does not allocate once it has grown
+    static thread_local std::string url;
+    url.assign(baseUrl);
+    url.append(target);
+    return perform(url, "GET", std::string(), token, started);
+}
+
+// Same GET, leaving the raw body in response for a typed decoder; false if the transfer failed
+bool Connection::sendEncoded(const std::string& target, const std::string& token, std::string& response) {
+    const Clock::time_point started = Clock::now();
+    static thread_local std::string url;
+    url.assign(baseUrl);
+    url.append(target);
+    return transfer(url, "GET", std::string(), token, response, started);
+}
+
+// Run one transfer and parse the JSON response
+rapidjson::Document Connection::perform(
+    const std::string& url, 
+    const std::string& method, 
+    const std::string& data, 
+    const std::string& token,
+    Clock::time_point started) {
+
     // String to store the response from the server
     std::string response_string; 
+    if (!transfer(url, method, data, token, response_string, started)) {
+        return rapidjson::Document(); // Return empty document on error
+    }
+
+    // Parse the JSON response
+    const Clock::time_point received = Clock::now();
+    rapidjson::Document document = parseResponse(response_string);
+    requestTimings.recordParse(RequestTimings::endpointOf(url),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - received).count());
+    return document;
+}
+
+// Run one transfer on a pooled or fresh handle, collecting the body into response
+bool Connection::transfer(
+    const std::string& url, 
+    const std::string& method, 
+    const std::string& data, 
+    const std::string& token, 
+    std::string& response,
+    Clock::time_point started) {
+
+    CURL* curl; // Handle for libcurl
+    CURLcode res; // Result code from libcurl operations
+    struct curl_slist* headers = nullptr; // Request headers
+    const bool pooled = mode.load(std::memory_order_relaxed) == Mode::Pooled;
+    PooledHandle* handle = nullptr;
+
+    // Take credits before a handle is checked out, so a queued request does not hold one.
+    // Time spent queued is left out of the Build stage; the limiter counts it separately.
+    if (RateLimiter* limiter = rateLimiter.load(std::memory_order_relaxed)) {
+        const Clock::time_point queued = Clock::now();
+        if (!limiter->acquire(url)) {
+            response.assign(RateLimiter::rejectedResponse);
+            return true;
+        }
+        started += Clock::now() - queued;
+    }
+
+    // Check out a pooled handle or initialize a fresh one
+    if (pooled) {
+        handle = acquireHandle();
+        curl = handle ? handle->curl : nullptr;
+    } else {
+        curl = curl_easy_init();
+    }
+    if (!curl) {
+        std::cerr << "curl_easy_init() failed!" << std::endl;
+        return false;
+    }
+    response.clear();
 
     // Set the URL for the request
     curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
 
     // Set request method (POST, GET, etc.)
+    // A pooled handle keeps the options of its previous request, so reset the method each time
+    curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, nullptr);
     if (method == "POST") {
         curl_easy_setopt(curl, CURLOPT_POST, 1L); 
         curl_easy_setopt(curl, CURLOPT_POSTFIELDS, data.c_str());
         curl_easy_setopt(curl, CURLOPT_POSTFIELDSIZE, data.length()); 
     } else if (method == "GET") {
         curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L); 
-        if (!params.empty()) {
-            url += "?"; 
-            for (const auto& param : params) {
-                url += param.first + "=" + param.second + "&";
-            }
-            url.pop_back(); 
-            curl_easy_setopt(curl, CURLOPT_URL, url.c_str()); 
-        }
     } else {
+        curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
         curl_easy_setopt(curl, CURLOPT_CUSTOMREQUEST, method.c_str()); 
     }
 
     // Set callback function for writing received data
     curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback); 
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response_string); 
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response); 
 
-    // Set HTTP headers (if any)
-    struct curl_slist* headers = nullptr; 
+    // Set HTTP headers: the session's shared list when the token matches it, otherwise
+    // pooled handles keep a pre-built list per token. The shared list stays alive until
+    // this transfer is done even if a refresh swaps it out meanwhile.
+    std::shared_ptr<const AuthHeaders> sharedHeaders;
     if (!token.empty()) {
-        std::string auth_header = "Authorization: Bearer " + token;
-        headers = curl_slist_append(headers, auth_header.c_str());
+        sharedHeaders = std::atomic_load(&authHeaders);
+        if (sharedHeaders && sharedHeaders->token != token) {
+            sharedHeaders.reset();
+        }
     }
-    headers = curl_slist_append(headers, "Content-Type: application/json");
+    headers = sharedHeaders ? sharedHeaders->list : pooled ? headersFor(handle, token) : buildHeaders(token);
     curl_easy_setopt(curl, CURLOPT_HTTPHEADER, headers);
 
     // Perform the request
+    const Clock::time_point handedOff = Clock::now();
     res = curl_easy_perform(curl); 
-
-    if (res != CURLE_OK) {
-        std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
-        curl_slist_free_all(headers); 
-        curl_easy_cleanup(curl); 
-        return rapidjson::Document(); // Return empty document on error
+    requestCount.fetch_add(1, std::memory_order_relaxed);
+    if (res == CURLE_OK) {
+        recordConnection(curl);
+        recordTimings(curl, url, started, handedOff);
+    } else {
+        requestTimings.recordError(RequestTimings::endpointOf(url));
     }
 
-    // Parse the JSON response
-    rapidjson::Document doc; 
-    rapidjson::ParseResult ok = doc.Parse(response_string.c_str());
-    if (!ok) {
-        std::cerr << "JSON Parse error: " << rapidjson::GetParseError_En(ok.Code()) 
-                  << " (" << ok.Offset() << ")" << std::endl;
-        std::cerr << "Response String: " << response_string << std::endl; 
-        curl_slist_free_all(headers); 
+    // Clean up, or hand the handle back with its connection still open
+    if (pooled) {
+        releaseHandle(handle);
+    } else {
+        handlesCreated.fetch_add(1, std::memory_order_relaxed);
+        if (!sharedHeaders) {
+            curl_slist_free_all(headers);
+        }
         curl_easy_cleanup(curl); 
-        return rapidjson::Document(); // Return empty document on error
     }
 
-    // Clean up
-    curl_slist_free_all(headers); 
-    curl_easy_cleanup(curl); 
-
-    return doc;
-}
\ No newline at end of file
+    if (res != CURLE_OK) {
+        std::cerr << "curl_easy_perform() failed: " << curl_easy_strerror(res) << std::endl;
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,302 @@
+#include "InstrumentCache.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+
+namespace {
+
+// Layout of the cache file: this header, then count raw InstrumentSpec records in id order
+struct FileHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t specSize;
+    uint32_t count;
+    int64_t savedAtMs;
+};
+constexpr char FileMagic[4] = {'G', 'Q', 'I', 'C'};
+constexpr uint32_t FileVersion = 1;
+
+// Slack for prices and amounts that are on the grid but not exactly representable
+constexpr double GridEpsilon = 1e-9;
+
+template <size_t N>
+void copyText(char (&out)[N], std::string_view text) {
+    const size_t length = std::min(text.size(), N - 1);
+    std::memcpy(out, text.data(), length);
+    out[length] = '\0';
+}
+
+std::string_view readString(const rapidjson::Value& object, const char* name) {
+    auto found = object.FindMember(name);
+    return found != object.MemberEnd() && found->value.IsString()
+        ? std::string_view(found->value.GetString(), found->value.GetStringLength())
+        : std::string_view();
+}
+
+double readNumber(const rapidjson::Value& object, const char* name) {
+    auto found = object.FindMember(name);
+    return found != object.MemberEnd() && found->value.IsNumber() ? found->value.GetDouble() : 0.0;
+}
+
+InstrumentSpec::Kind kindOf(std::string_view kind) {
+    if (kind == "future") return InstrumentSpec::Kind::Future;
+    if (kind == "option") return InstrumentSpec::Kind::Option;
+    if (kind == "spot") return InstrumentSpec::Kind::Spot;
+    if (kind == "future_combo") return InstrumentSpec::Kind::FutureCombo;
+    if (kind == "option_combo") return InstrumentSpec::Kind::OptionCombo;
+    return InstrumentSpec::Kind::Unknown;
+}
+
+// Whether value is a whole number of steps
+bool onGrid(double value, double step) {
+    if (step <= 0.0) {
+        return true;
+    }
+    const double steps = value / step;
+    return std::fabs(steps - std::round(steps)) <= GridEpsilon * std::max(1.0, std::fabs(steps));
+}
+
+bool sameSpec(const InstrumentSpec& a, const InstrumentSpec& b) {
+    return std::memcmp(&a, &b, sizeof(InstrumentSpec)) == 0;
+}
+
+} // namespace
+
+const char* InstrumentCache::toString(Check check) {
+    switch (check) {
+        case Check::Ok: return "ok";
+        case Check::Inactive: return "instrument is not active";
+        case Check::BelowMinimum: return "amount is below the minimum trade amount";
+        case Check::NotContractMultiple: return "amount is not a multiple of the minimum trade amount";
+        case Check::OffTick: return "price is not on the tick size";
+        case Check::MissingPrice: return "price is required for this order type";
+    }
+    return "unknown";
+}
+
+InstrumentCache::InstrumentCache() : specs(new std::atomic<const InstrumentSpec*>[MaxInstruments]) {
+    for (size_t i = 0; i < MaxInstruments; ++i) {
+        specs[i].store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+InstrumentCache::~InstrumentCache() = default;
+
+// Intern the name, or swap in the new spec if the instrument is known and changed; the caller holds mutex
+InstrumentId InstrumentCache::publish(const InstrumentSpec& spec) {
+    auto found = ids.find(spec.name);
+    if (found != ids.end()) {
+        const InstrumentSpec* current = specs[found->second].load(std::memory_order_relaxed);
+        if (!sameSpec(*current, spec)) {
+            storage.push_back(std::make_unique<InstrumentSpec>(spec));
+            specs[found->second].store(storage.back().get(), std::memory_order_release);
+        }
+        return found->second;
+    }
+
+    const size_t id = count.load(std::memory_order_relaxed);
+    if (id >= MaxInstruments) {
+        std::cerr << "Instrument cache full, dropping " << spec.name << std::endl;
+        return NoInstrumentId;
+    }
+    storage.push_back(std::make_unique<InstrumentSpec>(spec));
+    specs[id].store(storage.back().get(), std::memory_order_release);
+    ids.emplace(spec.name, static_cast<InstrumentId>(id));
+    count.store(id + 1, std::memory_order_release);
+    return static_cast<InstrumentId>(id);
+}
+
+size_t InstrumentCache::apply(const rapidjson::Value& instruments) {
+    if (!instruments.IsArray()) {
+        return 0;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    const size_t before = count.load(std::memory_order_relaxed);
+    for (const auto& instrument : instruments.GetArray()) {
+        if (!instrument.IsObject()) {
+            continue;
+        }
+        const std::string_view name = readString(instrument, "instrument_name");
+        if (name.empty() || name.size() >= sizeof(InstrumentSpec::name)) {
+            continue;
+        }
+
+        // Zero-filled first so specs compare and save byte for byte
+        InstrumentSpec spec;
+        std::memset(static_cast<void*>(&spec), 0, sizeof(spec));
+        copyText(spec.name, name);
+        copyText(spec.baseCurrency, readString(instrument, "base_currency"));
+        copyText(spec.settlementCurrency, readString(instrument, "settlement_currency"));
+        spec.kind = kindOf(readString(instrument, "kind"));
+        spec.inverse = readString(instrument, "instrument_type") == "reversed";
+        auto active = instrument.FindMember("is_active");
+        spec.active = active == instrument.MemberEnd() || !active->value.IsBool() || active->value.GetBool();
+        spec.tickSize = readNumber(instrument, "tick_size");
+        spec.contractSize = readNumber(instrument, "contract_size");
+        spec.minTradeAmount = readNumber(instrument, "min_trade_amount");
+        auto expiration = instrument.FindMember("expiration_timestamp");
+        spec.expiration = expiration != instrument.MemberEnd() && expiration->value.IsInt64() ? expiration->value.GetInt64() : 0;
+        publish(spec);
+    }
+    return count.load(std::memory_order_relaxed) - before;
+}
+
+InstrumentId InstrumentCache::find(std::string_view name) const {
+    return find(std::string(name));
+}
+
+InstrumentId InstrumentCache::find(const std::string& name) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto found = ids.find(name);
+    return found != ids.end() ? found->second : NoInstrumentId;
+}
+
+bool InstrumentCache::hasCurrency(std::string_view currency) const {
+    const size_t total = size();
+    for (size_t id = 0; id < total; ++id) {
+        const InstrumentSpec* spec = specs[id].load(std::memory_order_acquire);
+        if (spec && (currency == spec->baseCurrency || currency == spec->settlementCurrency)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+double InstrumentCache::roundPrice(InstrumentId id, double price, bool buy) const {
+    const InstrumentSpec* spec = get(id);
+    if (!spec || spec->tickSize <= 0.0) {
+        return price;
+    }
+    const double ticks = price / spec->tickSize;
+    const double rounded = buy ? std::floor(ticks + GridEpsilon) : std::ceil(ticks - GridEpsilon);
+    return rounded * spec->tickSize;
+}
+
+double InstrumentCache::roundAmount(InstrumentId id, double amount) const {
+    const InstrumentSpec* spec = get(id);
+    if (!spec || spec->minTradeAmount <= 0.0) {
+        return amount;
+    }
+    return std::floor(amount / spec->minTradeAmount + GridEpsilon) * spec->minTradeAmount;
+}
+
+bool InstrumentCache::normalize(OrderRequest& request, bool buy) const {
+    if (request.instrumentId == NoInstrumentId) {
+        request.instrumentId = find(request.instrument);
+    }
+    if (!get(request.instrumentId)) {
+        return false;
+    }
+    if (request.price) {
+        request.price = roundPrice(request.instrumentId, *request.price, buy);
+    }
+    if (request.amount) {
+        request.amount = roundAmount(request.instrumentId, *request.amount);
+    }
+    return true;
+}
+
+InstrumentCache::Check InstrumentCache::check(const OrderRequest& request) const {
+    return check(request, request.instrumentId != NoInstrumentId ? request.instrumentId : find(request.instrument));
+}
+
+InstrumentCache::Check InstrumentCache::check(const OrderRequest& request, InstrumentId id) const {
+    const InstrumentSpec* spec = get(id);
+    if (!spec) {
+        return Check::Ok;
+    }
+    if (!spec->active) {
+        return Check::Inactive;
+    }
+    if (request.amount) {
+        if (*request.amount < spec->minTradeAmount * (1.0 - GridEpsilon)) {
+            return Check::BelowMinimum;
+        }
+        if (!onGrid(*request.amount, spec->minTradeAmount)) {
+            return Check::NotContractMultiple;
+        }
+    }
+
+    const bool limitStyle = request.type == OrderType::Limit || request.type == OrderType::StopLimit ||
+                            request.type == OrderType::TakeLimit;
+    if (limitStyle && !request.price) {
+        return Check::MissingPrice;
+    }
+    // Options have coarser ticks further out, which are still multiples of the base tick
+    if (request.price && !onGrid(*request.price, spec->tickSize)) {
+        return Check::OffTick;
+    }
+    return Check::Ok;
+}
+
+bool InstrumentCache::save(const std::string& path) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    const size_t total = count.load(std::memory_order_acquire);
+
+    // Written to a temporary name and renamed, so a crash never leaves a truncated cache
+    const std::string temporary = path + ".tmp";
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+    if (!out) {
+        std::cerr << "Cannot write instrument cache " << temporary << std::endl;
+        return false;
+    }
+    FileHeader header;
+    std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+    header.version = FileVersion;
+    header.specSize = sizeof(InstrumentSpec);
+    header.count = static_cast<uint32_t>(total);
+    header.savedAtMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    for (size_t id = 0; id < total; ++id) {
+        out.write(reinterpret_cast<const char*>(get(static_cast<InstrumentId>(id))), sizeof(InstrumentSpec));
+    }
+    out.close();
+    if (!out || std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::cerr << "Failed to save instrument cache " << path << std::endl;
+        std::remove(temporary.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool InstrumentCache::load(const std::string& path, std::chrono::seconds maxAge) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    FileHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header)) ||
+        std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) != 0 ||
+        header.version != FileVersion || header.specSize != sizeof(InstrumentSpec) ||
+        header.count > MaxInstruments) {
+        std::cerr << "Ignoring incompatible instrument cache " << path << std::endl;
+        return false;
+    }
+    const int64_t nowMs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    if (nowMs - header.savedAtMs > std::chrono::duration_cast<std::chrono::milliseconds>(maxAge).count()) {
+        return false;
+    }
+
+    std::vector<InstrumentSpec> loaded(header.count);
+    if (!in.read(reinterpret_cast<char*>(loaded.data()), static_cast<std::streamsize>(loaded.size() * sizeof(InstrumentSpec)))) {
+        std::cerr << "Truncated instrument cache " << path << std::endl;
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (count.load(std::memory_order_relaxed) != 0) {
+        return false; // Ids are already handed out; loading would renumber them
+    }
+    for (InstrumentSpec& spec : loaded) {
+        spec.name[sizeof(spec.name) - 1] = '\0';
+        publish(spec);
+    }
+    return true;
+}
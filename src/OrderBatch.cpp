@@ -0,0 +1,81 @@
+#include "OrderBatch.h"
+#include <iostream>
+
+OrderBatch::State::State(size_t count, const std::string& token, Callback onResult)
+    : token(token), onResult(std::move(onResult)), results(count) {
+    arrivals.reserve(count);
+}
+
+// Stored before the callback runs, so a callback that reads the handle sees its own result
+void OrderBatch::State::complete(size_t index, const OrderResult& result) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        results[index] = result;
+        arrivals.push_back(index);
+    }
+    arrived.notify_all();
+    if (onResult) {
+        try {
+            onResult(index, result);
+        } catch (const std::exception& e) {
+            std::cerr << "Error in batch result callback: " << e.what() << std::endl;
+        }
+    }
+}
+
+size_t OrderBatch::size() const {
+    return state ? state->results.size() : 0;
+}
+
+size_t OrderBatch::completed() const {
+    if (!state) {
+        return 0;
+    }
+    std::lock_guard<std::mutex> lock(state->mutex);
+    return state->arrivals.size();
+}
+
+void OrderBatch::wait() const {
+    if (!state) {
+        return;
+    }
+    std::unique_lock<std::mutex> lock(state->mutex);
+    state->arrived.wait(lock, [this]() { return state->arrivals.size() == state->results.size(); });
+}
+
+bool OrderBatch::waitFor(std::chrono::milliseconds timeout) const {
+    if (!state) {
+        return true;
+    }
+    std::unique_lock<std::mutex> lock(state->mutex);
+    return state->arrived.wait_for(lock, timeout, [this]() { return state->arrivals.size() == state->results.size(); });
+}
+
+bool OrderBatch::next(Completion& out) {
+    if (!state) {
+        return false;
+    }
+    std::unique_lock<std::mutex> lock(state->mutex);
+    if (state->readPosition == state->results.size()) {
+        return false;
+    }
+    state->arrived.wait(lock, [this]() { return state->readPosition < state->arrivals.size(); });
+    out.index = state->arrivals[state->readPosition++];
+    out.result = state->results[out.index];
+    return true;
+}
+
+void OrderBatch::cancel() {
+    if (state) {
+        state->cancelled.store(true, std::memory_order_relaxed);
+    }
+}
+
+bool OrderBatch::isCancelled() const {
+    return state && state->cancelled.load(std::memory_order_relaxed);
+}
+
+const std::vector<OrderResult>& OrderBatch::results() const {
+    static const std::vector<OrderResult> none;
+    return state ? state->results : none;
+}
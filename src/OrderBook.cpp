@@ -0,0 +1,153 @@
+#include "OrderBook.h"
+#include <algorithm>
+#include <cstring>
+
+// Read one side ("bids" or "asks") of a book notification into updates
+static bool parseSide(const rapidjson::Value& data, const char* side, std::vector<LevelUpdate>& updates) {
+    updates.clear();
+    auto it = data.FindMember(side);
+    if (it == data.MemberEnd()) {
+        return true; // A side with no changes may be omitted
+    }
+    if (!it->value.IsArray()) {
+        return false;
+    }
+
+    for (const auto& entry : it->value.GetArray()) {
+        if (!entry.IsArray() || entry.Size() != 3 || !entry[0].IsString() || !entry[1].IsNumber() ||
+            !entry[2].IsNumber()) {
+            return false;
+        }
+        LevelUpdate update;
+        switch (entry[0].GetString()[0]) {
+            case 'n': update.action = LevelUpdate::Action::New; break;
+            case 'c': update.action = LevelUpdate::Action::Change; break;
+            case 'd': update.action = LevelUpdate::Action::Delete; break;
+            default: return false;
+        }
+        update.price = entry[1].GetDouble();
+        update.amount = entry[2].GetDouble();
+        updates.push_back(update);
+    }
+    return true;
+}
+
+// Optional integer member: false if present with another type
+static bool readInt64(const rapidjson::Value& data, const char* name, int64_t& out) {
+    auto it = data.FindMember(name);
+    if (it == data.MemberEnd()) {
+        out = 0;
+        return true;
+    }
+    if (!it->value.IsInt64()) {
+        return false;
+    }
+    out = it->value.GetInt64();
+    return true;
+}
+
+// Fill from params.data of a book notification; a member of the wrong type fails the parse
+// instead of tripping a rapidjson assertion on the listener or shard thread
+bool BookDelta::parse(const rapidjson::Value& data) {
+    if (!data.IsObject()) {
+        return false;
+    }
+    auto name = data.FindMember("instrument_name");
+    auto change = data.FindMember("change_id");
+    if (name == data.MemberEnd() || !name->value.IsString() || change == data.MemberEnd() || !change->value.IsInt64()) {
+        return false;
+    }
+    auto type = data.FindMember("type");
+    if (type != data.MemberEnd() && !type->value.IsString()) {
+        return false;
+    }
+    if (!readInt64(data, "prev_change_id", prevChangeId) || !readInt64(data, "timestamp", timestamp)) {
+        return false;
+    }
+
+    instrument.assign(name->value.GetString(), name->value.GetStringLength());
+    changeId = change->value.GetInt64();
+    snapshot = type != data.MemberEnd() && std::strcmp(type->value.GetString(), "snapshot") == 0;
+
+    return parseSide(data, "bids", bids) && parseSide(data, "asks", asks);
+}
+
+OrderBook::OrderBook(const std::string& instrument) : name(instrument) {}
+
+void OrderBook::clear() {
+    bidLevels.clear();
+    askLevels.clear();
+    changeId = 0;
+    synced = false;
+}
+
+// Insert, update or remove one level, keeping the side sorted with the best price last
+void OrderBook::applyLevel(std::vector<PriceLevel>& levels, const LevelUpdate& update, bool ascending) {
+    auto it = ascending
+        ? std::lower_bound(levels.begin(), levels.end(), update.price,
+              [](const PriceLevel& level, double price) { return level.price < price; })
+        : std::lower_bound(levels.begin(), levels.end(), update.price,
+              [](const PriceLevel& level, double price) { return level.price > price; });
+    const bool found = it != levels.end() && it->price == update.price;
+
+    if (update.action == LevelUpdate::Action::Delete || update.amount == 0.0) {
+        if (found) {
+            levels.erase(it);
+        }
+    } else if (found) {
+        it->amount = update.amount;
+    } else {
+        levels.insert(it, PriceLevel{update.price, update.amount});
+    }
+}
+
+// Apply a snapshot or change, checking change_id continuity
+OrderBook::Result OrderBook::apply(const BookDelta& delta) {
+    if (delta.snapshot) {
+        bidLevels.clear();
+        askLevels.clear();
+        // Leave headroom so inserts after the snapshot rarely reallocate
+        bidLevels.reserve(2 * delta.bids.size());
+        askLevels.reserve(2 * delta.asks.size());
+    } else if (!synced) {
+        return Result::Ignored; // Waiting for a snapshot after a gap
+    } else if (delta.prevChangeId != changeId) {
+        synced = false;
+        return Result::Gap;
+    }
+
+    for (const LevelUpdate& update : delta.bids) {
+        applyLevel(bidLevels, update, true);
+    }
+    for (const LevelUpdate& update : delta.asks) {
+        applyLevel(askLevels, update, false);
+    }
+
+    changeId = delta.changeId;
+    timestamp = delta.timestamp;
+    synced = true;
+    return Result::Applied;
+}
+
+// Parse and apply a book notification to the instrument's book
+OrderBook* OrderBookManager::apply(const rapidjson::Value& data, OrderBook::Result& result) {
+    if (!scratch.parse(data)) {
+        result = OrderBook::Result::Ignored;
+        return nullptr;
+    }
+    return apply(scratch, result);
+}
+
+OrderBook* OrderBookManager::apply(const BookDelta& delta, OrderBook::Result& result) {
+    auto it = books.find(delta.instrument);
+    if (it == books.end()) {
+        it = books.emplace(delta.instrument, OrderBook(delta.instrument)).first;
+    }
+    result = it->second.apply(delta);
+    return &it->second;
+}
+
+OrderBook* OrderBookManager::find(const std::string& instrument) {
+    auto it = books.find(instrument);
+    return it == books.end() ? nullptr : &it->second;
+}
@@ -0,0 +1,56 @@
+#include "OrderRequests.h"
+
+const char* toString(OrderType type) {
+    switch (type) {
+        case OrderType::Limit: return "limit";
+        case OrderType::Market: return "market";
+        case OrderType::StopLimit: return "stop_limit";
+        case OrderType::StopMarket: return "stop_market";
+        case OrderType::TakeLimit: return "take_limit";
+        case OrderType::TakeMarket: return "take_market";
+        case OrderType::MarketLimit: return "market_limit";
+        case OrderType::TrailingStop: return "trailing_stop";
+    }
+    return "limit";
+}
+
+const char* toString(TriggerType trigger) {
+    switch (trigger) {
+        case TriggerType::IndexPrice: return "index_price";
+        case TriggerType::MarkPrice: return "mark_price";
+        case TriggerType::LastPrice: return "last_price";
+    }
+    return "index_price";
+}
+
+const char* toString(TimeInForce timeInForce) {
+    switch (timeInForce) {
+        case TimeInForce::GoodTilCancelled: return "good_til_cancelled";
+        case TimeInForce::GoodTilDay: return "good_til_day";
+        case TimeInForce::FillOrKill: return "fill_or_kill";
+        case TimeInForce::ImmediateOrCancel: return "immediate_or_cancel";
+    }
+    return "good_til_cancelled";
+}
+
+std::optional<OrderType> parseOrderType(const std::string& type) {
+    static const OrderType all[] = {
+        OrderType::Limit, OrderType::Market, OrderType::StopLimit, OrderType::StopMarket,
+        OrderType::TakeLimit, OrderType::TakeMarket, OrderType::MarketLimit, OrderType::TrailingStop};
+    for (OrderType candidate : all) {
+        if (type == toString(candidate)) {
+            return candidate;
+        }
+    }
+    return std::nullopt;
+}
+
+std::optional<TriggerType> parseTriggerType(const std::string& trigger) {
+    static const TriggerType all[] = {TriggerType::IndexPrice, TriggerType::MarkPrice, TriggerType::LastPrice};
+    for (TriggerType candidate : all) {
+        if (trigger == toString(candidate)) {
+            return candidate;
+        }
+    }
+    return std::nullopt;
+}
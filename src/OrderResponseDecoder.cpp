@@ -0,0 +1,213 @@
+#include "OrderResponseDecoder.h"
+#include "rapidjson/reader.h"
+#include <algorithm>
+#include <cstring>
+#include <string_view>
+
+const char* toString(OrderResult::State state) {
+    switch (state) {
+        case OrderResult::State::Open: return "open";
+        case OrderResult::State::Filled: return "filled";
+        case OrderResult::State::Rejected: return "rejected";
+        case OrderResult::State::Cancelled: return "cancelled";
+        case OrderResult::State::Untriggered: return "untriggered";
+        case OrderResult::State::Triggered: return "triggered";
+        case OrderResult::State::Unknown: break;
+    }
+    return "unknown";
+}
+
+OrderResult::State orderStateOf(std::string_view state) {
+    if (state == "open") return OrderResult::State::Open;
+    if (state == "filled") return OrderResult::State::Filled;
+    if (state == "rejected") return OrderResult::State::Rejected;
+    if (state == "cancelled") return OrderResult::State::Cancelled;
+    if (state == "untriggered") return OrderResult::State::Untriggered;
+    if (state == "triggered") return OrderResult::State::Triggered;
+    return OrderResult::State::Unknown;
+}
+
+// Copy into a fixed buffer, truncating and always NUL-terminating
+template <size_t N>
+static void copyText(char (&out)[N], const char* text, size_t length) {
+    length = std::min(length, N - 1);
+    std::memcpy(out, text, length);
+    out[length] = '\0';
+}
+
+namespace {
+
+// Keys the decoder cares about; everything else is None
+enum class Field : uint8_t { None, Result, Error, Order, OrderId, OrderState, FilledAmount, AveragePrice, Code, Message };
+
+Field fieldOf(std::string_view key) {
+    if (key == "result") return Field::Result;
+    if (key == "error") return Field::Error;
+    if (key == "order") return Field::Order;
+    if (key == "order_id") return Field::OrderId;
+    if (key == "order_state") return Field::OrderState;
+    if (key == "filled_amount") return Field::FilledAmount;
+    if (key == "average_price") return Field::AveragePrice;
+    if (key == "code") return Field::Code;
+    if (key == "message") return Field::Message;
+    return Field::None;
+}
+
+// SAX handler that tracks the key at each nesting level and only stores values found at
+// result.order.*, result.* or error.*; trades and other nested data are skipped
+class OrderResponseHandler : public rapidjson::BaseReaderHandler<rapidjson::UTF8<>, OrderResponseHandler> {
+public:
+    explicit OrderResponseHandler(OrderResult& result) : result(result) {}
+
+    bool StartObject() { return enter(); }
+    bool EndObject(rapidjson::SizeType) { return leave(); }
+    bool StartArray() { return enter(); }
+    bool EndArray(rapidjson::SizeType) { return leave(); }
+
+    bool Key(const char* str, rapidjson::SizeType length, bool) {
+        if (depth < MaxDepth) {
+            keys[depth] = fieldOf(std::string_view(str, length));
+        }
+        return true;
+    }
+
+    bool String(const char* str, rapidjson::SizeType length, bool) {
+        switch (target()) {
+            case Field::OrderId: copyText(result.orderId, str, length); break;
+            case Field::OrderState: result.state = orderStateOf(std::string_view(str, length)); break;
+            case Field::Message: copyText(result.errorMessage, str, length); break;
+            default: break;
+        }
+        return true;
+    }
+
+    bool Int(int value) { return number(value); }
+    bool Uint(unsigned value) { return number(value); }
+    bool Int64(int64_t value) { return number(static_cast<double>(value)); }
+    bool Uint64(uint64_t value) { return number(static_cast<double>(value)); }
+    bool Double(double value) { return number(value); }
+
+private:
+    static constexpr int MaxDepth = 4;
+
+    bool enter() {
+        ++depth;
+        if (depth < MaxDepth) {
+            keys[depth] = Field::None; // Array elements, and objects until their first key, match nothing
+        }
+        return true;
+    }
+
+    bool leave() {
+        --depth;
+        return true;
+    }
+
+    // Field the current value belongs to, given where it sits in the response
+    Field target() const {
+        if (depth == 2 && keys[1] == Field::Error) {
+            return keys[2] == Field::Code || keys[2] == Field::Message ? keys[2] : Field::None;
+        }
+        const bool inOrder = (depth == 2 && keys[1] == Field::Result) ||
+                             (depth == 3 && keys[1] == Field::Result && keys[2] == Field::Order);
+        if (!inOrder) {
+            return Field::None;
+        }
+        const Field field = keys[depth];
+        return field == Field::OrderId || field == Field::OrderState ||
+               field == Field::FilledAmount || field == Field::AveragePrice ? field : Field::None;
+    }
+
+    bool number(double value) {
+        switch (target()) {
+            case Field::FilledAmount: result.filledAmount = value; break;
+            case Field::AveragePrice: result.averagePrice = value; break;
+            case Field::Code: result.errorCode = static_cast<int>(value); break;
+            default: break;
+        }
+        return true;
+    }
+
+    OrderResult& result;
+    int depth = 0;
+    Field keys[MaxDepth] = {};
+};
+
+} // namespace
+
+// Decode a response body with the SAX reader
+bool OrderResponseDecoder::decode(const std::string& json, OrderResult& result) {
+    result = OrderResult();
+
+    // The reader keeps its parse stack between calls, so steady-state decodes do not allocate
+    static thread_local rapidjson::Reader reader;
+    rapidjson::StringStream stream(json.c_str());
+    OrderResponseHandler handler(result);
+    if (reader.Parse(stream, handler).IsError()) {
+        setLocalError(result, "Malformed response");
+        return false;
+    }
+    if (result.errorCode == 0 && result.errorMessage[0] != '\0') {
+        result.errorCode = OrderResult::LocalError; // An error object without a code
+    }
+    return true;
+}
+
+// Read the same fields out of a DOM
+void OrderResponseDecoder::fromDocument(const rapidjson::Value& doc, OrderResult& result) {
+    result = OrderResult();
+    if (!doc.IsObject()) {
+        setLocalError(result, "Empty response");
+        return;
+    }
+
+    auto error = doc.FindMember("error");
+    if (error != doc.MemberEnd()) {
+        // Local failures are reported as {"error": "<message>"}
+        if (error->value.IsString()) {
+            setLocalError(result, error->value.GetString());
+            return;
+        }
+        if (error->value.IsObject()) {
+            auto code = error->value.FindMember("code");
+            auto message = error->value.FindMember("message");
+            result.errorCode = code != error->value.MemberEnd() && code->value.IsInt() ? code->value.GetInt() : OrderResult::LocalError;
+            if (message != error->value.MemberEnd() && message->value.IsString()) {
+                copyText(result.errorMessage, message->value.GetString(), message->value.GetStringLength());
+            }
+        }
+        return;
+    }
+
+    auto found = doc.FindMember("result");
+    if (found == doc.MemberEnd() || !found->value.IsObject()) {
+        return;
+    }
+    const rapidjson::Value* order = &found->value;
+    auto nested = order->FindMember("order");
+    if (nested != order->MemberEnd() && nested->value.IsObject()) {
+        order = &nested->value;
+    }
+
+    auto orderId = order->FindMember("order_id");
+    if (orderId != order->MemberEnd() && orderId->value.IsString()) {
+        copyText(result.orderId, orderId->value.GetString(), orderId->value.GetStringLength());
+    }
+    auto state = order->FindMember("order_state");
+    if (state != order->MemberEnd() && state->value.IsString()) {
+        result.state = orderStateOf(std::string_view(state->value.GetString(), state->value.GetStringLength()));
+    }
+    auto filled = order->FindMember("filled_amount");
+    if (filled != order->MemberEnd() && filled->value.IsNumber()) {
+        result.filledAmount = filled->value.GetDouble();
+    }
+    auto average = order->FindMember("average_price");
+    if (average != order->MemberEnd() && average->value.IsNumber()) {
+        result.averagePrice = average->value.GetDouble();
+    }
+}
+
+void OrderResponseDecoder::setLocalError(OrderResult& result, const char* message) {
+    result.errorCode = OrderResult::LocalError;
+    copyText(result.errorMessage, message, std::strlen(message));
+}
@@ -0,0 +1,331 @@
+#include "OrderStore.h"
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <string_view>
+
+namespace {
+
+const rapidjson::Value* member(const rapidjson::Value& object, const char* name) {
+    auto found = object.FindMember(name);
+    return found != object.MemberEnd() ? &found->value : nullptr;
+}
+
+bool readString(const rapidjson::Value& object, const char* name, std::string& out) {
+    const rapidjson::Value* value = member(object, name);
+    if (!value || !value->IsString()) {
+        return false;
+    }
+    out.assign(value->GetString(), value->GetStringLength());
+    return true;
+}
+
+double readNumber(const rapidjson::Value& object, const char* name, double fallback) {
+    const rapidjson::Value* value = member(object, name);
+    return value && value->IsNumber() ? value->GetDouble() : fallback;
+}
+
+int64_t readInt64(const rapidjson::Value& object, const char* name, int64_t fallback) {
+    const rapidjson::Value* value = member(object, name);
+    return value && value->IsInt64() ? value->GetInt64() : fallback;
+}
+
+OrderResult::State readState(const rapidjson::Value& object, const char* name) {
+    const rapidjson::Value* value = member(object, name);
+    return value && value->IsString()
+        ? orderStateOf(std::string_view(value->GetString(), value->GetStringLength()))
+        : OrderResult::State::Unknown;
+}
+
+} // namespace
+
+bool OrderFilter::matches(const OrderRecord& record) const {
+    return (instrument.empty() || record.instrument == instrument)
+        && record.label.compare(0, labelPrefix.size(), labelPrefix) == 0
+        && (!buy || record.buy == *buy);
+}
+
+OrderStore::OrderStore(size_t maxClosedOrders) : maxClosedOrders(maxClosedOrders) {}
+
+bool OrderStore::applyOrder(const rapidjson::Value& order) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    return applyOrderLocked(order) != nullptr;
+}
+
+// Field by field, so an update that leaves a field out keeps the stored value
+OrderRecord* OrderStore::applyOrderLocked(const rapidjson::Value& order) {
+    if (!order.IsObject()) {
+        return nullptr;
+    }
+    std::string orderId;
+    if (!readString(order, "order_id", orderId)) {
+        return nullptr;
+    }
+
+    auto inserted = orders.try_emplace(orderId);
+    OrderRecord& record = inserted.first->second;
+    const int64_t updated = readInt64(order, "last_update_timestamp", 0);
+    if (!inserted.second && updated < record.updated) {
+        return &record; // Older than what we have
+    }
+    const OrderResult::State state = readState(order, "order_state");
+    if (!inserted.second && updated == record.updated && !record.isOpen() && state != record.state
+        && (state == OrderResult::State::Open || state == OrderResult::State::Untriggered)) {
+        return &record; // Same instant but we already saw it close
+    }
+
+    const bool wasOpen = !inserted.second && record.isOpen();
+    if (inserted.second) {
+        record.orderId = std::move(orderId);
+    }
+    const std::string previousLabel = wasOpen ? record.label : std::string();
+    readString(order, "instrument_name", record.instrument);
+    readString(order, "label", record.label);
+    readString(order, "order_type", record.orderType);
+    std::string direction;
+    if (readString(order, "direction", direction)) {
+        record.buy = direction == "buy";
+    }
+    if (state != OrderResult::State::Unknown) {
+        record.state = state;
+    }
+    record.amount = readNumber(order, "amount", record.amount);
+    record.price = readNumber(order, "price", record.price);
+    record.filledAmount = std::max(readNumber(order, "filled_amount", record.filledAmount), record.tradedAmount);
+    record.averagePrice = readNumber(order, "average_price", record.averagePrice);
+    record.created = readInt64(order, "creation_timestamp", record.created);
+    record.updated = std::max(updated, record.updated);
+
+    updateIndexLocked(record, wasOpen, inserted.second, previousLabel);
+    ++updates;
+    return &record;
+}
+
+// A fill seen before the order update that reports it still moves filled_amount and the state
+bool OrderStore::applyTrade(const rapidjson::Value& trade) {
+    if (!trade.IsObject()) {
+        return false;
+    }
+    std::string orderId;
+    if (!readString(trade, "order_id", orderId)) {
+        return false;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    auto inserted = orders.try_emplace(orderId);
+    OrderRecord& record = inserted.first->second;
+    const int64_t tradeSeq = readInt64(trade, "trade_seq", -1);
+    if (tradeSeq >= 0 && tradeSeq <= record.lastTradeSeq) {
+        return true; // Already counted
+    }
+
+    const bool wasOpen = !inserted.second && record.isOpen();
+    if (inserted.second) {
+        record.orderId = std::move(orderId);
+        readString(trade, "instrument_name", record.instrument);
+        readString(trade, "label", record.label);
+        readString(trade, "order_type", record.orderType);
+        std::string direction;
+        if (readString(trade, "direction", direction)) {
+            record.buy = direction == "buy";
+        }
+    }
+    record.lastTradeSeq = std::max(record.lastTradeSeq, tradeSeq);
+
+    const double amount = readNumber(trade, "amount", 0.0);
+    record.tradedAmount += amount;
+    record.tradedNotional += amount * readNumber(trade, "price", 0.0);
+    if (record.tradedAmount > record.filledAmount) {
+        record.filledAmount = record.tradedAmount;
+        record.averagePrice = record.tradedNotional / record.tradedAmount;
+    }
+
+    const int64_t timestamp = readInt64(trade, "timestamp", 0);
+    if (timestamp >= record.updated) {
+        const OrderResult::State state = readState(trade, "state");
+        if (state != OrderResult::State::Unknown) {
+            record.state = state;
+        }
+        record.updated = timestamp;
+    }
+
+    updateIndexLocked(record, wasOpen, inserted.second, record.label);
+    ++updates;
+    return true;
+}
+
+void OrderStore::applyOrders(const rapidjson::Value& data) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    if (data.IsArray()) {
+        for (const auto& order : data.GetArray()) {
+            applyOrderLocked(order);
+        }
+    } else {
+        applyOrderLocked(data);
+    }
+}
+
+void OrderStore::applyTrades(const rapidjson::Value& data) {
+    if (data.IsArray()) {
+        for (const auto& trade : data.GetArray()) {
+            applyTrade(trade);
+        }
+    } else {
+        applyTrade(data);
+    }
+}
+
+std::vector<std::string> OrderStore::reconcile(const rapidjson::Value& openOrders, int64_t requestedAtMs) {
+    std::vector<std::string> missing;
+    if (!openOrders.IsArray()) {
+        return missing;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    std::unordered_set<const OrderRecord*> listed;
+    for (const auto& order : openOrders.GetArray()) {
+        if (const OrderRecord* record = applyOrderLocked(order)) {
+            listed.insert(record);
+        }
+    }
+    for (const OrderRecord* record : open) {
+        if (!listed.count(record) && record->updated < requestedAtMs) {
+            missing.push_back(record->orderId);
+        }
+    }
+    return missing;
+}
+
+// Keep the open set and label index in step with the record, and evict the oldest closed
+// orders past the limit. previousLabel is the label the record was indexed under if it was open.
+void OrderStore::updateIndexLocked(OrderRecord& record, bool wasOpen, bool isNew, const std::string& previousLabel) {
+    const bool isOpen = record.isOpen();
+    if (isOpen && !wasOpen) {
+        open.insert(&record);
+    } else if (!isOpen && wasOpen) {
+        open.erase(&record);
+    }
+    const bool relabelled = wasOpen && isOpen && previousLabel != record.label;
+    if (wasOpen && (!isOpen || relabelled) && !previousLabel.empty()) {
+        auto indexed = openByLabel.find(previousLabel);
+        if (indexed != openByLabel.end()) {
+            indexed->second.erase(&record);
+            if (indexed->second.empty()) {
+                openByLabel.erase(indexed);
+            }
+        }
+    }
+    if (isOpen && (!wasOpen || relabelled) && !record.label.empty()) {
+        openByLabel[record.label].insert(&record);
+    }
+    if (isOpen || (!wasOpen && !isNew)) {
+        return;
+    }
+
+    if (onClose) {
+        onClose(record);
+    }
+    closed.push_back(record.orderId);
+    while (closed.size() > maxClosedOrders) {
+        auto evicted = orders.find(closed.front());
+        if (evicted != orders.end() && !evicted->second.isOpen() && &evicted->second != &record) {
+            orders.erase(evicted);
+        }
+        closed.pop_front();
+    }
+}
+
+bool OrderStore::find(const std::string& orderId, OrderRecord& out) const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto found = orders.find(orderId);
+    if (found == orders.end()) {
+        return false;
+    }
+    out = found->second;
+    return true;
+}
+
+bool OrderStore::find(const std::string& orderId, OrderResult& out) const {
+    out = OrderResult();
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    auto found = orders.find(orderId);
+    if (found == orders.end()) {
+        return false;
+    }
+    const OrderRecord& record = found->second;
+    const size_t length = std::min(record.orderId.size(), sizeof(out.orderId) - 1);
+    std::memcpy(out.orderId, record.orderId.data(), length);
+    out.orderId[length] = '\0';
+    out.state = record.state;
+    out.filledAmount = record.filledAmount;
+    out.averagePrice = record.averagePrice;
+    return true;
+}
+
+std::vector<OrderRecord> OrderStore::openOrders(const std::string& instrument) const {
+    std::vector<OrderRecord> result;
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    result.reserve(open.size());
+    for (const OrderRecord* record : open) {
+        if (instrument.empty() || record->instrument == instrument) {
+            result.push_back(*record);
+        }
+    }
+    return result;
+}
+
+std::vector<OrderRecord> OrderStore::openOrders(const OrderFilter& filter) const {
+    std::vector<OrderRecord> result;
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    if (filter.labelPrefix.empty()) {
+        for (const OrderRecord* record : open) {
+            if (filter.matches(*record)) {
+                result.push_back(*record);
+            }
+        }
+        return result;
+    }
+    for (auto it = openByLabel.lower_bound(filter.labelPrefix);
+         it != openByLabel.end() && it->first.compare(0, filter.labelPrefix.size(), filter.labelPrefix) == 0; ++it) {
+        for (const OrderRecord* record : it->second) {
+            if (filter.matches(*record)) {
+                result.push_back(*record);
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<std::string> OrderStore::openLabels(std::string_view prefix) const {
+    std::vector<std::string> labels;
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    for (auto it = openByLabel.lower_bound(prefix);
+         it != openByLabel.end() && std::string_view(it->first).substr(0, prefix.size()) == prefix; ++it) {
+        labels.push_back(it->first);
+    }
+    return labels;
+}
+
+uint64_t OrderStore::version() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return updates;
+}
+
+size_t OrderStore::size() const {
+    std::shared_lock<std::shared_mutex> lock(mutex);
+    return orders.size();
+}
+
+void OrderStore::setCloseHandler(CloseHandler handler) {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    onClose = std::move(handler);
+}
+
+void OrderStore::clear() {
+    std::unique_lock<std::shared_mutex> lock(mutex);
+    orders.clear();
+    open.clear();
+    openByLabel.clear();
+    closed.clear();
+    ++updates;
+}
@@ -0,0 +1,93 @@
+#include "OrderTracker.h"
+#include "WebSocketClient.h"
+#include <iostream>
+
+OrderTracker::OrderTracker(Trading& trading, OrderStore& store, TokenSource token, std::chrono::seconds reconcileInterval)
+    : trading(trading), store(store), token(std::move(token)), reconcileInterval(reconcileInterval) {}
+
+OrderTracker::~OrderTracker() {
+    stop();
+}
+
+bool OrderTracker::start(WebSocketClient& webSocket, const std::string& scope) {
+    if (running.load(std::memory_order_acquire)) {
+        return true;
+    }
+
+    // Handlers go in before the subscriptions, so no notification is missed; the store
+    // ignores anything older than what it holds, so REST and WebSocket may interleave freely
+    client = &webSocket;
+    OrderStore& orders = store;
+    orderHandler = client->addChannelHandler("user.orders.", [&orders](std::string_view, const rapidjson::Value& data) {
+        orders.applyOrders(data);
+    });
+    tradeHandler = client->addChannelHandler("user.trades.", [&orders](std::string_view, const rapidjson::Value& data) {
+        orders.applyTrades(data);
+    });
+
+    const std::string accessToken = token();
+    const std::vector<std::string> channels{"user.orders." + scope + ".raw", "user.trades." + scope + ".raw"};
+    if (!client->subscribe(channels, accessToken) || !reconcile()) {
+        std::cerr << "Failed to start order tracking" << std::endl;
+        stop();
+        return false;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+    }
+    running.store(true, std::memory_order_release);
+    reconcileThread = std::thread(&OrderTracker::run, this);
+    return true;
+}
+
+void OrderTracker::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeUp.notify_all();
+    if (reconcileThread.joinable()) {
+        reconcileThread.join();
+    }
+    running.store(false, std::memory_order_release);
+
+    if (client) {
+        client->removeChannelHandler(orderHandler);
+        client->removeChannelHandler(tradeHandler);
+        client = nullptr;
+    }
+}
+
+// The request time comes from the response's usIn, on the exchange's clock like the order timestamps
+bool OrderTracker::reconcile() {
+    const std::string accessToken = token();
+    rapidjson::Document response = trading.getOpenOrder(accessToken);
+    if (!response.IsObject() || !response.HasMember("result") || !response["result"].IsArray()) {
+        std::cerr << "Order reconciliation failed: no open orders in response" << std::endl;
+        return false;
+    }
+    const int64_t requestedAtMs = response.HasMember("usIn") && response["usIn"].IsInt64()
+        ? response["usIn"].GetInt64() / 1000
+        : std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::system_clock::now().time_since_epoch()).count();
+
+    for (const std::string& orderId : store.reconcile(response["result"], requestedAtMs)) {
+        rapidjson::Document state = trading.getOrderState(orderId, accessToken);
+        if (state.IsObject() && state.HasMember("result") && store.applyOrder(state["result"])) {
+            repaired.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+    reconciles.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void OrderTracker::run() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!wakeUp.wait_for(lock, reconcileInterval, [this]() { return stopping; })) {
+        lock.unlock();
+        reconcile();
+        lock.lock();
+    }
+}
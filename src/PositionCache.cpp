@@ -0,0 +1,260 @@
+#include "PositionCache.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <functional>
+#include <iostream>
+
+namespace {
+
+double readNumber(const rapidjson::Value& object, const char* name, double fallback) {
+    auto found = object.FindMember(name);
+    return found != object.MemberEnd() && found->value.IsNumber() ? found->value.GetDouble() : fallback;
+}
+
+std::string_view readString(const rapidjson::Value& object, const char* name) {
+    auto found = object.FindMember(name);
+    return found != object.MemberEnd() && found->value.IsString()
+        ? std::string_view(found->value.GetString(), found->value.GetStringLength())
+        : std::string_view();
+}
+
+int64_t nowMs() {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+}
+
+template <size_t N>
+void copyName(char (&out)[N], std::string_view name) {
+    const size_t length = std::min(name.size(), N - 1);
+    std::memcpy(out, name.data(), length);
+    out[length] = '\0';
+}
+
+// Coin-margined futures are sized in USD; USDC/USDT-settled ones and options are linear
+bool isInverse(std::string_view instrument, std::string_view kind) {
+    if (kind != "future") {
+        return false;
+    }
+    return instrument.find("_USDC") == std::string_view::npos && instrument.find("_USDT") == std::string_view::npos;
+}
+
+} // namespace
+
+PositionCache::~PositionCache() {
+    for (auto& entry : positionTable) {
+        delete entry.load(std::memory_order_relaxed);
+    }
+    for (auto& entry : portfolioTable) {
+        delete entry.load(std::memory_order_relaxed);
+    }
+}
+
+// Linear probe from the key's hash; slots are only ever added, so the first empty entry ends the search
+template<typename SlotT, size_t Capacity>
+SlotT* PositionCache::find(const std::atomic<SlotT*> (&table)[Capacity], std::string_view key) {
+    const size_t start = std::hash<std::string_view>()(key) % Capacity;
+    for (size_t i = 0; i < Capacity; ++i) {
+        SlotT* slot = table[(start + i) % Capacity].load(std::memory_order_acquire);
+        if (!slot) {
+            return nullptr;
+        }
+        if (slot->key == key) {
+            return slot;
+        }
+    }
+    return nullptr;
+}
+
+// Find or add the slot for an instrument; the caller holds writeMutex
+PositionCache::PositionSlot* PositionCache::positionSlot(std::string_view instrument, bool inverse) {
+    const size_t start = std::hash<std::string_view>()(instrument) % MaxInstruments;
+    for (size_t i = 0; i < MaxInstruments; ++i) {
+        std::atomic<PositionSlot*>& entry = positionTable[(start + i) % MaxInstruments];
+        PositionSlot* slot = entry.load(std::memory_order_relaxed);
+        if (slot && slot->key == instrument) {
+            return slot;
+        }
+        if (!slot) {
+            slot = new PositionSlot(instrument);
+            Position initial;
+            copyName(initial.instrument, instrument);
+            initial.inverse = inverse;
+            slot->value.store(initial);
+            entry.store(slot, std::memory_order_release);
+            return slot;
+        }
+    }
+    std::cerr << "Position cache full, dropping " << instrument << std::endl;
+    return nullptr;
+}
+
+PositionCache::PortfolioSlot* PositionCache::portfolioSlot(std::string_view currency) {
+    const size_t start = std::hash<std::string_view>()(currency) % MaxCurrencies;
+    for (size_t i = 0; i < MaxCurrencies; ++i) {
+        std::atomic<PortfolioSlot*>& entry = portfolioTable[(start + i) % MaxCurrencies];
+        PortfolioSlot* slot = entry.load(std::memory_order_relaxed);
+        if (slot && slot->key == currency) {
+            return slot;
+        }
+        if (!slot) {
+            slot = new PortfolioSlot(currency);
+            Portfolio initial;
+            copyName(initial.currency, currency);
+            slot->value.store(initial);
+            entry.store(slot, std::memory_order_release);
+            return slot;
+        }
+    }
+    std::cerr << "Portfolio cache full, dropping " << currency << std::endl;
+    return nullptr;
+}
+
+// PnL of the open size at markPrice, in the instrument's settlement currency
+double PositionCache::floatingPnl(const Position& position, double markPrice) {
+    if (position.size == 0.0 || position.averagePrice <= 0.0 || markPrice <= 0.0) {
+        return 0.0;
+    }
+    if (position.inverse) {
+        return position.size * (1.0 / position.averagePrice - 1.0 / markPrice);
+    }
+    return position.size * (markPrice - position.averagePrice);
+}
+
+void PositionCache::applyPosition(const rapidjson::Value& data, uint64_t seedMark) {
+    if (!data.IsObject()) {
+        return;
+    }
+    const std::string_view instrument = readString(data, "instrument_name");
+    if (instrument.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    PositionSlot* slot = positionSlot(instrument, isInverse(instrument, readString(data, "kind")));
+    if (!slot || (seedMark != Live && slot->notified > seedMark)) {
+        return;
+    }
+    if (seedMark == Live) {
+        slot->notified = notifications.fetch_add(1, std::memory_order_acq_rel) + 1;
+    }
+    Position position = slot->value.load();
+    position.size = readNumber(data, "size", position.size);
+    position.averagePrice = readNumber(data, "average_price", position.averagePrice);
+    position.markPrice = readNumber(data, "mark_price", position.markPrice);
+    position.floatingPnl = readNumber(data, "floating_profit_loss", floatingPnl(position, position.markPrice));
+    position.realizedPnl = readNumber(data, "realized_profit_loss", position.realizedPnl);
+    position.initialMargin = readNumber(data, "initial_margin", position.initialMargin);
+    position.maintenanceMargin = readNumber(data, "maintenance_margin", position.maintenanceMargin);
+    position.delta = readNumber(data, "delta", position.delta);
+    position.updated = nowMs();
+    slot->value.store(position);
+    updates.fetch_add(1, std::memory_order_release);
+}
+
+void PositionCache::applyPositions(const rapidjson::Value& positions, uint64_t seedMark) {
+    if (!positions.IsArray()) {
+        return;
+    }
+    for (const auto& position : positions.GetArray()) {
+        applyPosition(position, seedMark);
+    }
+}
+
+void PositionCache::applyChanges(const rapidjson::Value& data) {
+    if (!data.IsObject()) {
+        return;
+    }
+    auto positions = data.FindMember("positions");
+    if (positions != data.MemberEnd()) {
+        applyPositions(positions->value);
+    }
+}
+
+void PositionCache::applyPortfolio(const rapidjson::Value& data, uint64_t seedMark) {
+    if (!data.IsObject()) {
+        return;
+    }
+    const std::string_view currency = readString(data, "currency");
+    if (currency.empty()) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    PortfolioSlot* slot = portfolioSlot(currency);
+    if (!slot || (seedMark != Live && slot->notified > seedMark)) {
+        return;
+    }
+    if (seedMark == Live) {
+        slot->notified = notifications.fetch_add(1, std::memory_order_acq_rel) + 1;
+    }
+    Portfolio portfolio = slot->value.load();
+    portfolio.equity = readNumber(data, "equity", portfolio.equity);
+    portfolio.balance = readNumber(data, "balance", portfolio.balance);
+    portfolio.availableFunds = readNumber(data, "available_funds", portfolio.availableFunds);
+    portfolio.marginBalance = readNumber(data, "margin_balance", portfolio.marginBalance);
+    portfolio.initialMargin = readNumber(data, "initial_margin", portfolio.initialMargin);
+    portfolio.maintenanceMargin = readNumber(data, "maintenance_margin", portfolio.maintenanceMargin);
+    portfolio.totalPnl = readNumber(data, "total_pl", portfolio.totalPnl);
+    portfolio.sessionUpl = readNumber(data, "session_upl", portfolio.sessionUpl);
+    portfolio.sessionRpl = readNumber(data, "session_rpl", portfolio.sessionRpl);
+    portfolio.deltaTotal = readNumber(data, "delta_total", portfolio.deltaTotal);
+    portfolio.updated = nowMs();
+    slot->value.store(portfolio);
+    updates.fetch_add(1, std::memory_order_release);
+}
+
+void PositionCache::markToMarket(std::string_view instrument, double markPrice) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    PositionSlot* slot = find(positionTable, instrument);
+    if (!slot) {
+        return;
+    }
+    Position position = slot->value.load();
+    position.markPrice = markPrice;
+    position.floatingPnl = floatingPnl(position, markPrice);
+    position.updated = nowMs();
+    slot->value.store(position);
+    updates.fetch_add(1, std::memory_order_release);
+}
+
+bool PositionCache::position(std::string_view instrument, Position& out) const {
+    const PositionSlot* slot = find(positionTable, instrument);
+    if (!slot) {
+        return false;
+    }
+    out = slot->value.load();
+    return true;
+}
+
+bool PositionCache::portfolio(std::string_view currency, Portfolio& out) const {
+    const PortfolioSlot* slot = find(portfolioTable, currency);
+    if (!slot) {
+        return false;
+    }
+    out = slot->value.load();
+    return true;
+}
+
+std::vector<PositionCache::Position> PositionCache::positions(bool includeFlat) const {
+    std::vector<Position> result;
+    for (const auto& entry : positionTable) {
+        if (const PositionSlot* slot = entry.load(std::memory_order_acquire)) {
+            Position position = slot->value.load();
+            if (includeFlat || position.size != 0.0) {
+                result.push_back(position);
+            }
+        }
+    }
+    return result;
+}
+
+std::vector<PositionCache::Portfolio> PositionCache::portfolios() const {
+    std::vector<Portfolio> result;
+    for (const auto& entry : portfolioTable) {
+        if (const PortfolioSlot* slot = entry.load(std::memory_order_acquire)) {
+            result.push_back(slot->value.load());
+        }
+    }
+    return result;
+}
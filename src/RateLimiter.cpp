@@ -0,0 +1,125 @@
+#include "RateLimiter.h"
+#include <algorithm>
+#include <thread>
+
+RateLimiter::BucketConfig RateLimiter::defaultConfig(Bucket bucket) {
+    if (bucket == Bucket::MatchingEngine) {
+        return {20.0, 5.0, 1.0};
+    }
+    return {50000.0, 10000.0, 500.0};
+}
+
+RateLimiter::RateLimiter(Policy policy)
+    : RateLimiter(defaultConfig(Bucket::MatchingEngine), defaultConfig(Bucket::NonMatchingEngine), policy) {}
+
+RateLimiter::RateLimiter(const BucketConfig& matchingEngine, const BucketConfig& nonMatchingEngine, Policy policy)
+    : policy(policy) {
+    configure(Bucket::MatchingEngine, matchingEngine);
+    configure(Bucket::NonMatchingEngine, nonMatchingEngine);
+}
+
+int64_t RateLimiter::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+RateLimiter::Bucket RateLimiter::classify(std::string_view endpoint) {
+    const size_t query = endpoint.find('?');
+    endpoint = endpoint.substr(0, query);
+    const size_t slash = endpoint.rfind('/');
+    const std::string_view method = slash == std::string_view::npos ? endpoint : endpoint.substr(slash + 1);
+    if (endpoint.find("private/") == std::string_view::npos) {
+        return Bucket::NonMatchingEngine;
+    }
+
+    // Calls that reach the order book
+    static constexpr std::string_view matching[] = {
+        "buy", "sell", "edit", "edit_by_label", "cancel", "cancel_all", "cancel_all_by_currency",
+        "cancel_all_by_instrument", "cancel_all_by_kind_or_type", "cancel_by_label", "cancel_quotes",
+        "close_position", "mass_quote",
+    };
+    for (std::string_view name : matching) {
+        if (method == name) {
+            return Bucket::MatchingEngine;
+        }
+    }
+    return Bucket::NonMatchingEngine;
+}
+
+void RateLimiter::configure(Bucket bucket, const BucketConfig& config) {
+    State& state = buckets[static_cast<int>(bucket)];
+    state.config = config;
+    const double refill = std::max(config.refillPerSecond, 1e-9);
+    state.costNs = static_cast<int64_t>(config.cost / refill * 1e9);
+    state.toleranceNs = static_cast<int64_t>(std::max(config.capacity - config.cost, 0.0) / refill * 1e9);
+    state.arrivalNs.store(0, std::memory_order_relaxed);
+}
+
+bool RateLimiter::acquire(Bucket bucket) {
+    std::chrono::nanoseconds wait(0);
+    if (!reserve(bucket, wait)) {
+        return false;
+    }
+    if (wait.count() > 0) {
+        std::this_thread::sleep_for(wait);
+    }
+    return true;
+}
+
+bool RateLimiter::reserve(Bucket bucket, std::chrono::nanoseconds& wait) {
+    State& state = buckets[static_cast<int>(bucket)];
+    const bool queue = policy.load(std::memory_order_relaxed) == Policy::Queue;
+    const int64_t maxWait = maxWaitNs.load(std::memory_order_relaxed);
+    const int64_t now = nowNs();
+
+    // The bucket is full while the arrival time is at or behind now; each request pushes it
+    // forward by its cost, and a request fits while it stays within the burst tolerance
+    int64_t arrival = state.arrivalNs.load(std::memory_order_relaxed);
+    int64_t waitNs = 0;
+    for (;;) {
+        const int64_t start = std::max(arrival, now);
+        waitNs = start - state.toleranceNs - now;
+        if (waitNs > 0 && (!queue || waitNs > maxWait)) {
+            state.rejected.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (state.arrivalNs.compare_exchange_weak(arrival, start + state.costNs, std::memory_order_relaxed)) {
+            break;
+        }
+    }
+
+    if (waitNs > 0) {
+        state.throttled.fetch_add(1, std::memory_order_relaxed);
+        state.waitedNs.fetch_add(static_cast<uint64_t>(waitNs), std::memory_order_relaxed);
+    }
+    state.admitted.fetch_add(1, std::memory_order_relaxed);
+    wait = std::chrono::nanoseconds(std::max<int64_t>(waitNs, 0));
+    return true;
+}
+
+double RateLimiter::credits(Bucket bucket) const {
+    const State& state = buckets[static_cast<int>(bucket)];
+    const int64_t ahead = std::max<int64_t>(state.arrivalNs.load(std::memory_order_relaxed) - nowNs(), 0);
+    const double available = static_cast<double>(state.toleranceNs + state.costNs - ahead) * state.config.refillPerSecond / 1e9;
+    return std::min(std::max(available, 0.0), state.config.capacity);
+}
+
+RateLimiter::Stats RateLimiter::stats(Bucket bucket) const {
+    const State& state = buckets[static_cast<int>(bucket)];
+    Stats stats;
+    stats.admitted = state.admitted.load(std::memory_order_relaxed);
+    stats.throttled = state.throttled.load(std::memory_order_relaxed);
+    stats.rejected = state.rejected.load(std::memory_order_relaxed);
+    stats.waitedNs = state.waitedNs.load(std::memory_order_relaxed);
+    stats.credits = credits(bucket);
+    return stats;
+}
+
+void RateLimiter::resetStats() {
+    for (State& state : buckets) {
+        state.admitted.store(0, std::memory_order_relaxed);
+        state.throttled.store(0, std::memory_order_relaxed);
+        state.rejected.store(0, std::memory_order_relaxed);
+        state.waitedNs.store(0, std::memory_order_relaxed);
+    }
+}
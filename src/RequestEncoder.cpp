@@ -0,0 +1,229 @@
+#include "RequestEncoder.h"
+#include <charconv>
+
+static constexpr std::string_view restPrefix = "/api/v2/";
+static constexpr char hexDigits[] = "0123456789ABCDEF";
+
+// Appends key=value pairs to a REST target, starting the query string on the first one
+class QuerySink {
+public:
+    explicit QuerySink(std::string& out) : out(out) {}
+
+    void text(std::string_view key, std::string_view value) {
+        startField(key);
+        RequestEncoder::appendPercentEncoded(out, value);
+    }
+    void number(std::string_view key, double value) {
+        startField(key);
+        RequestEncoder::appendNumber(out, value);
+    }
+    void flag(std::string_view key, bool value) {
+        startField(key);
+        out.append(value ? "true" : "false");
+    }
+
+private:
+    void startField(std::string_view key) {
+        out += first ? '?' : '&';
+        first = false;
+        out.append(key);
+        out += '=';
+    }
+
+    std::string& out;
+    bool first = true;
+};
+
+// Appends "key":value members to an already opened JSON object
+class JsonSink {
+public:
+    JsonSink(std::string& out, bool first) : out(out), first(first) {}
+
+    void text(std::string_view key, std::string_view value) {
+        startField(key);
+        out += '"';
+        RequestEncoder::appendJsonEscaped(out, value);
+        out += '"';
+    }
+    void number(std::string_view key, double value) {
+        startField(key);
+        RequestEncoder::appendNumber(out, value);
+    }
+    void flag(std::string_view key, bool value) {
+        startField(key);
+        out.append(value ? "true" : "false");
+    }
+
+private:
+    void startField(std::string_view key) {
+        if (!first) {
+            out += ',';
+        }
+        first = false;
+        out += '"';
+        out.append(key);
+        out.append("\":");
+    }
+
+    std::string& out;
+    bool first;
+};
+
+// Fields of private/buy and private/sell, in the order they are sent
+template <typename Sink>
+static void writeFields(Sink& sink, const OrderRequest& request) {
+    sink.text("instrument_name", request.instrument);
+    if (request.amount) {
+        sink.number("amount", *request.amount);
+    }
+    if (request.contracts) {
+        sink.number("contracts", *request.contracts);
+    }
+    sink.text("type", toString(request.type));
+    if (request.price) {
+        sink.number("price", *request.price);
+    }
+    if (!request.label.empty()) {
+        sink.text("label", request.label);
+    }
+    if (request.timeInForce) {
+        sink.text("time_in_force", toString(*request.timeInForce));
+    }
+    if (request.postOnly) {
+        sink.flag("post_only", *request.postOnly);
+    }
+    if (request.reduceOnly) {
+        sink.flag("reduce_only", *request.reduceOnly);
+    }
+    if (request.trigger) {
+        sink.text("trigger", toString(*request.trigger));
+    }
+    if (request.triggerPrice) {
+        sink.number("trigger_price", *request.triggerPrice);
+    }
+}
+
+// Fields of private/edit
+template <typename Sink>
+static void writeFields(Sink& sink, const EditRequest& request) {
+    sink.text("order_id", request.orderId);
+    if (request.amount) {
+        sink.number("amount", *request.amount);
+    }
+    if (request.contracts) {
+        sink.number("contracts", *request.contracts);
+    }
+    if (request.price) {
+        sink.number("price", *request.price);
+    }
+    if (request.advanced) {
+        sink.text("advanced", *request.advanced);
+    }
+    if (request.postOnly) {
+        sink.flag("post_only", *request.postOnly);
+    }
+    if (request.reduceOnly) {
+        sink.flag("reduce_only", *request.reduceOnly);
+    }
+}
+
+// Fields of private/cancel
+template <typename Sink>
+static void writeFields(Sink& sink, const CancelRequest& request) {
+    sink.text("order_id", request.orderId);
+}
+
+template <typename Request>
+static void encodeTargetOf(std::string& out, const Request& request) {
+    out.assign(restPrefix);
+    out.append(RequestEncoder::method(request));
+    QuerySink sink(out);
+    writeFields(sink, request);
+}
+
+template <typename Request>
+static void encodeJsonRpcOf(std::string& out, uint64_t id, std::string_view accessToken, const Request& request) {
+    out.assign("{\"jsonrpc\":\"2.0\",\"id\":");
+    RequestEncoder::appendNumber(out, id);
+    out.append(",\"method\":\"");
+    out.append(RequestEncoder::method(request));
+    out.append("\",\"params\":{");
+    JsonSink sink(out, true);
+    if (!accessToken.empty()) {
+        sink.text("access_token", accessToken);
+    }
+    writeFields(sink, request);
+    out.append("}}");
+}
+
+void RequestEncoder::encodeTarget(std::string& out, const BuyRequest& request) { encodeTargetOf(out, request); }
+void RequestEncoder::encodeTarget(std::string& out, const SellRequest& request) { encodeTargetOf(out, request); }
+void RequestEncoder::encodeTarget(std::string& out, const EditRequest& request) { encodeTargetOf(out, request); }
+void RequestEncoder::encodeTarget(std::string& out, const CancelRequest& request) { encodeTargetOf(out, request); }
+
+void RequestEncoder::encodeTarget(std::string& out, const char* method, const char* key, std::string_view value) {
+    out.assign(restPrefix);
+    out.append(method);
+    if (key) {
+        QuerySink sink(out);
+        sink.text(key, value);
+    }
+}
+
+void RequestEncoder::encodeJsonRpc(std::string& out, uint64_t id, std::string_view accessToken, const BuyRequest& request) {
+    encodeJsonRpcOf(out, id, accessToken, request);
+}
+void RequestEncoder::encodeJsonRpc(std::string& out, uint64_t id, std::string_view accessToken, const SellRequest& request) {
+    encodeJsonRpcOf(out, id, accessToken, request);
+}
+void RequestEncoder::encodeJsonRpc(std::string& out, uint64_t id, std::string_view accessToken, const EditRequest& request) {
+    encodeJsonRpcOf(out, id, accessToken, request);
+}
+void RequestEncoder::encodeJsonRpc(std::string& out, uint64_t id, std::string_view accessToken, const CancelRequest& request) {
+    encodeJsonRpcOf(out, id, accessToken, request);
+}
+
+// Shortest representation that reads back to the same double
+void RequestEncoder::appendNumber(std::string& out, double value) {
+    char digits[32];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+void RequestEncoder::appendNumber(std::string& out, uint64_t value) {
+    char digits[24];
+    std::to_chars_result result = std::to_chars(digits, digits + sizeof(digits), value);
+    out.append(digits, result.ptr);
+}
+
+// Percent-encode everything outside the RFC 3986 unreserved set
+void RequestEncoder::appendPercentEncoded(std::string& out, std::string_view value) {
+    for (char c : value) {
+        const unsigned char byte = static_cast<unsigned char>(c);
+        if ((byte >= 'A' && byte <= 'Z') || (byte >= 'a' && byte <= 'z') || (byte >= '0' && byte <= '9') ||
+            byte == '-' || byte == '_' || byte == '.' || byte == '~') {
+            out += c;
+        } else {
+            out += '%';
+            out += hexDigits[byte >> 4];
+            out += hexDigits[byte & 0x0F];
+        }
+    }
+}
+
+// Escape quotes, backslashes and control characters for a JSON string
+void RequestEncoder::appendJsonEscaped(std::string& out, std::string_view value) {
+    for (char c : value) {
+        const unsigned char byte = static_cast<unsigned char>(c);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += c;
+        } else if (byte < 0x20) {
+            out.append("\\u00");
+            out += hexDigits[byte >> 4];
+            out += hexDigits[byte & 0x0F];
+        } else {
+            out += c;
+        }
+    }
+}
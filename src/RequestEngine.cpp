@@ -0,0 +1,277 @@
+#include "RequestEngine.h"
+#include "Connection.h"
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+// Constructor configures the multi handle for multiplexing and starts the I/O thread
+RequestEngine::RequestEngine(const std::string& baseUrl, long maxHostConnections, long maxConcurrentStreams)
+    : baseUrl(baseUrl), multi(nullptr), running(true) {
+    multi = curl_multi_init();
+    if (!multi) {
+        throw std::runtime_error("curl_multi_init() failed");
+    }
+
+    // Prefer many HTTP/2 streams on a few connections over many connections
+    curl_multi_setopt(multi, CURLMOPT_PIPELINING, CURLPIPE_MULTIPLEX);
+    curl_multi_setopt(multi, CURLMOPT_MAX_HOST_CONNECTIONS, maxHostConnections);
+    curl_multi_setopt(multi, CURLMOPT_MAX_CONCURRENT_STREAMS, maxConcurrentStreams);
+
+    ioThread = std::thread([this]() { run(); });
+}
+
+// Destructor stops the I/O thread and fails whatever is still queued or in flight
+RequestEngine::~RequestEngine() {
+    running = false;
+    curl_multi_wakeup(multi);
+    if (ioThread.joinable()) {
+        ioThread.join();
+    }
+    for (Transfer* transfer : allTransfers) {
+        curl_easy_cleanup(transfer->curl);
+        if (transfer->headers) {
+            curl_slist_free_all(transfer->headers);
+        }
+        delete transfer;
+    }
+    curl_multi_cleanup(multi);
+}
+
+// Callback function for writing received data to a string
+size_t RequestEngine::WriteCallback(void* contents, size_t size, size_t nmemb, void* userp) {
+    size_t totalSize = size * nmemb;
+    static_cast<std::string*>(userp)->append(static_cast<char*>(contents), totalSize);
+    return totalSize;
+}
+
+// Build the error document handed to callers when a request cannot complete
+rapidjson::Document RequestEngine::errorDocument(const char* message) {
+    rapidjson::Document errorDoc;
+    errorDoc.SetObject();
+    rapidjson::Document::AllocatorType& allocator = errorDoc.GetAllocator();
+    errorDoc.AddMember("error", rapidjson::Value(message, allocator), allocator);
+    return errorDoc;
+}
+
+// Queue a request for the I/O thread, parsing the response into a document
+void RequestEngine::submit(const std::string& target, const std::string& token, Callback callback) {
+    submitRaw(target, token, [callback = std::move(callback)](const char* error, std::string& body) {
+        callback(error ? errorDocument(error) : Connection::parseResponse(body));
+    });
+}
+
+// Queue a request for the I/O thread
+void RequestEngine::submitRaw(const std::string& target, const std::string& token, RawCallback callback) {
+    // Credits are reserved here but never waited for: a throttled transfer is held back by the
+    // I/O thread, and a rejected one completes there like any other
+    std::chrono::nanoseconds wait(0);
+    bool rejected = false;
+    if (RateLimiter* limiter = rateLimiter.load(std::memory_order_relaxed)) {
+        rejected = !limiter->reserve(target, wait);
+    }
+
+    Transfer* transfer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(allMutex);
+        if (!freeTransfers.empty()) {
+            transfer = freeTransfers.back();
+            freeTransfers.pop_back();
+        }
+    }
+    if (!transfer) {
+        transfer = newTransfer();
+        if (!transfer) {
+            std::string noBody;
+            callback("curl_easy_init() failed", noBody);
+            return;
+        }
+    }
+
+    // Reuses the capacity the transfer's URL grew to on earlier requests
+    transfer->url.assign(baseUrl);
+    transfer->url.append(target);
+    transfer->response.clear();
+    transfer->callback = std::move(callback);
+    transfer->rejected = rejected;
+    transfer->startAt = wait.count() > 0 ? Clock::now() + wait : Clock::time_point();
+
+    // Header list is kept with the handle and rebuilt only when the token changes
+    if (!transfer->hasHeaders || transfer->headerToken != token) {
+        if (transfer->headers) {
+            curl_slist_free_all(transfer->headers);
+        }
+        transfer->headers = Connection::buildHeaders(token);
+        transfer->headerToken = token;
+        transfer->hasHeaders = true;
+    }
+
+    curl_easy_setopt(transfer->curl, CURLOPT_URL, transfer->url.c_str());
+    curl_easy_setopt(transfer->curl, CURLOPT_HTTPHEADER, transfer->headers);
+
+    inFlightCount.fetch_add(1, std::memory_order_relaxed);
+    {
+        std::lock_guard<std::mutex> lock(submitMutex);
+        pending.push_back(transfer);
+    }
+    curl_multi_wakeup(multi);
+}
+
+// Queue a request and return a future for its response
+std::future<rapidjson::Document> RequestEngine::submit(const std::string& target, const std::string& token) {
+
+    auto promise = std::make_shared<std::promise<rapidjson::Document>>();
+    std::future<rapidjson::Document> result = promise->get_future();
+    submit(target, token, [promise](rapidjson::Document&& doc) {
+        promise->set_value(std::move(doc));
+    });
+    return result;
+}
+
+// Create a new easy handle configured for the multiplexed connection pool
+RequestEngine::Transfer* RequestEngine::newTransfer() {
+    CURL* curl = curl_easy_init();
+    if (!curl) {
+        return nullptr;
+    }
+    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L);
+    curl_easy_setopt(curl, CURLOPT_HTTP_VERSION, CURL_HTTP_VERSION_2TLS);
+    curl_easy_setopt(curl, CURLOPT_PIPEWAIT, 1L); // Wait for a multiplexed stream instead of opening a connection
+    curl_easy_setopt(curl, CURLOPT_TCP_KEEPALIVE, 1L);
+    curl_easy_setopt(curl, CURLOPT_TCP_NODELAY, 1L);
+    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
+
+    Transfer* transfer = new Transfer();
+    transfer->curl = curl;
+    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &transfer->response);
+    curl_easy_setopt(curl, CURLOPT_PRIVATE, transfer);
+
+    std::lock_guard<std::mutex> lock(allMutex);
+    allTransfers.push_back(transfer);
+    return transfer;
+}
+
+// Return a finished transfer (and its easy handle) for the next request
+void RequestEngine::recycle(Transfer* transfer) {
+    transfer->callback = nullptr;
+    std::lock_guard<std::mutex> lock(allMutex);
+    freeTransfers.push_back(transfer);
+}
+
+// Move newly submitted transfers onto the multi handle, or hold them until the limiter's slot
+void RequestEngine::startPending() {
+    {
+        std::lock_guard<std::mutex> lock(submitMutex);
+        startBatch.swap(pending);
+    }
+    const Clock::time_point now = Clock::now();
+    for (Transfer* transfer : startBatch) {
+        if (transfer->rejected) {
+            inFlightCount.fetch_sub(1, std::memory_order_relaxed);
+            transfer->response.assign(RateLimiter::rejectedResponse);
+            transfer->callback(nullptr, transfer->response);
+            recycle(transfer);
+        } else if (transfer->startAt > now) {
+            delayed.push_back(transfer);
+        } else {
+            start(transfer);
+        }
+    }
+    startBatch.clear();
+
+    // Start held transfers whose slot has come
+    for (size_t i = 0; i < delayed.size();) {
+        if (delayed[i]->startAt <= now) {
+            start(delayed[i]);
+            delayed[i] = delayed.back();
+            delayed.pop_back();
+        } else {
+            ++i;
+        }
+    }
+}
+
+// Add a transfer to the multi handle, failing it if curl refuses
+void RequestEngine::start(Transfer* transfer) {
+    CURLMcode mc = curl_multi_add_handle(multi, transfer->curl);
+    if (mc != CURLM_OK) {
+        inFlightCount.fetch_sub(1, std::memory_order_relaxed);
+        transfer->callback(curl_multi_strerror(mc), transfer->response);
+        recycle(transfer);
+    }
+}
+
+// Poll no longer than until the first held transfer may start
+int RequestEngine::pollTimeoutMs() const {
+    int timeoutMs = 1000;
+    if (!delayed.empty()) {
+        Clock::time_point first = Clock::time_point::max();
+        for (const Transfer* transfer : delayed) {
+            first = std::min(first, transfer->startAt);
+        }
+        const auto remaining = std::chrono::ceil<std::chrono::milliseconds>(first - Clock::now()).count();
+        timeoutMs = static_cast<int>(std::max<int64_t>(0, std::min<int64_t>(remaining, timeoutMs)));
+    }
+    return timeoutMs;
+}
+
+// Hand every finished transfer's response to its callback
+void RequestEngine::completeDone() {
+    int msgsLeft = 0;
+    while (CURLMsg* msg = curl_multi_info_read(multi, &msgsLeft)) {
+        if (msg->msg != CURLMSG_DONE) {
+            continue;
+        }
+        Transfer* transfer = nullptr;
+        curl_easy_getinfo(msg->easy_handle, CURLINFO_PRIVATE, &transfer);
+        CURLcode res = msg->data.result;
+        curl_multi_remove_handle(multi, msg->easy_handle);
+
+        const char* error = nullptr;
+        if (res != CURLE_OK) {
+            std::cerr << "curl_multi transfer failed: " << curl_easy_strerror(res) << std::endl;
+            error = curl_easy_strerror(res);
+        }
+
+        // The body is handed over in place, so the transfer is recycled only after the callback
+        inFlightCount.fetch_sub(1, std::memory_order_relaxed);
+        completedCount.fetch_add(1, std::memory_order_relaxed);
+        transfer->callback(error, transfer->response);
+        recycle(transfer);
+    }
+}
+
+// I/O loop: start queued transfers, drive sockets, complete finished transfers
+void RequestEngine::run() {
+    int stillRunning = 0;
+    while (running) {
+        startPending();
+        CURLMcode mc = curl_multi_perform(multi, &stillRunning);
+        if (mc != CURLM_OK) {
+            std::cerr << "curl_multi_perform() failed: " << curl_multi_strerror(mc) << std::endl;
+        }
+        completeDone();
+        // Sleep until a socket is ready, a held transfer is due, or submit() wakes us up
+        curl_multi_poll(multi, nullptr, 0, pollTimeoutMs(), nullptr);
+    }
+
+    // Fail everything that never completed so no caller waits forever
+    {
+        std::lock_guard<std::mutex> lock(submitMutex);
+        startBatch.swap(pending);
+    }
+    delayed.clear();
+    startBatch.clear();
+    std::vector<Transfer*> active;
+    {
+        std::lock_guard<std::mutex> lock(allMutex);
+        active = allTransfers;
+    }
+    for (Transfer* transfer : active) {
+        if (transfer->callback) {
+            curl_multi_remove_handle(multi, transfer->curl);
+            RawCallback callback = std::move(transfer->callback);
+            inFlightCount.fetch_sub(1, std::memory_order_relaxed);
+            callback("RequestEngine stopped", transfer->response);
+        }
+    }
+}
@@ -0,0 +1,136 @@
+#include "RequestTimings.h"
+#include <functional>
+#include <iomanip>
+
+const char* RequestTimings::stageName(Stage stage) {
+    switch (stage) {
+        case Build: return "build";
+        case Dns: return "dns";
+        case Connect: return "connect";
+        case Tls: return "tls";
+        case FirstByte: return "first_byte";
+        case Transfer: return "transfer";
+        case Parse: return "parse";
+        case Total: return "total";
+        default: return "unknown";
+    }
+}
+
+RequestTimings::RequestTimings() {
+    for (auto& slot : slots) {
+        slot.store(nullptr, std::memory_order_relaxed);
+    }
+}
+
+RequestTimings::~RequestTimings() {
+    for (auto& slot : slots) {
+        delete slot.load(std::memory_order_relaxed);
+    }
+}
+
+std::string_view RequestTimings::endpointOf(std::string_view urlOrTarget) {
+    const size_t query = urlOrTarget.find('?');
+    std::string_view path = urlOrTarget.substr(0, query);
+    const size_t api = path.find("/api/v2/");
+    if (api != std::string_view::npos) {
+        path.remove_prefix(api + 8);
+    }
+    return path;
+}
+
+RequestTimings::Endpoint& RequestTimings::endpoint(std::string_view name) {
+    const size_t hash = std::hash<std::string_view>()(name);
+    Endpoint* created = nullptr;
+    for (size_t probe = 0; probe < Capacity; ++probe) {
+        std::atomic<Endpoint*>& slot = slots[(hash + probe) & (Capacity - 1)];
+        Endpoint* current = slot.load(std::memory_order_acquire);
+        if (!current) {
+            // Claim the empty slot; if another thread won it, check whether it was for this name
+            if (!created) {
+                created = new Endpoint(name);
+            }
+            if (slot.compare_exchange_strong(current, created, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return *created;
+            }
+        }
+        if (current->name == name) {
+            delete created;
+            return *current;
+        }
+    }
+    delete created;
+    return overflow;
+}
+
+void RequestTimings::record(std::string_view name, const Sample& sample) {
+    Endpoint& entry = endpoint(name);
+    for (int stage = 0; stage < StageCount; ++stage) {
+        if (stage == Parse) {
+            continue;
+        }
+        if ((stage == Dns || stage == Connect) && !sample.newConnection) {
+            continue;
+        }
+        if (stage == Tls && !(sample.newConnection && sample.tls)) {
+            continue;
+        }
+        entry.stages[stage].record(sample.ns[stage]);
+    }
+}
+
+std::vector<RequestTimings::StageSummary> RequestTimings::summary() const {
+    std::vector<StageSummary> rows;
+    auto add = [&rows](const Endpoint& entry) {
+        for (int stage = 0; stage < StageCount; ++stage) {
+            const LatencyHistogram& histogram = entry.stages[stage];
+            if (histogram.count() == 0) {
+                continue;
+            }
+            rows.push_back({entry.name, static_cast<Stage>(stage), histogram.count(), histogram.mean(),
+                            histogram.percentile(50), histogram.percentile(90), histogram.percentile(99),
+                            histogram.percentile(99.9), histogram.max(),
+                            entry.errors.load(std::memory_order_relaxed)});
+        }
+    };
+    for (const auto& slot : slots) {
+        if (const Endpoint* entry = slot.load(std::memory_order_acquire)) {
+            add(*entry);
+        }
+    }
+    add(overflow);
+    return rows;
+}
+
+void RequestTimings::write(std::ostream& out) const {
+    const auto flags = out.flags();
+    const auto precision = out.precision();
+    out << std::left << std::setw(36) << "endpoint" << std::setw(12) << "stage" << std::right
+        << std::setw(9) << "count" << std::setw(11) << "mean_us" << std::setw(11) << "p50_us"
+        << std::setw(11) << "p90_us" << std::setw(11) << "p99_us" << std::setw(11) << "p99.9_us"
+        << std::setw(11) << "max_us" << std::setw(8) << "errors" << "\n";
+    out << std::fixed << std::setprecision(1);
+    for (const StageSummary& row : summary()) {
+        out << std::left << std::setw(36) << row.endpoint << std::setw(12) << stageName(row.stage) << std::right
+            << std::setw(9) << row.count << std::setw(11) << row.mean / 1000.0
+            << std::setw(11) << row.p50 / 1000.0 << std::setw(11) << row.p90 / 1000.0
+            << std::setw(11) << row.p99 / 1000.0 << std::setw(11) << row.p999 / 1000.0
+            << std::setw(11) << row.max / 1000.0 << std::setw(8) << row.errors << "\n";
+    }
+    out.flags(flags);
+    out.precision(precision);
+}
+
+void RequestTimings::reset() {
+    auto clear = [](Endpoint& entry) {
+        for (auto& histogram : entry.stages) {
+            histogram.reset();
+        }
+        entry.errors.store(0, std::memory_order_relaxed);
+    };
+    for (auto& slot : slots) {
+        if (Endpoint* entry = slot.load(std::memory_order_acquire)) {
+            clear(*entry);
+        }
+    }
+    clear(overflow);
+}
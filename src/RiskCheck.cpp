@@ -0,0 +1,198 @@
+#include "RiskCheck.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+
+namespace {
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+const char* RiskCheck::toString(Result result) {
+    switch (result) {
+        case Result::Ok: return "ok";
+        case Result::OrderTooLarge: return "order amount exceeds the risk limit";
+        case Result::NotionalTooLarge: return "order notional exceeds the risk limit";
+        case Result::TooManyOpenOrders: return "too many open orders for the instrument";
+        case Result::OutsidePriceBand: return "price is outside the band around the reference price";
+        case Result::MessageRate: return "message rate limit exceeded";
+    }
+    return "unknown";
+}
+
+void RiskCheck::AtomicLimits::store(const Limits& limits) {
+    maxOrderAmount.store(limits.maxOrderAmount, std::memory_order_relaxed);
+    maxNotional.store(limits.maxNotional, std::memory_order_relaxed);
+    maxOpenOrders.store(limits.maxOpenOrders, std::memory_order_relaxed);
+    priceBand.store(limits.priceBand, std::memory_order_relaxed);
+}
+
+RiskCheck::Limits RiskCheck::AtomicLimits::load() const {
+    Limits limits;
+    limits.maxOrderAmount = maxOrderAmount.load(std::memory_order_relaxed);
+    limits.maxNotional = maxNotional.load(std::memory_order_relaxed);
+    limits.maxOpenOrders = maxOpenOrders.load(std::memory_order_relaxed);
+    limits.priceBand = priceBand.load(std::memory_order_relaxed);
+    return limits;
+}
+
+RiskCheck::RiskCheck(const InstrumentCache& instruments)
+    : instruments(instruments), states(new InstrumentState[InstrumentCache::MaxInstruments + 1]) {}
+
+RiskCheck::~RiskCheck() = default;
+
+RiskCheck::InstrumentState& RiskCheck::state(InstrumentId id) {
+    return states[id < InstrumentCache::MaxInstruments ? id : InstrumentCache::MaxInstruments];
+}
+
+const RiskCheck::InstrumentState& RiskCheck::state(InstrumentId id) const {
+    return states[id < InstrumentCache::MaxInstruments ? id : InstrumentCache::MaxInstruments];
+}
+
+void RiskCheck::setDefaultLimits(const Limits& limits) {
+    defaults.store(limits);
+}
+
+// The limits are written before the flag is published, so a check never mixes them with the defaults
+void RiskCheck::setLimits(InstrumentId id, const Limits& limits) {
+    InstrumentState& entry = state(id);
+    entry.limits.store(limits);
+    entry.custom.store(true, std::memory_order_release);
+}
+
+void RiskCheck::clearLimits(InstrumentId id) {
+    state(id).custom.store(false, std::memory_order_release);
+}
+
+RiskCheck::Limits RiskCheck::limits(InstrumentId id) const {
+    const InstrumentState& entry = state(id);
+    return entry.custom.load(std::memory_order_acquire) ? entry.limits.load() : defaults.load();
+}
+
+void RiskCheck::setMessageRate(double perSecond, double burst) {
+    if (perSecond <= 0.0) {
+        messageCostNs.store(0, std::memory_order_relaxed);
+        return;
+    }
+    const int64_t costNs = static_cast<int64_t>(1e9 / perSecond);
+    messageToleranceNs.store(static_cast<int64_t>(costNs * std::max(burst - 1.0, 0.0)), std::memory_order_relaxed);
+    messageArrivalNs.store(0, std::memory_order_relaxed);
+    messageCostNs.store(costNs, std::memory_order_relaxed);
+}
+
+void RiskCheck::setReferencePrice(InstrumentId id, double price) {
+    if (id < InstrumentCache::MaxInstruments) {
+        states[id].reference.store(price, std::memory_order_relaxed);
+    }
+}
+
+double RiskCheck::referencePrice(InstrumentId id) const {
+    return id < InstrumentCache::MaxInstruments ? states[id].reference.load(std::memory_order_relaxed) : 0.0;
+}
+
+// One message's worth of the rate; the arrival time only moves forward by compare-and-swap
+bool RiskCheck::takeMessage() {
+    const int64_t costNs = messageCostNs.load(std::memory_order_relaxed);
+    if (costNs == 0) {
+        return true;
+    }
+    const int64_t toleranceNs = messageToleranceNs.load(std::memory_order_relaxed);
+    const int64_t now = nowNs();
+    int64_t arrival = messageArrivalNs.load(std::memory_order_relaxed);
+    for (;;) {
+        const int64_t start = std::max(arrival, now);
+        if (start - now > toleranceNs) {
+            return false;
+        }
+        if (messageArrivalNs.compare_exchange_weak(arrival, start + costNs, std::memory_order_relaxed)) {
+            return true;
+        }
+    }
+}
+
+RiskCheck::Result RiskCheck::finish(Result result) {
+    results[static_cast<int>(result)].fetch_add(1, std::memory_order_relaxed);
+    return result;
+}
+
+RiskCheck::Result RiskCheck::checkOrder(InstrumentId id, const OrderRequest& request) {
+    InstrumentState& entry = state(id);
+    const Limits limit = entry.custom.load(std::memory_order_acquire) ? entry.limits.load() : defaults.load();
+    const double amount = request.amount.value_or(0.0);
+
+    if (limit.maxOrderAmount > 0.0 && amount > limit.maxOrderAmount) {
+        return finish(Result::OrderTooLarge);
+    }
+
+    const double reference = entry.reference.load(std::memory_order_relaxed);
+    if (limit.maxNotional > 0.0) {
+        // Market orders are valued at the trigger or reference price, and pass if there is neither
+        const InstrumentSpec* spec = instruments.get(id);
+        const double price = request.price ? *request.price : request.triggerPrice ? *request.triggerPrice : reference;
+        const double notional = spec && spec->inverse ? amount : amount * price;
+        if (notional > limit.maxNotional) {
+            return finish(Result::NotionalTooLarge);
+        }
+    }
+
+    if (limit.priceBand > 0.0 && reference > 0.0 && request.price
+        && std::fabs(*request.price - reference) > limit.priceBand * reference) {
+        return finish(Result::OutsidePriceBand);
+    }
+
+    if (!takeMessage()) {
+        return finish(Result::MessageRate);
+    }
+
+    uint32_t open = entry.open.load(std::memory_order_relaxed);
+    do {
+        if (limit.maxOpenOrders > 0 && open >= limit.maxOpenOrders) {
+            return finish(Result::TooManyOpenOrders);
+        }
+    } while (!entry.open.compare_exchange_weak(open, open + 1, std::memory_order_relaxed));
+    return finish(Result::Ok);
+}
+
+RiskCheck::Result RiskCheck::checkMessage() {
+    return finish(takeMessage() ? Result::Ok : Result::MessageRate);
+}
+
+// Stops at zero rather than wrapping, should a slot ever be given back twice
+void RiskCheck::orderClosed(InstrumentId id) {
+    std::atomic<uint32_t>& open = state(id).open;
+    uint32_t current = open.load(std::memory_order_relaxed);
+    while (current > 0 && !open.compare_exchange_weak(current, current - 1, std::memory_order_relaxed)) {
+    }
+}
+
+uint32_t RiskCheck::openOrders(InstrumentId id) const {
+    return state(id).open.load(std::memory_order_relaxed);
+}
+
+uint64_t RiskCheck::rejected() const {
+    uint64_t total = 0;
+    for (int i = 1; i < ResultCount; ++i) {
+        total += results[i].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+void RiskCheck::resetStats() {
+    for (auto& result : results) {
+        result.store(0, std::memory_order_relaxed);
+    }
+}
+
+void RiskCheck::write(std::ostream& out) const {
+    out << "Pre-trade risk checks: " << count(Result::Ok) << " passed, " << rejected() << " rejected\n";
+    for (int i = 1; i < ResultCount; ++i) {
+        const Result result = static_cast<Result>(i);
+        out << "  " << std::left << std::setw(56) << toString(result) << std::right << count(result) << "\n";
+    }
+    out << std::flush;
+}
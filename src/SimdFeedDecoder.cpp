@@ -0,0 +1,194 @@
+#include "SimdFeedDecoder.h"
+
+#ifdef GOQUANT_WITH_SIMDJSON
+#include <simdjson.h>
+#include <cstring>
+#include <vector>
+
+namespace ondemand = simdjson::ondemand;
+
+struct SimdFeedDecoder::Impl {
+    ondemand::parser parser; // Its buffers are sized by the largest frame seen, then reused
+    std::vector<char> padded; // Copy of a frame without spare capacity; only grows
+};
+
+namespace {
+
+// Read one side of a book notification: an array of ["new"|"change"|"delete", price, amount]
+bool decodeSide(ondemand::value& side, std::vector<LevelUpdate>& updates) {
+    ondemand::array entries;
+    if (side.get_array().get(entries)) {
+        return false;
+    }
+    for (auto entryResult : entries) {
+        ondemand::array entry;
+        if (entryResult.get_array().get(entry)) {
+            return false;
+        }
+        LevelUpdate update;
+        size_t position = 0;
+        for (auto elementResult : entry) {
+            ondemand::value element;
+            if (elementResult.get(element)) {
+                return false;
+            }
+            switch (position++) {
+                case 0: {
+                    // The first byte tells the actions apart, so the string is not unescaped
+                    ondemand::raw_json_string action;
+                    if (element.get_raw_json_string().get(action)) {
+                        return false;
+                    }
+                    switch (action.raw()[0]) {
+                        case 'n': update.action = LevelUpdate::Action::New; break;
+                        case 'c': update.action = LevelUpdate::Action::Change; break;
+                        case 'd': update.action = LevelUpdate::Action::Delete; break;
+                        default: return false;
+                    }
+                    break;
+                }
+                case 1:
+                    if (element.get_double().get(update.price)) {
+                        return false;
+                    }
+                    break;
+                case 2:
+                    if (element.get_double().get(update.amount)) {
+                        return false;
+                    }
+                    break;
+                default:
+                    return false;
+            }
+        }
+        if (position != 3) {
+            return false;
+        }
+        updates.push_back(update);
+    }
+    return true;
+}
+
+// Fill delta from params.data in a single pass over its fields, in whatever order they come
+bool decodeData(ondemand::value& value, BookDelta& delta) {
+    ondemand::object data;
+    if (value.get_object().get(data)) {
+        return false;
+    }
+    delta.snapshot = false;
+    delta.timestamp = 0;
+    delta.prevChangeId = 0;
+    delta.bids.clear(); // A side with no changes may be omitted
+    delta.asks.clear();
+    bool haveChangeId = false;
+    bool haveInstrument = false;
+
+    for (auto fieldResult : data) {
+        ondemand::field field;
+        if (std::move(fieldResult).get(field)) {
+            return false;
+        }
+        const std::string_view key = field.escaped_key();
+        ondemand::value& fieldValue = field.value();
+        if (key == "bids" || key == "asks") {
+            if (!decodeSide(fieldValue, key == "bids" ? delta.bids : delta.asks)) {
+                return false;
+            }
+        } else if (key == "change_id") {
+            if (fieldValue.get_int64().get(delta.changeId)) {
+                return false;
+            }
+            haveChangeId = true;
+        } else if (key == "prev_change_id") {
+            if (fieldValue.get_int64().get(delta.prevChangeId)) {
+                return false;
+            }
+        } else if (key == "timestamp") {
+            if (fieldValue.get_int64().get(delta.timestamp)) {
+                return false;
+            }
+        } else if (key == "instrument_name") {
+            std::string_view instrument;
+            if (fieldValue.get_string().get(instrument)) {
+                return false;
+            }
+            delta.instrument.assign(instrument.data(), instrument.size());
+            haveInstrument = true;
+        } else if (key == "type") {
+            std::string_view type;
+            if (fieldValue.get_string().get(type)) {
+                return false;
+            }
+            delta.snapshot = type == "snapshot";
+        }
+        // Anything else is skipped without being parsed
+    }
+    return haveChangeId && haveInstrument;
+}
+
+} // namespace
+
+bool SimdFeedDecoder::available() {
+    return true;
+}
+
+bool SimdFeedDecoder::decodeBook(std::string& frame, std::string_view& channel, BookDelta& delta) {
+    const char* input = frame.data();
+    size_t capacity = frame.capacity();
+    if (capacity - frame.size() < simdjson::SIMDJSON_PADDING) {
+        std::vector<char>& padded = impl->padded;
+        if (padded.size() < frame.size() + simdjson::SIMDJSON_PADDING) {
+            padded.resize(frame.size() + simdjson::SIMDJSON_PADDING);
+        }
+        std::memcpy(padded.data(), frame.data(), frame.size());
+        input = padded.data();
+        capacity = padded.size();
+    }
+    ondemand::document document;
+    if (impl->parser.iterate(input, frame.size(), capacity).get(document)) {
+        return false;
+    }
+    ondemand::object params;
+    if (document["params"].get_object().get(params)) {
+        return false;
+    }
+
+    channel = std::string_view();
+    bool haveData = false;
+    for (auto fieldResult : params) {
+        ondemand::field field;
+        if (std::move(fieldResult).get(field)) {
+            return false;
+        }
+        const std::string_view key = field.escaped_key();
+        if (key == "channel") {
+            if (field.value().get_string().get(channel)) {
+                return false;
+            }
+        } else if (key == "data") {
+            if (!decodeData(field.value(), delta)) {
+                return false;
+            }
+            haveData = true;
+        }
+    }
+    return haveData && channel.compare(0, 5, "book.") == 0;
+}
+
+#else
+
+struct SimdFeedDecoder::Impl {};
+
+bool SimdFeedDecoder::available() {
+    return false;
+}
+
+bool SimdFeedDecoder::decodeBook(std::string&, std::string_view&, BookDelta&) {
+    return false;
+}
+
+#endif // GOQUANT_WITH_SIMDJSON
+
+SimdFeedDecoder::SimdFeedDecoder() : impl(std::make_unique<Impl>()) {}
+
+SimdFeedDecoder::~SimdFeedDecoder() = default;
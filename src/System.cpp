@@ -1,149 +1,602 @@
 #include "System.h"
 #include "rapidjson/document.h"
 #include <iostream>
+#include <map>
 #include <unordered_map>
-#include "utils.h" 
+#include "Utils.h" 
+#include "WebSocketClient.h"
+#include "OrderResponseDecoder.h"
 #include <future>
+#include <stdexcept>
+#include <type_traits>
 
 // Constructor initializes the connection, trading object, and thread pool
 System::System(Connection& conn, size_t threadCount) :
     conn(conn),
     trading(conn),
-    threadPool(threadCount) {}
+    threadPool(threadCount),
+    amends([this](const EditRequest& request, const std::string& token, Trading::ResultCallback onResult) {
+        modifyOrderAsync(request, token, std::move(onResult));
+    }, [this](std::function<void()> work) {
+        threadPool.post(std::move(work));
+    }) {}
+
+// Engine and pool callbacks settle orders against riskCheck, orders and orderTracker, which are
+// declared after them and so destroyed first; stop both while everything they use is alive.
+// The engine goes first: it fails its in-flight transfers through those callbacks, which may
+// still post to the pool.
+System::~System() {
+    stopTrackingOrders();
+    stopTrackingPositions();
+    amends.wait();
+    trading.setEngine(nullptr);
+    engine.reset();
+    threadPool.shutdown();
+}
+
+// The curl_multi engine, started by whichever caller needs it first
+RequestEngine& System::startEngine() {
+    std::call_once(engineStarted, [this]() {
+        engine = std::make_unique<RequestEngine>(conn.getBaseUrl());
+        engine->setRateLimiter(conn.getRateLimiter());
+        trading.setEngine(engine.get());
+    });
+    return *engine;
+}
+
+// Select the backend used by the *Async calls; the curl_multi engine is started on first use
+void System::setAsyncBackend(AsyncBackend backend) {
+    if (backend == AsyncBackend::CurlMulti) {
+        startEngine();
+    }
+    asyncBackend = backend;
+}
+
+// Share one limiter between the connection and the curl_multi engine, since both draw on the same account's credits
+void System::setRateLimiter(RateLimiter* limiter) {
+    conn.setRateLimiter(limiter);
+    if (engine) {
+        engine->setRateLimiter(limiter);
+    }
+}
+
+// Start following the account's orders on client; a running tracker is replaced
+bool System::trackOrders(WebSocketClient& client, OrderTracker::TokenSource token, std::chrono::seconds reconcileInterval) {
+    stopTrackingOrders();
+    // Resting orders give their risk slot back when the feed reports them closed; orders placed
+    // elsewhere, or before tracking started, were never counted here and are ignored
+    orders.setCloseHandler([this](const OrderRecord& record) {
+        releaseCounted(record.orderId);
+    });
+    orderTracker = std::make_unique<OrderTracker>(trading, orders, std::move(token), reconcileInterval);
+    if (!orderTracker->start(client)) {
+        stopTrackingOrders();
+        return false;
+    }
+    return true;
+}
+
+void System::stopTrackingOrders() {
+    if (orderTracker) {
+        orderTracker->stop();
+        orderTracker.reset();
+    }
+    orders.setCloseHandler(nullptr);
+}
+
+// Handlers go in before the subscriptions, so no change after them is missed. The REST seed
+// can still answer with a snapshot older than a notification already applied; it is applied
+// with the mark taken before its request, so it skips instruments and currencies updated since.
+bool System::trackPositions(WebSocketClient& client, const std::string& token, const std::vector<std::string>& currencies) {
+    stopTrackingPositions();
+    PositionCache& cache = positionStore;
+    changesHandler = client.addChannelHandler("user.changes.", [&cache](std::string_view, const rapidjson::Value& data) {
+        cache.applyChanges(data);
+    });
+    portfolioHandler = client.addChannelHandler("user.portfolio.", [&cache](std::string_view, const rapidjson::Value& data) {
+        cache.applyPortfolio(data);
+    });
+    positionClient = &client;
+
+    std::vector<std::string> channels{"user.changes.any.any.raw"};
+    for (const std::string& currency : currencies) {
+        channels.push_back("user.portfolio." + currency);
+    }
+    if (!client.subscribe(channels, token)) {
+        std::cerr << "Failed to start position tracking" << std::endl;
+        stopTrackingPositions();
+        return false;
+    }
+
+    const uint64_t positionsMark = positionStore.seedMark();
+    rapidjson::Document positions = trading.getPositions(token);
+    if (positions.IsObject() && positions.HasMember("result")) {
+        positionStore.applyPositions(positions["result"], positionsMark);
+    }
+    for (const std::string& currency : currencies) {
+        const uint64_t summaryMark = positionStore.seedMark();
+        rapidjson::Document summary = trading.getAccountSummary(token, currency);
+        if (summary.IsObject() && summary.HasMember("result")) {
+            positionStore.applyPortfolio(summary["result"], summaryMark);
+        }
+    }
+    return true;
+}
+
+void System::stopTrackingPositions() {
+    if (positionClient) {
+        positionClient->removeChannelHandler(changesHandler);
+        positionClient->removeChannelHandler(portfolioHandler);
+        positionClient = nullptr;
+    }
+}
+
+// A cached position, named as in the exchange's position object
+static void positionToJson(const PositionCache::Position& position, rapidjson::Value& out, rapidjson::Document::AllocatorType& allocator) {
+    out.SetObject();
+    out.AddMember("instrument_name", rapidjson::Value(position.instrument, allocator), allocator);
+    out.AddMember("size", position.size, allocator);
+    out.AddMember("direction", rapidjson::StringRef(position.size > 0 ? "buy" : position.size < 0 ? "sell" : "zero"), allocator);
+    out.AddMember("average_price", position.averagePrice, allocator);
+    out.AddMember("mark_price", position.markPrice, allocator);
+    out.AddMember("floating_profit_loss", position.floatingPnl, allocator);
+    out.AddMember("realized_profit_loss", position.realizedPnl, allocator);
+    out.AddMember("initial_margin", position.initialMargin, allocator);
+    out.AddMember("maintenance_margin", position.maintenanceMargin, allocator);
+    out.AddMember("delta", position.delta, allocator);
+}
+
+// The fields of a cached order, named as in the exchange's order object
+static void orderToJson(const OrderRecord& record, rapidjson::Value& out, rapidjson::Document::AllocatorType& allocator) {
+    out.SetObject();
+    out.AddMember("order_id", rapidjson::Value(record.orderId.c_str(), allocator), allocator);
+    out.AddMember("instrument_name", rapidjson::Value(record.instrument.c_str(), allocator), allocator);
+    out.AddMember("direction", rapidjson::StringRef(record.buy ? "buy" : "sell"), allocator);
+    out.AddMember("order_type", rapidjson::Value(record.orderType.c_str(), allocator), allocator);
+    out.AddMember("order_state", rapidjson::StringRef(toString(record.state)), allocator);
+    out.AddMember("label", rapidjson::Value(record.label.c_str(), allocator), allocator);
+    out.AddMember("amount", record.amount, allocator);
+    out.AddMember("price", record.price, allocator);
+    out.AddMember("filled_amount", record.filledAmount, allocator);
+    out.AddMember("average_price", record.averagePrice, allocator);
+    out.AddMember("creation_timestamp", record.created, allocator);
+    out.AddMember("last_update_timestamp", record.updated, allocator);
+}
+
+// WebSocket for Transport::WebSocket calls, which all block on the response
+WebSocketClient& System::requireWebSocket() {
+    if (!webSocket || !webSocket->isConnected()) {
+        throw std::runtime_error("No connected WebSocket attached to System");
+    }
+    if (webSocket->onListenerThread()) {
+        throw std::logic_error("Blocking WebSocket order call from the listener thread would never complete; use a callback call");
+    }
+    return *webSocket;
+}
+
+// Local failures are reported as {"error": "<message>"}, like the other pre-send errors
+static rapidjson::Document localError(const char* message) {
+    rapidjson::Document errorDoc;
+    errorDoc.SetObject();
+    errorDoc.AddMember("error", rapidjson::StringRef(message), errorDoc.GetAllocator());
+    return errorDoc;
+}
+
+// Instrument and risk checks of a new order: null if it may be sent, otherwise why not.
+// On success the order holds one of its instrument's open-order slots until settleOrder().
+const char* System::preTradeCheck(const OrderRequest& request, InstrumentId& id)
+{
+    id = request.instrumentId != NoInstrumentId ? request.instrumentId : instrumentCache.find(request.instrument);
+    const InstrumentCache::Check check = instrumentCache.check(request, id);
+    if (check != InstrumentCache::Check::Ok) {
+        return InstrumentCache::toString(check);
+    }
+    const RiskCheck::Result risk = riskCheck.checkOrder(id, request);
+    return risk == RiskCheck::Result::Ok ? nullptr : RiskCheck::toString(risk);
+}
+
+// Give the slot back for an order that never rested. While orders are tracked, one left resting
+// is counted by id and released by the feed when it closes. Its close may have been applied
+// before this response arrived, so the store is checked once it is counted.
+void System::settleOrder(InstrumentId id, bool accepted, OrderResult::State state, std::string_view orderId)
+{
+    const bool done = state == OrderResult::State::Filled || state == OrderResult::State::Cancelled ||
+                      state == OrderResult::State::Rejected;
+    if (!accepted || done) {
+        riskCheck.orderClosed(id);
+        return;
+    }
+    if (!isTrackingOrders() || orderId.empty()) {
+        return;
+    }
+    const std::string key(orderId);
+    {
+        std::lock_guard<std::mutex> lock(countedMutex);
+        countedOrders.emplace(key, id);
+    }
+    // Not under countedMutex: the close handler takes it under the store's lock
+    OrderRecord record;
+    if (orders.find(key, record) && !record.isOpen() && record.state != OrderResult::State::Unknown) {
+        releaseCounted(key);
+    }
+}
+
+// Give back the slot of a counted order, at most once however many times it is reported closed
+void System::releaseCounted(const std::string& orderId)
+{
+    InstrumentId id = NoInstrumentId;
+    {
+        std::lock_guard<std::mutex> lock(countedMutex);
+        auto it = countedOrders.find(orderId);
+        if (it == countedOrders.end()) {
+            return;
+        }
+        id = it->second;
+        countedOrders.erase(it);
+    }
+    riskCheck.orderClosed(id);
+}
+
+void System::settleOrder(InstrumentId id, const rapidjson::Document& response)
+{
+    OrderResult::State state = OrderResult::State::Unknown;
+    std::string_view orderId;
+    const bool accepted = response.IsObject() && response.HasMember("result");
+    if (accepted && response["result"].IsObject() && response["result"].HasMember("order")) {
+        const rapidjson::Value& order = response["result"]["order"];
+        if (order.IsObject() && order.HasMember("order_state") && order["order_state"].IsString()) {
+            state = orderStateOf(order["order_state"].GetString());
+        }
+        if (order.IsObject() && order.HasMember("order_id") && order["order_id"].IsString()) {
+            orderId = std::string_view(order["order_id"].GetString(), order["order_id"].GetStringLength());
+        }
+    }
+    settleOrder(id, accepted, state, orderId);
+}
 
 // Place a single order synchronously
-rapidjson::Document System::placeOrder(const std::string &token, const std::string &instrument, const std::string &type, double amount, double price, const std::string &label)
+rapidjson::Document System::placeOrder(const std::string &token, const std::string &instrument, const std::string &type, double amount, double price, const std::string &label, Transport transport)
+{
+    std::optional<BuyRequest> request = Trading::buyRequest(instrument, type, amount, price, label);
+    if (!request) {
+        return rapidjson::Document();
+    }
+    return placeOrder(*request, token, transport);
+}
+
+// Send a typed buy request on the chosen transport
+rapidjson::Document System::placeOrder(const BuyRequest& request, const std::string& token, Transport transport)
+{
+    InstrumentId id = NoInstrumentId;
+    if (const char* refused = preTradeCheck(request, id)) {
+        return localError(refused);
+    }
+    rapidjson::Document response;
+    try {
+        response = transport == Transport::WebSocket ? requireWebSocket().buy(request).get()
+                                                     : trading.placeOrder(request, token);
+    } catch (...) {
+        riskCheck.orderClosed(id);
+        throw;
+    }
+    settleOrder(id, response);
+    return response;
+}
+
+// Start a batch: bulk-queued on the pool, where each request checks for cancel() before it is
+// sent, or handed to the curl_multi engine in one go
+OrderBatch System::runBatch(size_t count, const std::string& token, OrderBatch::Callback onResult, BatchCall call, BatchSubmit submit)
+{
+    auto state = std::make_shared<OrderBatch::State>(count, token, std::move(onResult));
+    if (asyncBackend == AsyncBackend::ThreadPool) {
+        threadPool.bulk(count, [state, call](size_t i) {
+            OrderResult result;
+            if (state->cancelled.load(std::memory_order_relaxed)) {
+                OrderResponseDecoder::setLocalError(result, "batch cancelled before the request was sent");
+            } else {
+                try {
+                    call(i, state->token, result);
+                } catch (const std::exception& e) {
+                    OrderResponseDecoder::setLocalError(result, e.what());
+                }
+            }
+            state->complete(i, result);
+        }, state->poolChunks);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            submit(i, state->token, [state, i](const OrderResult& result) { state->complete(i, result); });
+        }
+    }
+    return OrderBatch(state);
+}
+
+// Same checks and open-order accounting as the blocking typed calls, completed on the I/O thread
+template<typename Request>
+void System::submitOrder(const Request& request, const std::string& token, Trading::ResultCallback onResult)
+{
+    startEngine();
+    InstrumentId id = NoInstrumentId;
+    if (const char* refused = preTradeCheck(request, id)) {
+        OrderResult result;
+        OrderResponseDecoder::setLocalError(result, refused);
+        onResult(result);
+        return;
+    }
+    auto settle = [this, id, onResult = std::move(onResult)](const OrderResult& result) {
+        settleOrder(id, result.ok(), result.state, result.id());
+        onResult(result);
+    };
+    if constexpr (std::is_same_v<Request, BuyRequest>) {
+        trading.placeOrderAsync(request, token, std::move(settle));
+    } else {
+        trading.sellOrderAsync(request, token, std::move(settle));
+    }
+}
+
+void System::placeOrderAsync(const BuyRequest& request, const std::string& token, Trading::ResultCallback onResult)
 {
-    return trading.placeOrder(token, instrument, type, amount, price, label);
+    submitOrder(request, token, std::move(onResult));
 }
 
-// Place multiple orders asynchronously using a thread pool
+void System::sellOrderAsync(const SellRequest& request, const std::string& token, Trading::ResultCallback onResult)
+{
+    submitOrder(request, token, std::move(onResult));
+}
+
+void System::modifyOrderAsync(const EditRequest& request, const std::string& token, Trading::ResultCallback onResult)
+{
+    if (riskCheck.checkMessage() != RiskCheck::Result::Ok) {
+        OrderResult result;
+        OrderResponseDecoder::setLocalError(result, RiskCheck::toString(RiskCheck::Result::MessageRate));
+        onResult(result);
+        return;
+    }
+    startEngine();
+    trading.modifyOrderAsync(request, token, std::move(onResult));
+}
+
+void System::amendOrder(const EditRequest& request, const std::string& token, Trading::ResultCallback onResult)
+{
+    amends.modify(request, token, std::move(onResult));
+}
+
+void System::cancelOrderAsync(const CancelRequest& request, const std::string& token, Trading::ResultCallback onResult)
+{
+    startEngine();
+    trading.cancelOrderAsync(request, token, std::move(onResult));
+}
+
+OrderBatch System::placeOrders(const std::vector<BuyRequest>& requests, const std::string& token, OrderBatch::Callback onResult)
+{
+    auto batch = std::make_shared<const std::vector<BuyRequest>>(requests);
+    return runBatch(batch->size(), token, std::move(onResult),
+        [this, batch](size_t i, const std::string& token, OrderResult& result) { placeOrder((*batch)[i], token, result); },
+        [this, batch](size_t i, const std::string& token, Trading::ResultCallback onResult) {
+            placeOrderAsync((*batch)[i], token, std::move(onResult));
+        });
+}
+
+OrderBatch System::sellOrders(const std::vector<SellRequest>& requests, const std::string& token, OrderBatch::Callback onResult)
+{
+    auto batch = std::make_shared<const std::vector<SellRequest>>(requests);
+    return runBatch(batch->size(), token, std::move(onResult),
+        [this, batch](size_t i, const std::string& token, OrderResult& result) { sellOrder((*batch)[i], token, result); },
+        [this, batch](size_t i, const std::string& token, Trading::ResultCallback onResult) {
+            sellOrderAsync((*batch)[i], token, std::move(onResult));
+        });
+}
+
+OrderBatch System::cancelOrders(const std::vector<CancelRequest>& requests, const std::string& token, OrderBatch::Callback onResult)
+{
+    auto batch = std::make_shared<const std::vector<CancelRequest>>(requests);
+    return runBatch(batch->size(), token, std::move(onResult),
+        [this, batch](size_t i, const std::string& token, OrderResult& result) { cancelOrder((*batch)[i], token, result); },
+        [this, batch](size_t i, const std::string& token, Trading::ResultCallback onResult) {
+            cancelOrderAsync((*batch)[i], token, std::move(onResult));
+        });
+}
+
+// Place multiple orders asynchronously on the selected backend
 std::vector<rapidjson::Document> System::placeOrdersAsync(
     const std::string& token,
     const std::vector<std::tuple<std::string, std::string, double, double, std::string>>& orderParams) {
 
-    std::vector<std::future<rapidjson::Document>> futures;
-    futures.reserve(orderParams.size());
-
-    for (const auto& params : orderParams) {
-        // Capture variables by reference in lambda for efficiency
-        futures.push_back(threadPool.enqueue([this, token, params]() mutable -> rapidjson::Document { 
+    // Thread pool: each call writes its response into its own slot, so no future or shared state per order
+    if (asyncBackend == AsyncBackend::ThreadPool) {
+        std::vector<rapidjson::Document> results(orderParams.size());
+        WaitGroup done;
+        threadPool.bulk(orderParams.size(), [this, &token, &orderParams, &results](size_t i) {
             try {
-                const auto& [instrument, type, amount, price, label] = params;
-                return placeOrder(token, instrument, type, amount, price, label); 
+                const auto& [instrument, type, amount, price, label] = orderParams[i];
+                results[i] = placeOrder(token, instrument, type, amount, price, label);
             } catch (const std::exception& e) {
                 std::cerr << "Error placing order: " << e.what() << std::endl;
-                rapidjson::Document errorDoc;
-                errorDoc.SetObject();
-                rapidjson::Document::AllocatorType& allocator = errorDoc.GetAllocator();
-                errorDoc.AddMember("error", rapidjson::StringRef(e.what()), allocator);
-                return errorDoc; 
+                results[i] = rapidjson::Document();
+                results[i].SetObject();
+                results[i].AddMember("error", rapidjson::Value(e.what(), results[i].GetAllocator()), results[i].GetAllocator());
             }
-        }));
+        }, done);
+        done.wait();
+        return results;
     }
 
-    std::vector<rapidjson::Document> results;
-    results.reserve(futures.size());
+    // Event-driven path: every order that passes the checks is in flight at once on the
+    // engine's connections; refused ones get their local error without being sent
+    std::vector<rapidjson::Document> results(orderParams.size());
+    std::vector<std::future<rapidjson::Document>> futures(orderParams.size());
+    std::vector<InstrumentId> ids(orderParams.size(), NoInstrumentId);
+    for (size_t i = 0; i < orderParams.size(); ++i) {
+        const auto& [instrument, type, amount, price, label] = orderParams[i];
+        std::optional<BuyRequest> request = Trading::buyRequest(instrument, type, amount, price, label);
+        if (!request) {
+            continue; // Empty document, as from placeOrder()
+        }
+        if (const char* refused = preTradeCheck(*request, ids[i])) {
+            results[i] = localError(refused);
+            continue;
+        }
+        futures[i] = trading.placeOrderAsync(*request, token);
+    }
+    collectOrders(futures, ids, results);
+    return results;
+}
 
-    for (auto& future : futures) {
+// Wait for the orders a fan-out sent and settle each one's open-order slot
+void System::collectOrders(std::vector<std::future<rapidjson::Document>>& futures, const std::vector<InstrumentId>& ids,
+                           std::vector<rapidjson::Document>& results)
+{
+    for (size_t i = 0; i < futures.size(); ++i) {
+        if (!futures[i].valid()) {
+            continue; // Not sent
+        }
         try {
-            results.emplace_back(std::move(future.get())); // Use emplace_back with move for efficiency
+            results[i] = futures[i].get();
+            settleOrder(ids[i], results[i]);
         } catch (const std::exception& e) {
             std::cerr << "Error retrieving order result: " << e.what() << std::endl;
-            rapidjson::Document errorDoc;
-            errorDoc.SetObject();
-            rapidjson::Document::AllocatorType& allocator = errorDoc.GetAllocator();
-            errorDoc.AddMember("error", rapidjson::StringRef(e.what()), allocator);
-            results.emplace_back(std::move(errorDoc)); 
+            riskCheck.orderClosed(ids[i]);
+            results[i] = rapidjson::Document();
+            results[i].SetObject();
+            results[i].AddMember("error", rapidjson::Value(e.what(), results[i].GetAllocator()), results[i].GetAllocator());
         }
     }
-
-    return results;
 }
 
 // Modify an existing order
-rapidjson::Document System::modifyOrder(const std::string &order_id, const std::string &token, const std::optional<double> &amount, const std::optional<double> &contracts, const std::optional<double> &price, const std::optional<std::string> &advanced, const std::optional<bool> &post_only, const std::optional<bool> &reduce_only)
+rapidjson::Document System::modifyOrder(const std::string &order_id, const std::string &token, const std::optional<double> &amount, const std::optional<double> &contracts, const std::optional<double> &price, const std::optional<std::string> &advanced, const std::optional<bool> &post_only, const std::optional<bool> &reduce_only, Transport transport)
 {
-    return trading.modifyOrder(order_id, token, amount, contracts, price, advanced, post_only, reduce_only);
+    return modifyOrder(Trading::editRequest(order_id, amount, contracts, price, advanced, post_only, reduce_only), token, transport);
+}
+
+// Send a typed edit request on the chosen transport
+rapidjson::Document System::modifyOrder(const EditRequest& request, const std::string& token, Transport transport)
+{
+    if (riskCheck.checkMessage() != RiskCheck::Result::Ok) {
+        return localError(RiskCheck::toString(RiskCheck::Result::MessageRate));
+    }
+    if (transport == Transport::WebSocket) {
+        return requireWebSocket().edit(request).get();
+    }
+    return trading.modifyOrder(request, token);
 }
 
 // Place a single sell order synchronously
-rapidjson::Document System::sellOrder(const std::string &token, const std::string &instrument, const std::optional<double> &amount, const std::optional<double> &contracts, const std::optional<double> &price, const std::optional<std::string> &type, const std::optional<std::string> &trigger, const std::optional<double> &trigger_price)
+rapidjson::Document System::sellOrder(const std::string &token, const std::string &instrument, const std::optional<double> &amount, const std::optional<double> &contracts, const std::optional<double> &price, const std::optional<std::string> &type, const std::optional<std::string> &trigger, const std::optional<double> &trigger_price, Transport transport)
 {
-    return trading.sellOrder(token, instrument, amount, contracts, price, type, trigger, trigger_price);
+    std::optional<SellRequest> request = Trading::sellRequest(instrument, amount, contracts, price, type, trigger, trigger_price);
+    if (!request) {
+        return rapidjson::Document();
+    }
+    return sellOrder(*request, token, transport);
+}
+
+// Send a typed sell request on the chosen transport
+rapidjson::Document System::sellOrder(const SellRequest& request, const std::string& token, Transport transport)
+{
+    InstrumentId id = NoInstrumentId;
+    if (const char* refused = preTradeCheck(request, id)) {
+        return localError(refused);
+    }
+    rapidjson::Document response;
+    try {
+        response = transport == Transport::WebSocket ? requireWebSocket().sell(request).get()
+                                                     : trading.sellOrder(request, token);
+    } catch (...) {
+        riskCheck.orderClosed(id);
+        throw;
+    }
+    settleOrder(id, response);
+    return response;
 }
 
-// Place multiple sell orders asynchronously using a thread pool
+// Place multiple sell orders asynchronously on the selected backend
 std::vector<rapidjson::Document> System::sellOrdersAsync(
     const std::string& token,
     const std::vector<std::tuple<std::string, std::optional<double>, std::optional<double>, std::optional<double>, std::optional<std::string>, std::optional<std::string>, std::optional<double>>>& orderParams) {
 
-    std::vector<std::future<rapidjson::Document>> futures;
-    futures.reserve(orderParams.size());
-
-    for (const auto& params : orderParams) {
-        futures.push_back(threadPool.enqueue([this, token, params]() mutable -> rapidjson::Document { 
+    // Thread pool: each call writes its response into its own slot, so no future or shared state per order
+    if (asyncBackend == AsyncBackend::ThreadPool) {
+        std::vector<rapidjson::Document> results(orderParams.size());
+        WaitGroup done;
+        threadPool.bulk(orderParams.size(), [this, &token, &orderParams, &results](size_t i) {
             try {
-                const auto& [instrument, amount, contracts, price, type, trigger, trigger_price] = params;
-                return sellOrder(token, instrument, amount, contracts, price, type, trigger, trigger_price); 
+                const auto& [instrument, amount, contracts, price, type, trigger, trigger_price] = orderParams[i];
+                results[i] = sellOrder(token, instrument, amount, contracts, price, type, trigger, trigger_price);
             } catch (const std::exception& e) {
                 std::cerr << "Error placing sell order: " << e.what() << std::endl;
-                rapidjson::Document errorDoc;
-                errorDoc.SetObject();
-                rapidjson::Document::AllocatorType& allocator = errorDoc.GetAllocator();
-                errorDoc.AddMember("error", rapidjson::StringRef(e.what()), allocator);
-                return errorDoc; 
+                results[i] = rapidjson::Document();
+                results[i].SetObject();
+                results[i].AddMember("error", rapidjson::Value(e.what(), results[i].GetAllocator()), results[i].GetAllocator());
             }
-        }));
+        }, done);
+        done.wait();
+        return results;
     }
 
-    std::vector<rapidjson::Document> results;
-    results.reserve(futures.size());
-
-    for (auto& future : futures) {
-        try {
-            results.push_back(std::move(future.get())); // Use std::move to avoid unnecessary copies
-        } catch (const std::exception& e) {
-            std::cerr << "Error retrieving sell order result: " << e.what() << std::endl;
-            rapidjson::Document errorDoc;
-            errorDoc.SetObject();
-            rapidjson::Document::AllocatorType& allocator = errorDoc.GetAllocator();
-            errorDoc.AddMember("error", rapidjson::StringRef(e.what()), allocator);
-            results.emplace_back(std::move(errorDoc)); 
+    // Event-driven path, checked like placeOrdersAsync()
+    std::vector<rapidjson::Document> results(orderParams.size());
+    std::vector<std::future<rapidjson::Document>> futures(orderParams.size());
+    std::vector<InstrumentId> ids(orderParams.size(), NoInstrumentId);
+    for (size_t i = 0; i < orderParams.size(); ++i) {
+        const auto& [instrument, amount, contracts, price, type, trigger, trigger_price] = orderParams[i];
+        std::optional<SellRequest> request = Trading::sellRequest(instrument, amount, contracts, price, type, trigger, trigger_price);
+        if (!request) {
+            continue; // Empty document, as from sellOrder()
         }
+        if (const char* refused = preTradeCheck(*request, ids[i])) {
+            results[i] = localError(refused);
+            continue;
+        }
+        futures[i] = trading.sellOrderAsync(*request, token);
     }
-
+    collectOrders(futures, ids, results);
     return results;
 }
 
 // Cancel a single order synchronously
-rapidjson::Document System::cancelOrder(const std::string &orderid, const std::string &token)
+rapidjson::Document System::cancelOrder(const std::string &orderid, const std::string &token, Transport transport)
+{
+    return cancelOrder(CancelRequest{orderid}, token, transport);
+}
+
+// Send a typed cancel request on the chosen transport
+rapidjson::Document System::cancelOrder(const CancelRequest& request, const std::string& token, Transport transport)
 {
-    return trading.cancelOrder(orderid, token);
+    if (transport == Transport::WebSocket) {
+        return requireWebSocket().cancel(request).get();
+    }
+    return trading.cancelOrder(request, token);
 }
 
-// Cancel multiple orders asynchronously using a thread pool
+// Cancel multiple orders asynchronously on the selected backend
 std::vector<rapidjson::Document> System::cancelOrdersAsync(
     const std::vector<std::string>& orderParams,
     const std::string& token) {
 
-    std::vector<std::future<rapidjson::Document>> futures;
-    futures.reserve(orderParams.size());
-
-    for (const auto& params : orderParams) {
-        futures.push_back(threadPool.enqueue([this, token, params]() mutable -> rapidjson::Document { 
+    // Thread pool: each call writes its response into its own slot, so no future or shared state per order
+    if (asyncBackend == AsyncBackend::ThreadPool) {
+        std::vector<rapidjson::Document> results(orderParams.size());
+        WaitGroup done;
+        threadPool.bulk(orderParams.size(), [this, &token, &orderParams, &results](size_t i) {
             try {
-                const auto& orderid = params;
-                return cancelOrder(orderid, token); 
+                results[i] = cancelOrder(orderParams[i], token);
             } catch (const std::exception& e) {
                 std::cerr << "Error canceling order: " << e.what() << std::endl;
-                rapidjson::Document errorDoc;
-                errorDoc.SetObject();
-                rapidjson::Document::AllocatorType& allocator = errorDoc.GetAllocator();
-                errorDoc.AddMember("error", rapidjson::StringRef(e.what()), allocator);
-                return errorDoc; 
+                results[i] = rapidjson::Document();
+                results[i].SetObject();
+                results[i].AddMember("error", rapidjson::Value(e.what(), results[i].GetAllocator()), results[i].GetAllocator());
             }
-        }));
+        }, done);
+        done.wait();
+        return results;
+    }
+
+    std::vector<std::future<rapidjson::Document>> futures;
+    futures.reserve(orderParams.size());
+
+    // Event-driven path: every request is in flight at once on the engine's connections
+    for (const auto& orderid : orderParams) {
+        futures.push_back(trading.cancelOrderAsync(orderid, token));
     }
 
     std::vector<rapidjson::Document> results;
@@ -171,15 +624,178 @@ rapidjson::Document System::cancelAllOrder(const std::string &token)
     return trading.cancelAllOrder(token);
 }
 
+rapidjson::Document System::cancelAllByInstrument(const std::string& instrument, const std::string& token)
+{
+    return trading.cancelAllByInstrument(instrument, token);
+}
+
+rapidjson::Document System::cancelByLabel(const std::string& label, const std::string& token)
+{
+    return trading.cancelByLabel(label, token);
+}
+
+// Count one cancel_all* or cancel_by_label response, whose result is the number cancelled
+static void countMassCancel(const rapidjson::Document& response, System::MassCancelResult& outcome)
+{
+    if (response.IsObject() && response.HasMember("result") && response["result"].IsUint64()) {
+        outcome.cancelled += response["result"].GetUint64();
+    } else {
+        ++outcome.failed;
+    }
+}
+
+System::MassCancelResult System::massCancel(const OrderFilter& filter, const std::string& token)
+{
+    MassCancelResult outcome;
+    if (filter.labelPrefix.empty() && !filter.buy) {
+        countMassCancel(filter.instrument.empty() ? trading.cancelAllOrder(token)
+                                                  : trading.cancelAllByInstrument(filter.instrument, token), outcome);
+        outcome.requests = 1;
+        return outcome;
+    }
+
+    // Open orders under the label prefix (or all of them), from the tracked store or a snapshot
+    OrderStore snapshot(0);
+    const OrderStore* source = &orders;
+    if (!isTrackingOrders()) {
+        const rapidjson::Document open = trading.getOpenOrder(token);
+        ++outcome.requests;
+        if (!open.IsObject() || !open.HasMember("result")) {
+            ++outcome.failed;
+            return outcome;
+        }
+        snapshot.applyOrders(open["result"]);
+        source = &snapshot;
+    }
+    OrderFilter scope;
+    scope.labelPrefix = filter.labelPrefix;
+    const std::vector<OrderRecord> candidates = source->openOrders(scope);
+
+    // A label can go out as one cancel_by_label only if none of its open orders falls outside the filter
+    std::map<std::string, bool> labelWhole;
+    for (const OrderRecord& record : candidates) {
+        if (!record.label.empty()) {
+            auto entry = labelWhole.emplace(record.label, true).first;
+            entry->second = entry->second && filter.matches(record);
+        }
+    }
+    std::vector<std::string> labels;
+    for (const auto& entry : labelWhole) {
+        if (entry.second) {
+            labels.push_back(entry.first);
+        }
+    }
+    std::vector<CancelRequest> singles;
+    for (const OrderRecord& record : candidates) {
+        auto entry = labelWhole.find(record.label);
+        if (filter.matches(record) && (entry == labelWhole.end() || !entry->second)) {
+            singles.push_back(CancelRequest{record.orderId});
+        }
+    }
+
+    // Single cancels go out as a batch while the label cancels run on the pool
+    OrderBatch batch = cancelOrders(singles, token);
+    std::vector<rapidjson::Document> responses(labels.size());
+    WaitGroup done;
+    threadPool.bulk(labels.size(), [this, &token, &labels, &responses](size_t i) {
+        try {
+            responses[i] = trading.cancelByLabel(labels[i], token);
+        } catch (const std::exception& e) {
+            std::cerr << "Error canceling by label: " << e.what() << std::endl;
+            responses[i] = localError(e.what());
+        }
+    }, done);
+    done.wait();
+    batch.wait();
+
+    for (const rapidjson::Document& response : responses) {
+        countMassCancel(response, outcome);
+    }
+    for (const OrderResult& result : batch.results()) {
+        if (result.ok()) {
+            ++outcome.cancelled;
+        } else {
+            ++outcome.failed;
+        }
+    }
+    outcome.requests += labels.size() + singles.size();
+    return outcome;
+}
+
 // Get all open orders
 rapidjson::Document System::getOpenOrder(const std::string &token)
 {
+    if (isTrackingOrders()) {
+        rapidjson::Document response;
+        response.SetObject();
+        auto& allocator = response.GetAllocator();
+        rapidjson::Value result(rapidjson::kArrayType);
+        for (const OrderRecord& record : orders.openOrders()) {
+            rapidjson::Value order;
+            orderToJson(record, order, allocator);
+            result.PushBack(order, allocator);
+        }
+        response.AddMember("result", result, allocator);
+        return response;
+    }
     return trading.getOpenOrder(token);
 }
 rapidjson::Document System::getOrderState(const std::string &orderid, const std::string &token)
 {
+    OrderRecord record;
+    if (isTrackingOrders() && orders.find(orderid, record)) {
+        rapidjson::Document response;
+        response.SetObject();
+        rapidjson::Value result;
+        orderToJson(record, result, response.GetAllocator());
+        response.AddMember("result", result, response.GetAllocator());
+        return response;
+    }
     return trading.getOrderState(orderid, token);
 }
+void System::getOrderState(const std::string &orderid, const std::string &token, OrderResult &result)
+{
+    if (isTrackingOrders() && orders.find(orderid, result)) {
+        return;
+    }
+    trading.getOrderState(orderid, token, result);
+}
+// Get every instrument of a currency; the reference data is kept in the instrument cache
+rapidjson::Document System::getInstruments(const std::string& currency)
+{
+    rapidjson::Document response = trading.getInstruments(currency);
+    if (response.IsObject() && response.HasMember("result")) {
+        instrumentCache.apply(response["result"]);
+    }
+    return response;
+}
+
+// Warm start from the cache file, then one getInstruments per currency the file did not
+// cover (all of them without a usable file); the file is rewritten when anything was fetched
+bool System::loadInstruments(const std::vector<std::string>& currencies, const std::string& cachePath, std::chrono::seconds maxAge)
+{
+    if (instrumentCache.size() == 0) {
+        instrumentCache.load(cachePath, maxAge);
+    }
+    bool loaded = true;
+    bool fetched = false;
+    for (const std::string& currency : currencies) {
+        if (instrumentCache.hasCurrency(currency)) {
+            continue;
+        }
+        rapidjson::Document response = getInstruments(currency);
+        if (!response.IsObject() || !response.HasMember("result") || !response["result"].IsArray()) {
+            std::cerr << "Failed to load instruments for " << currency << std::endl;
+            loaded = false;
+        }
+        fetched = true;
+    }
+    if (loaded && fetched) {
+        instrumentCache.save(cachePath);
+    }
+    return loaded;
+}
+
 // Get user trades by order
 rapidjson::Document System::getOrderBook(const std::string& instrument_name) {
     return trading.getOrderBook(instrument_name);
@@ -187,10 +803,95 @@ rapidjson::Document System::getOrderBook(const std::string& instrument_name) {
 // Get user trades by order
 rapidjson::Document System::getPositions(const std::string &token)
 {
+    if (isTrackingPositions()) {
+        rapidjson::Document response;
+        response.SetObject();
+        auto& allocator = response.GetAllocator();
+        rapidjson::Value result(rapidjson::kArrayType);
+        for (const PositionCache::Position& position : positionStore.positions(true)) {
+            rapidjson::Value entry;
+            positionToJson(position, entry, allocator);
+            result.PushBack(entry, allocator);
+        }
+        response.AddMember("result", result, allocator);
+        return response;
+    }
     return trading.getPositions(token);
 }
 // Get user trades by order
 rapidjson::Document System::getPosition(const std::string &token, const std::string &currency)
 {
+    PositionCache::Position position;
+    if (isTrackingPositions() && positionStore.position(currency, position)) {
+        rapidjson::Document response;
+        response.SetObject();
+        rapidjson::Value result;
+        positionToJson(position, result, response.GetAllocator());
+        response.AddMember("result", result, response.GetAllocator());
+        return response;
+    }
     return trading.getPosition(token, currency);
 }
+
+// Typed order entry; WebSocket responses already arrive as documents, so only their fields are copied
+void System::placeOrder(const BuyRequest& request, const std::string& token, OrderResult& result, Transport transport)
+{
+    InstrumentId id = NoInstrumentId;
+    if (const char* refused = preTradeCheck(request, id)) {
+        OrderResponseDecoder::setLocalError(result, refused);
+        return;
+    }
+    try {
+        if (transport == Transport::WebSocket) {
+            OrderResponseDecoder::fromDocument(requireWebSocket().buy(request).get(), result);
+        } else {
+            trading.placeOrder(request, token, result);
+        }
+    } catch (...) {
+        riskCheck.orderClosed(id);
+        throw;
+    }
+    settleOrder(id, result.ok(), result.state, result.id());
+}
+
+void System::sellOrder(const SellRequest& request, const std::string& token, OrderResult& result, Transport transport)
+{
+    InstrumentId id = NoInstrumentId;
+    if (const char* refused = preTradeCheck(request, id)) {
+        OrderResponseDecoder::setLocalError(result, refused);
+        return;
+    }
+    try {
+        if (transport == Transport::WebSocket) {
+            OrderResponseDecoder::fromDocument(requireWebSocket().sell(request).get(), result);
+        } else {
+            trading.sellOrder(request, token, result);
+        }
+    } catch (...) {
+        riskCheck.orderClosed(id);
+        throw;
+    }
+    settleOrder(id, result.ok(), result.state, result.id());
+}
+
+void System::modifyOrder(const EditRequest& request, const std::string& token, OrderResult& result, Transport transport)
+{
+    if (riskCheck.checkMessage() != RiskCheck::Result::Ok) {
+        OrderResponseDecoder::setLocalError(result, RiskCheck::toString(RiskCheck::Result::MessageRate));
+        return;
+    }
+    if (transport == Transport::WebSocket) {
+        OrderResponseDecoder::fromDocument(requireWebSocket().edit(request).get(), result);
+        return;
+    }
+    trading.modifyOrder(request, token, result);
+}
+
+void System::cancelOrder(const CancelRequest& request, const std::string& token, OrderResult& result, Transport transport)
+{
+    if (transport == Transport::WebSocket) {
+        OrderResponseDecoder::fromDocument(requireWebSocket().cancel(request).get(), result);
+        return;
+    }
+    trading.cancelOrder(request, token, result);
+}
@@ -1,11 +1,29 @@
 #include "Trading.h"
+#include "RequestEncoder.h"
+#include "OrderResponseDecoder.h"
+#include <iostream>
+#include <stdexcept>
+#include <chrono>
+
+// Per-thread buffer the typed requests are encoded into; keeps its capacity between requests
+static std::string& targetBuffer() {
+    static thread_local std::string buffer;
+    return buffer;
+}
+
+// Future already holding the empty document returned for requests that cannot be built
+static std::future<rapidjson::Document> emptyResult() {
+    std::promise<rapidjson::Document> promise;
+    promise.set_value(rapidjson::Document());
+    return promise.get_future();
+}
 
 // Constructor initializes the connection object
 Trading::Trading(Connection& conn) : conn(conn) {}
 
 // Place an order 
 // - Takes parameters for token, instrument, type, amount, price, and label
-// - Constructs the request URL and parameters
+// - Builds the typed request
 // - Sends the request using the connection object
 rapidjson::Document Trading::placeOrder(
     const std::string& token, 
@@ -15,27 +33,46 @@ rapidjson::Document Trading::placeOrder(
     double price, 
     const std::string& label) {
 
-    std::unordered_map<std::string, std::string> params; 
-    params["instrument_name"] = instrument; 
-    params["type"] = type; 
-    params["amount"] = std::to_string(amount); 
+    std::optional<BuyRequest> request = buyRequest(instrument, type, amount, price, label);
+    if (!request) {
+        return rapidjson::Document();
+    }
+    return placeOrder(*request, token); 
+}
+
+// Build a buy request from the string-based arguments
+std::optional<BuyRequest> Trading::buyRequest(
+    const std::string& instrument, 
+    const std::string& type, 
+    double amount, 
+    double price, 
+    const std::string& label) {
+
+    std::optional<OrderType> orderType = parseOrderType(type);
+    if (!orderType) {
+        std::cerr << "Unknown order type: " << type << std::endl;
+        return std::nullopt;
+    }
+
+    BuyRequest request;
+    request.instrument = instrument; 
+    request.type = *orderType; 
+    request.amount = amount; 
 
     // Add price only for limit orders
-    if (type == "limit") { 
-        params["price"] = std::to_string(price);; 
+    if (request.type == OrderType::Limit) { 
+        request.price = price; 
     }
 
     // Add label if provided
-    if (!label.empty()) { 
-        params["label"] = label; 
-    }
+    request.label = label; 
 
-    return conn.sendRequest("/api/v2/private/buy", params, "GET", token); 
+    return request;
 }
 
 // Modify an existing order
 // - Takes parameters for order_id, token, and optional fields for amount, contracts, price, etc.
-// - Constructs the request URL and parameters with the provided modifications
+// - Builds the typed request with the provided modifications
 // - Sends the request using the connection object
 rapidjson::Document Trading::modifyOrder(
     const std::string& order_id, 
@@ -47,35 +84,33 @@ rapidjson::Document Trading::modifyOrder(
     const std::optional<bool>& post_only, 
     const std::optional<bool>& reduce_only) {
 
-    std::unordered_map<std::string, std::string> params; 
-    params["order_id"] = order_id; 
+    return modifyOrder(editRequest(order_id, amount, contracts, price, advanced, post_only, reduce_only), token); 
+}
 
-    // Add parameters based on provided optional values
-    if (amount) { 
-        params["amount"] = std::to_string(amount.value()); 
-    }
-    if (contracts) { 
-        params["contracts"] = std::to_string(contracts.value()); 
-    }
-    if (price) { 
-        params["price"] = std::to_string(price.value()); 
-    }
-    if (advanced) { 
-        params["advanced"] = advanced.value(); 
-    }
-    if (post_only) { 
-        params["post_only"] = post_only.value() ? "true" : "false"; 
-    }
-    if (reduce_only) { 
-        params["reduce_only"] = reduce_only.value() ? "true" : "false"; 
-    }
+// Build an edit request from the optional arguments
+EditRequest Trading::editRequest(
+    const std::string& order_id, 
+    const std::optional<double>& amount, 
+    const std::optional<double>& contracts, 
+    const std::optional<double>& price, 
+    const std::optional<std::string>& advanced, 
+    const std::optional<bool>& post_only, 
+    const std::optional<bool>& reduce_only) {
 
-    return conn.sendRequest("/api/v2/private/edit", params, "GET", token); 
+    EditRequest request;
+    request.orderId = order_id;
+    request.amount = amount;
+    request.contracts = contracts;
+    request.price = price;
+    request.advanced = advanced;
+    request.postOnly = post_only;
+    request.reduceOnly = reduce_only;
+    return request;
 }
 
 // Place a sell order
 // - Takes parameters for token, instrument, and optional fields for amount, contracts, price, type, trigger, etc.
-// - Constructs the request URL and parameters
+// - Builds the typed request
 // - Sends the request using the connection object
 rapidjson::Document Trading::sellOrder(
     const std::string& token, 
@@ -87,41 +122,56 @@ rapidjson::Document Trading::sellOrder(
     const std::optional<std::string>& trigger, 
     const std::optional<double>& trigger_price) {
 
-    std::unordered_map<std::string, std::string> params; 
-    params["instrument_name"] = instrument; 
-
-    // Add parameters based on provided optional values
-    if (amount) { 
-        params["amount"] = std::to_string(amount.value()); 
-    }
-    if (contracts) { 
-        params["contracts"] = std::to_string(contracts.value()); 
-    }
-    if (price) { 
-        params["price"] = std::to_string(price.value()); 
+    std::optional<SellRequest> request = sellRequest(instrument, amount, contracts, price, type, trigger, trigger_price);
+    if (!request) {
+        return rapidjson::Document();
     }
+    return sellOrder(*request, token); 
+}
+
+// Build a sell request from the optional arguments
+std::optional<SellRequest> Trading::sellRequest(
+    const std::string& instrument, 
+    const std::optional<double>& amount, 
+    const std::optional<double>& contracts, 
+    const std::optional<double>& price, 
+    const std::optional<std::string>& type, 
+    const std::optional<std::string>& trigger, 
+    const std::optional<double>& trigger_price) {
+
+    SellRequest request;
+    request.instrument = instrument; 
+    request.amount = amount;
+    request.contracts = contracts;
+    request.price = price;
+    request.triggerPrice = trigger_price;
+
+    // Deribit defaults to a limit order when no type is given
     if (type) { 
-        params["type"] = type.value(); 
+        std::optional<OrderType> orderType = parseOrderType(type.value());
+        if (!orderType) {
+            std::cerr << "Unknown order type: " << type.value() << std::endl;
+            return std::nullopt;
+        }
+        request.type = *orderType; 
     }
     if (trigger) { 
-        params["trigger"] = trigger.value(); 
-    }
-    if (trigger_price) { 
-        params["trigger_price"] = std::to_string(trigger_price.value()); 
+        request.trigger = parseTriggerType(trigger.value());
+        if (!request.trigger) {
+            std::cerr << "Unknown trigger: " << trigger.value() << std::endl;
+            return std::nullopt;
+        }
     }
 
-    return conn.sendRequest("/api/v2/private/sell", params, "GET", token); 
+    return request;
 }
 
 // Cancel a specific order
 // - Takes parameters for order ID and token
-// - Constructs the request URL and parameters
+// - Builds the typed request
 // - Sends the request using the connection object
 rapidjson::Document Trading::cancelOrder(const std::string& orderid, const std::string& token) {
-    std::unordered_map<std::string, std::string> params; 
-    params["orderid"] = orderid; 
-
-    return conn.sendRequest("/api/v2/private/cancel", params, "GET", token); 
+    return cancelOrder(CancelRequest{orderid}, token); 
 }
 
 // Cancel all open orders
@@ -129,9 +179,32 @@ rapidjson::Document Trading::cancelOrder(const std::string& orderid, const std::
 // - Constructs the request URL
 // - Sends the request using the connection object
 rapidjson::Document Trading::cancelAllOrder(const std::string& token) {
-    std::unordered_map<std::string, std::string> params; 
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, "private/cancel_all");
 
-    return conn.sendRequest("/api/v2/private/cancel_all", params, "GET", token); 
+    return conn.sendEncoded(target, token); 
+}
+
+// Cancel all open orders of one instrument
+// - Takes the instrument name and token as input
+// - Constructs the request URL
+// - Sends the request using the connection object
+rapidjson::Document Trading::cancelAllByInstrument(const std::string& instrument, const std::string& token) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, "private/cancel_all_by_instrument", "instrument_name", instrument);
+
+    return conn.sendEncoded(target, token);
+}
+
+// Cancel all open orders with a label
+// - Takes the label and token as input
+// - Constructs the request URL
+// - Sends the request using the connection object
+rapidjson::Document Trading::cancelByLabel(const std::string& label, const std::string& token) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, "private/cancel_by_label", "label", label);
+
+    return conn.sendEncoded(target, token);
 }
 
 // Get all open orders
@@ -139,29 +212,30 @@ rapidjson::Document Trading::cancelAllOrder(const std::string& token) {
 // - Constructs the request URL
 // - Sends the request using the connection object
 rapidjson::Document Trading::getOpenOrder(const std::string& token) {
-    std::unordered_map<std::string, std::string> params; 
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, "private/get_open_orders");
 
-    return conn.sendRequest("/api/v2/private/get_open_orders", params, "GET", token); 
+    return conn.sendEncoded(target, token); 
 }
 // Get the state of a specific order
 // - Takes order ID and token as input
 // - Constructs the request URL and parameters
 // - Sends the request using the connection object
 rapidjson::Document Trading::getOrderState(const std::string& orderid, const std::string& token) {
-    std::unordered_map<std::string, std::string> params; 
-    params["orderid"] = orderid; 
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, "private/get_order_state", "order_id", orderid);
 
-    return conn.sendRequest("/api/v2/private/get_order_state", params, "GET", token); 
+    return conn.sendEncoded(target, token); 
 }
 // Get order book for a given instrument
 // - Takes instrument name as input
 // - Constructs the request URL and parameters
 // - Sends the request using the connection object
 rapidjson::Document Trading::getOrderBook(const std::string& instrument_name) {
-    std::unordered_map<std::string, std::string> params; 
-    params["instrument_name"] = instrument_name; 
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, "public/get_order_book", "instrument_name", instrument_name);
 
-    return conn.sendRequest("/api/v2/public/get_order_book", params, "GET"); 
+    return conn.sendEncoded(target); 
 }
 
 // Get all open positions
@@ -169,9 +243,10 @@ rapidjson::Document Trading::getOrderBook(const std::string& instrument_name) {
 // - Constructs the request URL 
 // - Sends the request using the connection object
 rapidjson::Document Trading::getPositions(const std::string& token) {
-    std::unordered_map<std::string, std::string> params; 
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, "private/get_positions");
 
-    return conn.sendRequest("/api/v2/private/get_positions", params, "GET", token); 
+    return conn.sendEncoded(target, token); 
 }
 
 // Get position for a specific instrument
@@ -179,8 +254,206 @@ rapidjson::Document Trading::getPositions(const std::string& token) {
 // - Constructs the request URL and parameters
 // - Sends the request using the connection object
 rapidjson::Document Trading::getPosition(const std::string& token, const std::string& instrument_name) {
-    std::unordered_map<std::string, std::string> params; 
-    params["instrument_name"] = instrument_name; 
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, "private/get_position", "instrument_name", instrument_name);
+
+    return conn.sendEncoded(target, token); 
+}
+
+// Get every live instrument of a currency
+rapidjson::Document Trading::getInstruments(const std::string& currency) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, "public/get_instruments", "currency", currency);
+
+    return conn.sendEncoded(target);
+}
+
+// Get the account summary (equity, margins, PnL) for one currency
+rapidjson::Document Trading::getAccountSummary(const std::string& token, const std::string& currency) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, "private/get_account_summary", "currency", currency);
+
+    return conn.sendEncoded(target, token);
+}
+
+// Send a typed buy request
+rapidjson::Document Trading::placeOrder(const BuyRequest& request, const std::string& token) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    return conn.sendEncoded(target, token);
+}
+
+// Send a typed sell request
+rapidjson::Document Trading::sellOrder(const SellRequest& request, const std::string& token) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    return conn.sendEncoded(target, token);
+}
+
+// Send a typed edit request
+rapidjson::Document Trading::modifyOrder(const EditRequest& request, const std::string& token) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    return conn.sendEncoded(target, token);
+}
+
+// Send a typed cancel request
+rapidjson::Document Trading::cancelOrder(const CancelRequest& request, const std::string& token) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    return conn.sendEncoded(target, token);
+}
+
+// Engine used by the *Async variants; they cannot run without one
+RequestEngine& Trading::requireEngine() {
+    if (!engine) {
+        throw std::runtime_error("Trading has no RequestEngine attached");
+    }
+    return *engine;
+}
+
+// Place an order without blocking; the response arrives through the future
+std::future<rapidjson::Document> Trading::placeOrderAsync(
+    const std::string& token, 
+    const std::string& instrument, 
+    const std::string& type, 
+    double amount, 
+    double price, 
+    const std::string& label) {
+
+    std::optional<BuyRequest> request = buyRequest(instrument, type, amount, price, label);
+    if (!request) {
+        return emptyResult();
+    }
+    return placeOrderAsync(*request, token); 
+}
+
+// Place a sell order without blocking; the response arrives through the future
+std::future<rapidjson::Document> Trading::sellOrderAsync(
+    const std::string& token, 
+    const std::string& instrument, 
+    const std::optional<double>& amount, 
+    const std::optional<double>& contracts, 
+    const std::optional<double>& price, 
+    const std::optional<std::string>& type, 
+    const std::optional<std::string>& trigger, 
+    const std::optional<double>& trigger_price) {
+
+    std::optional<SellRequest> request = sellRequest(instrument, amount, contracts, price, type, trigger, trigger_price);
+    if (!request) {
+        return emptyResult();
+    }
+    return sellOrderAsync(*request, token); 
+}
+
+// Cancel an order without blocking; the response arrives through the future
+std::future<rapidjson::Document> Trading::cancelOrderAsync(const std::string& orderid, const std::string& token) {
+    return cancelOrderAsync(CancelRequest{orderid}, token); 
+}
+
+// Typed variants; the engine copies the encoded target, so the buffer is free again on return
+std::future<rapidjson::Document> Trading::placeOrderAsync(const BuyRequest& request, const std::string& token) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    return requireEngine().submit(target, token);
+}
+
+std::future<rapidjson::Document> Trading::sellOrderAsync(const SellRequest& request, const std::string& token) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    return requireEngine().submit(target, token);
+}
+
+std::future<rapidjson::Document> Trading::modifyOrderAsync(const EditRequest& request, const std::string& token) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    return requireEngine().submit(target, token);
+}
 
-    return conn.sendRequest("/api/v2/private/get_position", params, "GET", token); 
-}
\ No newline at end of file
+std::future<rapidjson::Document> Trading::cancelOrderAsync(const CancelRequest& request, const std::string& token) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    return requireEngine().submit(target, token);
+}
+
+// Send an encoded target and decode the body straight into result
+void Trading::sendForResult(const std::string& target, const std::string& token, OrderResult& result) {
+    // Reused per thread, like the target buffer
+    static thread_local std::string response;
+    if (!conn.sendEncoded(target, token, response)) {
+        result = OrderResult();
+        OrderResponseDecoder::setLocalError(result, "Request failed");
+        return;
+    }
+    const auto received = std::chrono::steady_clock::now();
+    OrderResponseDecoder::decode(response, result);
+    conn.timings().recordParse(RequestTimings::endpointOf(target),
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - received).count());
+}
+
+// Queue an encoded target on the engine and decode the body on its I/O thread
+void Trading::submitForResult(const std::string& target, const std::string& token, ResultCallback onResult) {
+    requireEngine().submitRaw(target, token, [onResult = std::move(onResult)](const char* error, std::string& body) {
+        OrderResult result;
+        if (error) {
+            OrderResponseDecoder::setLocalError(result, error);
+        } else {
+            OrderResponseDecoder::decode(body, result);
+        }
+        onResult(result);
+    });
+}
+
+void Trading::placeOrder(const BuyRequest& request, const std::string& token, OrderResult& result) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    sendForResult(target, token, result);
+}
+
+void Trading::sellOrder(const SellRequest& request, const std::string& token, OrderResult& result) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    sendForResult(target, token, result);
+}
+
+void Trading::modifyOrder(const EditRequest& request, const std::string& token, OrderResult& result) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    sendForResult(target, token, result);
+}
+
+void Trading::cancelOrder(const CancelRequest& request, const std::string& token, OrderResult& result) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    sendForResult(target, token, result);
+}
+
+void Trading::getOrderState(const std::string& order_id, const std::string& token, OrderResult& result) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, "private/get_order_state", "order_id", order_id);
+    sendForResult(target, token, result);
+}
+
+void Trading::placeOrderAsync(const BuyRequest& request, const std::string& token, ResultCallback onResult) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    submitForResult(target, token, std::move(onResult));
+}
+
+void Trading::sellOrderAsync(const SellRequest& request, const std::string& token, ResultCallback onResult) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    submitForResult(target, token, std::move(onResult));
+}
+
+void Trading::modifyOrderAsync(const EditRequest& request, const std::string& token, ResultCallback onResult) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    submitForResult(target, token, std::move(onResult));
+}
+
+void Trading::cancelOrderAsync(const CancelRequest& request, const std::string& token, ResultCallback onResult) {
+    std::string& target = targetBuffer();
+    RequestEncoder::encodeTarget(target, request);
+    submitForResult(target, token, std::move(onResult));
+}
@@ -1,17 +1,53 @@
 // WebSocketClient.cpp
 #include "WebSocketClient.h"
+#include "RequestEncoder.h"
 #include <rapidjson/writer.h>
 #include <rapidjson/stringbuffer.h>
 #include <rapidjson/document.h>
+#include <algorithm>
 #include <iostream>
 #include <chrono>
+#include <sstream>
+#include <cstring>
 #include <boost/asio/ssl.hpp>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Channel of a notification from a scan of the frame's header only: notifications start with
+// {"jsonrpc":"2.0","method":"subscription","params":{"channel":"...", so the channel is
+// found without parsing. Empty for responses and anything unrecognised.
+static std::string_view headerChannel(std::string_view frame) {
+    static constexpr std::string_view channelKey = "\"channel\":\"";
+    static constexpr size_t HeaderScan = 128;
+    const size_t key = frame.substr(0, HeaderScan).find(channelKey);
+    if (key == std::string_view::npos) {
+        return std::string_view();
+    }
+    const size_t begin = key + channelKey.size();
+    const size_t end = frame.find('"', begin);
+    if (end == std::string_view::npos) {
+        return std::string_view();
+    }
+    return frame.substr(begin, end - begin);
+}
+
+static void printPropagationDelay(int64_t serverTime) {
+    auto client_time = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+
+    auto propagation_delay = client_time - serverTime;
+    std::cout << "Propagation delay: " << propagation_delay << " ms" << std::endl;
+}
 
 // Constructor initializes the client object and sets up default values
 WebSocketClient::WebSocketClient()
     : connected(false)
     , should_run(true)
     , m_isRunning(false)
+    , messageQueue(8192, WaitStrategy::Park)
+    , feedParser(SimdFeedDecoder::available() ? FeedParser::Simdjson : FeedParser::RapidJson)
 {
     // Initialize the client library
     client.init_asio(); 
@@ -76,22 +112,24 @@ bool WebSocketClient::connect(const std::string& host, const std::string& port)
     return connected;
 }
 
-// Construct a JSON subscription message
-std::string WebSocketClient::constructSubscriptionMessage(const std::string& channel, const std::string& token) {
+// Construct a JSON subscription message for count channels
+std::string WebSocketClient::constructSubscriptionMessage(const std::string* channels, size_t count, const std::string& token, const char* method) {
     rapidjson::Document document; 
     document.SetObject();
     auto& allocator = document.GetAllocator();
 
     document.AddMember("jsonrpc", "2.0", allocator); 
-    document.AddMember("id", 1, allocator); 
-    document.AddMember("method", "private/subscribe", allocator); 
+    document.AddMember("id", nextRequestId.fetch_add(1, std::memory_order_relaxed), allocator); 
+    document.AddMember("method", rapidjson::StringRef(method), allocator); 
 
     rapidjson::Value params(rapidjson::kObjectType);
     params.AddMember("access_token", rapidjson::Value(token.c_str(), allocator), allocator);
 
-    rapidjson::Value channels(rapidjson::kArrayType);
-    channels.PushBack(rapidjson::Value(channel.c_str(), allocator), allocator);
-    params.AddMember("channels", channels, allocator);
+    rapidjson::Value channelList(rapidjson::kArrayType);
+    for (size_t i = 0; i < count; ++i) {
+        channelList.PushBack(rapidjson::Value(channels[i].c_str(), allocator), allocator);
+    }
+    params.AddMember("channels", channelList, allocator);
 
     document.AddMember("params", params, allocator);
 
@@ -104,75 +142,311 @@ std::string WebSocketClient::constructSubscriptionMessage(const std::string& cha
 
 // Subscribe to a specific channel
 bool WebSocketClient::subscribe(const std::string& channel, const std::string& token) {
+    if (!sendSubscriptions(std::vector<std::string>{channel}, token)) {
+        return false;
+    }
+    std::cout << "Subscribed to channel: " << channel << std::endl;
+    return true;
+}
+
+// Subscribe to many channels in as few requests as the per-request limit allows
+bool WebSocketClient::subscribe(const std::vector<std::string>& channels, const std::string& token) {
+    if (!sendSubscriptions(channels, token)) {
+        return false;
+    }
+    std::cout << "Subscribed to " << channels.size() << " channels" << std::endl;
+    return true;
+}
+
+// Intern the channels and route them by id, then send the subscribe requests
+bool WebSocketClient::sendSubscriptions(const std::vector<std::string>& channels, const std::string& token) {
     if (!connected) {
         std::cerr << "Not connected to server" << std::endl;
         return false;
     }
 
-    std::string message = constructSubscriptionMessage(channel, token);
+    channelRegistry.intern(channels);
+    {
+        std::lock_guard<std::mutex> lock(channelHandlersMutex);
+        std::shared_ptr<const ChannelTable> current = std::atomic_load(&channelHandlers);
+        publishChannelTableLocked(current ? current->subscribers : std::vector<ChannelSubscriber>());
+    }
 
-    websocketpp::lib::error_code ec;
-    client.send(connection, message, websocketpp::frame::opcode::text, ec);
+    for (size_t begin = 0; begin < channels.size(); begin += MAX_CHANNELS_PER_SUBSCRIBE) {
+        const size_t count = std::min(MAX_CHANNELS_PER_SUBSCRIBE, channels.size() - begin);
+        std::string message = constructSubscriptionMessage(channels.data() + begin, count, token);
 
-    if (ec) {
-        std::cerr << "Send error: " << ec.message() << std::endl;
-        return false;
+        websocketpp::lib::error_code ec;
+        client.send(connection, message, websocketpp::frame::opcode::text, ec);
+        if (ec) {
+            std::cerr << "Send error: " << ec.message() << std::endl;
+            return false;
+        }
     }
-
-    std::cout << "Subscribed to channel: " << channel << std::endl;
     return true;
 }
 
+// Unsubscribe and subscribe again so the server starts the channel over with a snapshot
+void WebSocketClient::resubscribe(const std::string& channel) {
+    std::string token;
+    {
+        std::lock_guard<std::mutex> lock(tokenMutex);
+        token = accessToken;
+    }
+
+    websocketpp::lib::error_code ec;
+    client.send(connection, constructSubscriptionMessage(&channel, 1, token, "private/unsubscribe"),
+                websocketpp::frame::opcode::text, ec);
+    if (!ec) {
+        client.send(connection, constructSubscriptionMessage(&channel, 1, token), websocketpp::frame::opcode::text, ec);
+    }
+    if (ec) {
+        std::cerr << "Resubscribe error: " << ec.message() << std::endl;
+    }
+}
+
 // Main loop for listening to incoming messages
 void WebSocketClient::listen() {
+    QueuedMessage message;
     while (should_run) {
-        std::unique_lock<std::mutex> lock(queueMutex); 
-        if (!messageQueue.empty()) {
-            std::string message = messageQueue.front();
-            messageQueue.pop();
-            lock.unlock();
+        // Waits according to the ring's wait strategy instead of polling on a timer
+        if (!messageQueue.pop(message, should_run)) {
+            continue;
+        }
 
-            processMessage(message);
-        } else {
-            lock.unlock();
-            std::this_thread::sleep_for(std::chrono::milliseconds(10)); 
+        const uint64_t latency = static_cast<uint64_t>(nowNs() - message.enqueuedNs);
+        queueLatencyCount.fetch_add(1, std::memory_order_relaxed);
+        queueLatencyTotalNs.fetch_add(latency, std::memory_order_relaxed);
+        if (latency > queueLatencyMaxNs.load(std::memory_order_relaxed)) {
+            queueLatencyMaxNs.store(latency, std::memory_order_relaxed); // Only the listener thread writes it
         }
+
+        processMessage(message.payload);
     }
 }
 
+// Monotonic timestamp used to measure queueing latency
+int64_t WebSocketClient::nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+WebSocketClient::QueueLatency WebSocketClient::getQueueLatency() const {
+    QueueLatency latency;
+    latency.count = queueLatencyCount.load(std::memory_order_relaxed);
+    latency.maxNs = queueLatencyMaxNs.load(std::memory_order_relaxed);
+    if (latency.count) {
+        latency.meanNs = static_cast<double>(queueLatencyTotalNs.load(std::memory_order_relaxed)) / latency.count;
+    }
+    return latency;
+}
+
 // Process incoming messages 
-void WebSocketClient::processMessage(const std::string& message) {
+// The frame is handed to the message handler as-is, then parsed in place (which
+// overwrites it) with the reusable parser, so nothing is copied or allocated per message.
+void WebSocketClient::processMessage(std::string& message) {
     try {
-        rapidjson::Document document; 
-        document.Parse(message.c_str()); 
+        // Call the user-defined message handler if provided
+        if (messageHandler) {
+            messageHandler(std::string_view(message)); 
+        }
+
+        // Book notifications nobody else reads skip the DOM; see setFeedParser()
+        if (feedParser == FeedParser::Simdjson && decodeBookFrame(message, feedDecoder, decodedBook, orderBookManager)) {
+            if (decodedBook.timestamp != 0) { // 0 when the frame had none
+                printPropagationDelay(decodedBook.timestamp);
+            }
+            return;
+        }
+
+        InsituParser::Document& document = parser.parse(message);
 
         if (document.HasParseError()) {
             std::cerr << "Error parsing JSON message" << std::endl;
             return;
         }
 
-        // Calculate propagation delay if timestamp information is available
-        if (document.HasMember("params") &&
-            document["params"].HasMember("data") &&
-            document["params"]["data"].HasMember("timestamp")) {
-
-            auto server_time = document["params"]["data"]["timestamp"].GetInt64();
-            auto client_time = std::chrono::duration_cast<std::chrono::milliseconds>(
-                std::chrono::system_clock::now().time_since_epoch()).count();
+        // Responses to our own JSON-RPC requests go to whoever is waiting for them.
+        // The parser's document is reused, so the waiter gets its own copy.
+        if (document.HasMember("id") && document["id"].IsUint64() && !document.HasMember("method")) {
+            if (RpcCallback callback = pendingRequests.take(document["id"].GetUint64())) {
+                rapidjson::Document response;
+                response.CopyFrom(document, response.GetAllocator());
+                callback(std::move(response));
+                return;
+            }
+        }
 
-            auto propagation_delay = client_time - server_time;
-            std::cout << "Propagation delay: " << propagation_delay << " ms" << std::endl;
+        if (document.HasMember("params") && document["params"].IsObject()) {
+            handleNotification(document["params"], orderBookManager);
         }
 
-        // Call the user-defined message handler if provided
-        if (messageHandler) {
-            messageHandler(message); 
+        // Calculate propagation delay if timestamp information is available
+        if (document.HasMember("params") && document["params"].IsObject() &&
+            document["params"].HasMember("data") && document["params"]["data"].IsObject() &&
+            document["params"]["data"].HasMember("timestamp") && document["params"]["data"]["timestamp"].IsInt64()) {
+            printPropagationDelay(document["params"]["data"]["timestamp"].GetInt64());
         }
     } catch (const std::exception& e) {
         std::cerr << "Error processing message: " << e.what() << std::endl;
     }
 }
 
+// A subscription notification's params: keep the local order book of book.* channels in
+// sync (resubscribing on a change_id gap), then hand the data to the channel's handlers
+void WebSocketClient::handleNotification(const rapidjson::Value& params, OrderBookManager& books) {
+    if (!params.HasMember("channel") || !params["channel"].IsString() || !params.HasMember("data")) {
+        return;
+    }
+    const rapidjson::Value& channelValue = params["channel"];
+    const std::string_view channel(channelValue.GetString(), channelValue.GetStringLength());
+    if (channel.compare(0, 5, "book.") == 0) {
+        OrderBook::Result result;
+        const OrderBook* book = books.apply(params["data"], result);
+        onBookResult(channel, book, result);
+    }
+    dispatchChannel(channel, params["data"]);
+}
+
+// The simdjson path: a book.* frame whose channel has no handlers (which need the DOM) is
+// decoded and applied without a DOM. False leaves the frame, unmodified, to the rapidjson path.
+bool WebSocketClient::decodeBookFrame(std::string& frame, SimdFeedDecoder& decoder, BookDelta& delta,
+                                      OrderBookManager& books) {
+    const std::string_view header = headerChannel(frame);
+    if (header.compare(0, 5, "book.") != 0 || hasChannelHandlers(header)) {
+        return false;
+    }
+    std::string_view channel;
+    if (!decoder.decodeBook(frame, channel, delta)) {
+        return false;
+    }
+    OrderBook::Result result;
+    const OrderBook* book = books.apply(delta, result);
+    onBookResult(channel, book, result);
+    return true;
+}
+
+// Resync the book on a change_id gap, otherwise pass the updated book to the book handler
+void WebSocketClient::onBookResult(std::string_view channel, const OrderBook* book, OrderBook::Result result) {
+    if (result == OrderBook::Result::Gap) {
+        std::cerr << "Order book gap on " << channel << ", resyncing" << std::endl;
+        resubscribe(std::string(channel));
+    } else if (result == OrderBook::Result::Applied && bookHandler) {
+        bookHandler(*book);
+    }
+}
+
+bool WebSocketClient::setFeedParser(FeedParser backend) {
+    if (backend == FeedParser::Simdjson && !SimdFeedDecoder::available()) {
+        std::cerr << "This build has no simdjson feed parser (GOQUANT_WITH_SIMDJSON)" << std::endl;
+        return false;
+    }
+    feedParser = backend;
+    return true;
+}
+
+void WebSocketClient::setWaitStrategy(WaitStrategy strategy) {
+    messageQueue.setWaitStrategy(strategy);
+    for (auto& shard : shards) {
+        shard->queue.setWaitStrategy(strategy);
+    }
+}
+
+void WebSocketClient::setMarketDataShards(size_t count, std::vector<int> cores) {
+    if (shardsRunning) {
+        std::cerr << "Market data shards can only be changed before the session starts" << std::endl;
+        return;
+    }
+    shards.clear();
+    for (size_t i = 0; i < count; ++i) {
+        shards.push_back(std::make_unique<FeedShard>(messageQueue.capacity(), messageQueue.getWaitStrategy()));
+        shards.back()->core = i < cores.size() ? cores[i] : -1;
+    }
+}
+
+std::vector<uint64_t> WebSocketClient::shardMessageCounts() const {
+    std::vector<uint64_t> counts;
+    for (const auto& shard : shards) {
+        counts.push_back(shard->handled.load(std::memory_order_relaxed));
+    }
+    return counts;
+}
+
+// The shard a frame goes to, from its header channel. Frames on other channels' instruments
+// hash elsewhere; responses, user.* channels and anything unrecognised return NoShard and
+// stay on the listener.
+size_t WebSocketClient::shardFor(std::string_view frame) const {
+    const std::string_view channel = headerChannel(frame);
+    if (channel.empty() || channel.compare(0, 5, "user.") == 0) {
+        return NoShard;
+    }
+
+    // Instrument part: book.BTC-PERPETUAL.100ms -> BTC-PERPETUAL
+    std::string_view instrument = channel;
+    const size_t dot = channel.find('.');
+    if (dot != std::string_view::npos) {
+        instrument = channel.substr(dot + 1);
+        instrument = instrument.substr(0, instrument.find('.'));
+    }
+    uint64_t hash = 14695981039346656037ull; // FNV-1a
+    for (char c : instrument) {
+        hash = (hash ^ static_cast<uint8_t>(c)) * 1099511628211ull;
+    }
+    return static_cast<size_t>(hash % shards.size());
+}
+
+// Shard worker: parse and handle its instruments' notifications in arrival order
+void WebSocketClient::runShard(FeedShard& shard) {
+#ifdef __linux__
+    if (shard.core >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(shard.core, &cpus);
+        if (pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus) != 0) {
+            std::cerr << "Could not pin market data shard to core " << shard.core << std::endl;
+        }
+    }
+#endif
+    QueuedMessage message;
+    while (shardsRunning.load(std::memory_order_relaxed)) {
+        if (!shard.queue.pop(message, shardsRunning)) {
+            continue;
+        }
+        try {
+            if (feedParser != FeedParser::Simdjson ||
+                !decodeBookFrame(message.payload, shard.decoder, shard.decoded, shard.books)) {
+                InsituParser::Document& document = shard.parser.parse(message.payload);
+                if (!document.HasParseError() && document.HasMember("params") && document["params"].IsObject()) {
+                    handleNotification(document["params"], shard.books);
+                }
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Error processing market data: " << e.what() << std::endl;
+        }
+        shard.handled.store(shard.handled.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); // Only this thread writes it
+    }
+}
+
+void WebSocketClient::startShards() {
+    if (shards.empty() || shardsRunning) {
+        return;
+    }
+    shardsRunning = true;
+    for (auto& shard : shards) {
+        shard->worker = std::thread([this, &shard = *shard]() { runShard(shard); });
+    }
+}
+
+void WebSocketClient::stopShards() {
+    shardsRunning = false;
+    for (auto& shard : shards) {
+        shard->queue.wake();
+        if (shard->worker.joinable()) {
+            shard->worker.join();
+        }
+    }
+}
+
 // Attempt to reconnect to the server
 bool WebSocketClient::reconnect() {
     close();
@@ -184,6 +458,8 @@ bool WebSocketClient::reconnect() {
 void WebSocketClient::close() {
     should_run = false;
     m_isRunning = false;
+    messageQueue.wake();
+    stopShards();
 
     if (connected) {
         websocketpp::lib::error_code ec;
@@ -205,16 +481,24 @@ void WebSocketClient::startWebSocketSession(const std::string& token) {
     if (token.empty()) {
         throw std::runtime_error("Invalid token");
     }
+    setAccessToken(token);
 
     try {
         if (!connect("test.deribit.com", "443")) {
             throw std::runtime_error("Failed to connect to WebSocket server");
         }
 
-        std::string symbol;
-        std::cout << "Enter the instrument/symbol (e.g., BTC-PERPETUAL): ";
-        std::cin >> symbol;
-        if (symbol.empty()) {
+        std::string symbolList;
+        std::cout << "Enter the instruments/symbols, comma separated (e.g., BTC-PERPETUAL,ETH-PERPETUAL): ";
+        std::cin >> symbolList;
+        std::vector<std::string> symbols;
+        std::istringstream symbolStream(symbolList);
+        for (std::string symbol; std::getline(symbolStream, symbol, ',');) {
+            if (!symbol.empty()) {
+                symbols.push_back(symbol);
+            }
+        }
+        if (symbols.empty()) {
             throw std::runtime_error("Invalid instrument symbol");
         }
 
@@ -230,35 +514,16 @@ void WebSocketClient::startWebSocketSession(const std::string& token) {
             default: throw std::runtime_error("Invalid interval choice");
         }
 
-        std::string subscription = "book." + symbol + "." + interval;
+        std::vector<std::string> subscriptions;
+        for (const std::string& symbol : symbols) {
+            subscriptions.push_back("book." + symbol + "." + interval);
+        }
 
-        if (!subscribe(subscription, token)) {
+        if (!subscribe(subscriptions, token)) {
             throw std::runtime_error("Subscription failed");
         }
 
-        m_isRunning = true;
-        m_listenerThread = std::thread([this]() {
-            int reconnectAttempts = 0;
-            while (m_isRunning) {
-                try {
-                    listen();
-                    reconnectAttempts = 0;
-                } catch (const std::exception& e) {
-                    std::cerr << "WebSocket error: " << e.what() << std::endl;
-                    if (m_isRunning && reconnectAttempts < MAX_RECONNECT_ATTEMPTS) {
-                        reconnectAttempts++;
-                        if (!reconnect()) {
-                            std::cerr << "Reconnection attempt " << reconnectAttempts << " failed" << std::endl;
-                        }
-                    } else {
-                        m_isRunning = false;
-                        std::cerr << "Max reconnection attempts reached or session stopped" << std::endl;
-                    }
-                }
-            }
-        });
-
-        m_listenerThread.detach();
+        startListener();
 
     } catch (const std::exception& e) {
         m_isRunning = false;
@@ -266,6 +531,354 @@ void WebSocketClient::startWebSocketSession(const std::string& token) {
         throw;
     }
 }
+// Start the thread that drains the message queue, reconnecting on errors
+void WebSocketClient::startListener() {
+    m_isRunning = true;
+    startShards();
+    m_listenerThread = std::thread([this]() {
+        listenerThreadId = std::this_thread::get_id();
+        int reconnectAttempts = 0;
+        while (m_isRunning) {
+            try {
+                listen();
+                reconnectAttempts = 0;
+            } catch (const std::exception& e) {
+                std::cerr << "WebSocket error: " << e.what() << std::endl;
+                if (m_isRunning && reconnectAttempts < MAX_RECONNECT_ATTEMPTS) {
+                    reconnectAttempts++;
+                    if (!reconnect()) {
+                        std::cerr << "Reconnection attempt " << reconnectAttempts << " failed" << std::endl;
+                    }
+                } else {
+                    m_isRunning = false;
+                    std::cerr << "Max reconnection attempts reached or session stopped" << std::endl;
+                }
+            }
+        }
+    });
+
+    m_listenerThread.detach();
+}
+
+// Connect and start listening without the interactive subscription prompt
+bool WebSocketClient::startSession(const std::string& host, const std::string& port, const std::string& token) {
+    setAccessToken(token);
+    if (!connect(host, port)) {
+        std::cerr << "Failed to connect to WebSocket server" << std::endl;
+        return false;
+    }
+    startListener();
+    return true;
+}
+
+bool WebSocketClient::ChannelSubscriber::matches(ChannelId channel, std::string_view name) const {
+    if (exact.empty()) {
+        return name.compare(0, prefix.size(), prefix) == 0;
+    }
+    return std::binary_search(exact.begin(), exact.end(), channel);
+}
+
+// Build the routing table for subscribers against the current channel index and publish it;
+// the listener keeps using the old one until its next message. channelHandlersMutex must be held.
+void WebSocketClient::publishChannelTableLocked(std::vector<ChannelSubscriber> subscribers) {
+    auto table = std::make_shared<ChannelTable>();
+    table->index = channelRegistry.index();
+    table->subscribers = std::move(subscribers);
+    table->byChannel.resize(table->index->size());
+    for (ChannelId channel = 0; channel < table->index->size(); ++channel) {
+        const std::string& name = table->index->name(channel);
+        for (uint32_t i = 0; i < table->subscribers.size(); ++i) {
+            if (table->subscribers[i].matches(channel, name)) {
+                table->byChannel[channel].push_back(i);
+            }
+        }
+    }
+    std::atomic_store(&channelHandlers, std::shared_ptr<const ChannelTable>(std::move(table)));
+}
+
+// Whether dispatchChannel() would hand a notification on channel to any handler
+bool WebSocketClient::hasChannelHandlers(std::string_view channel) const {
+    std::shared_ptr<const ChannelTable> table = std::atomic_load(&channelHandlers);
+    if (!table) {
+        return false;
+    }
+    const ChannelId id = table->index->find(channel);
+    if (id < table->byChannel.size()) {
+        return !table->byChannel[id].empty();
+    }
+    for (const ChannelSubscriber& subscriber : table->subscribers) {
+        if (subscriber.exact.empty() && subscriber.matches(NoChannelId, channel)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Hand a notification to its channel's handlers: by id for interned channels, otherwise by prefix
+void WebSocketClient::dispatchChannel(std::string_view channel, const rapidjson::Value& data) {
+    std::shared_ptr<const ChannelTable> table = std::atomic_load(&channelHandlers);
+    if (!table) {
+        return;
+    }
+    const ChannelId id = table->index->find(channel);
+    if (id < table->byChannel.size()) {
+        for (uint32_t i : table->byChannel[id]) {
+            table->subscribers[i].handler(channel, data);
+        }
+        return;
+    }
+    for (const ChannelSubscriber& subscriber : table->subscribers) {
+        if (subscriber.exact.empty() && subscriber.matches(NoChannelId, channel)) {
+            subscriber.handler(channel, data);
+        }
+    }
+}
+
+uint64_t WebSocketClient::addChannelHandler(const std::string& prefix, ChannelHandler handler) {
+    std::lock_guard<std::mutex> lock(channelHandlersMutex);
+    std::shared_ptr<const ChannelTable> current = std::atomic_load(&channelHandlers);
+    std::vector<ChannelSubscriber> subscribers = current ? current->subscribers : std::vector<ChannelSubscriber>();
+    const uint64_t id = nextChannelHandlerId++;
+    subscribers.push_back(ChannelSubscriber{id, prefix, {}, std::move(handler)});
+    publishChannelTableLocked(std::move(subscribers));
+    return id;
+}
+
+uint64_t WebSocketClient::addExactChannelHandler(const std::vector<std::string>& channels, ChannelHandler handler) {
+    std::vector<ChannelId> exact = channelRegistry.intern(channels);
+    std::sort(exact.begin(), exact.end());
+    exact.erase(std::unique(exact.begin(), exact.end()), exact.end());
+    if (exact.empty()) {
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(channelHandlersMutex);
+    std::shared_ptr<const ChannelTable> current = std::atomic_load(&channelHandlers);
+    std::vector<ChannelSubscriber> subscribers = current ? current->subscribers : std::vector<ChannelSubscriber>();
+    const uint64_t id = nextChannelHandlerId++;
+    subscribers.push_back(ChannelSubscriber{id, std::string(), std::move(exact), std::move(handler)});
+    publishChannelTableLocked(std::move(subscribers));
+    return id;
+}
+
+void WebSocketClient::removeChannelHandler(uint64_t id) {
+    std::lock_guard<std::mutex> lock(channelHandlersMutex);
+    std::shared_ptr<const ChannelTable> current = std::atomic_load(&channelHandlers);
+    if (!current) {
+        return;
+    }
+    std::vector<ChannelSubscriber> subscribers;
+    for (const ChannelSubscriber& subscriber : current->subscribers) {
+        if (subscriber.id != id) {
+            subscribers.push_back(subscriber);
+        }
+    }
+    publishChannelTableLocked(std::move(subscribers));
+}
+
+void WebSocketClient::setAccessToken(const std::string& token) {
+    std::lock_guard<std::mutex> lock(tokenMutex);
+    accessToken = token;
+}
+
+// Re-authenticate the open connection with a refresh token. The exchange keeps the
+// connection's subscriptions, and later requests carry the new access token.
+uint64_t WebSocketClient::refreshAuth(const std::string& refreshToken, RpcCallback callback) {
+    RpcCallback onResponse = [this, callback = std::move(callback)](rapidjson::Document&& response) {
+        if (response.IsObject() && response.HasMember("result") && response["result"].IsObject()) {
+            const rapidjson::Value& result = response["result"];
+            if (result.HasMember("access_token") && result["access_token"].IsString()) {
+                setAccessToken(result["access_token"].GetString());
+            }
+        }
+        callback(std::move(response));
+    };
+    const uint64_t id = registerRpc(onResponse, RateLimiter::Bucket::NonMatchingEngine);
+    if (id == 0) {
+        return 0;
+    }
+
+    // Written without access_token, unlike sendRpc
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("jsonrpc");
+    writer.String("2.0");
+    writer.Key("id");
+    writer.Uint64(id);
+    writer.Key("method");
+    writer.String("public/auth");
+    writer.Key("params");
+    writer.StartObject();
+    writer.Key("grant_type");
+    writer.String("refresh_token");
+    writer.Key("refresh_token");
+    writer.String(refreshToken.c_str(), static_cast<rapidjson::SizeType>(refreshToken.size()));
+    writer.EndObject();
+    writer.EndObject();
+
+    return sendFrame(id, buffer.GetString(), buffer.GetSize()) ? id : 0;
+}
+
+// Build the error document handed to callers when a request cannot complete
+rapidjson::Document WebSocketClient::errorDocument(const char* message) {
+    rapidjson::Document errorDoc;
+    errorDoc.SetObject();
+    rapidjson::Document::AllocatorType& allocator = errorDoc.GetAllocator();
+    errorDoc.AddMember("error", rapidjson::Value(message, allocator), allocator);
+    return errorDoc;
+}
+
+// Allocate an id and park the callback until the response arrives; 0 if the request cannot be sent
+uint64_t WebSocketClient::registerRpc(RpcCallback& callback, RateLimiter::Bucket bucket) {
+    if (!connected) {
+        callback(errorDocument("Not connected to server"));
+        return 0;
+    }
+    RateLimiter* limiter = rateLimiter.load(std::memory_order_relaxed);
+    if (limiter && !limiter->acquire(bucket)) {
+        rapidjson::Document rejected;
+        rejected.Parse(RateLimiter::rejectedResponse.data(), RateLimiter::rejectedResponse.size());
+        callback(std::move(rejected));
+        return 0;
+    }
+
+    const uint64_t id = nextRequestId.fetch_add(1, std::memory_order_relaxed);
+    if (!pendingRequests.add(id, callback)) {
+        callback(errorDocument("Too many pending requests"));
+        return 0;
+    }
+    return id;
+}
+
+// Send an encoded request, failing its pending callback if the send fails
+bool WebSocketClient::sendFrame(uint64_t id, const char* data, size_t size) {
+    websocketpp::lib::error_code ec;
+    client.send(connection, data, size, websocketpp::frame::opcode::text, ec);
+    if (ec) {
+        std::cerr << "Send error: " << ec.message() << std::endl;
+        if (RpcCallback pending = pendingRequests.take(id)) {
+            pending(errorDocument("Send failed"));
+        }
+        return false;
+    }
+    return true;
+}
+
+// Send a JSON-RPC request; the callback runs on the listener thread when the response arrives
+uint64_t WebSocketClient::sendRpc(const std::string& method, const ParamsWriter& writeParams, RpcCallback callback) {
+    const uint64_t id = registerRpc(callback, RateLimiter::classify(method));
+    if (id == 0) {
+        return 0;
+    }
+
+    rapidjson::StringBuffer buffer;
+    rapidjson::Writer<rapidjson::StringBuffer> writer(buffer);
+    writer.StartObject();
+    writer.Key("jsonrpc");
+    writer.String("2.0");
+    writer.Key("id");
+    writer.Uint64(id);
+    writer.Key("method");
+    writer.String(method.c_str(), static_cast<rapidjson::SizeType>(method.size()));
+    writer.Key("params");
+    writer.StartObject();
+    {
+        std::lock_guard<std::mutex> lock(tokenMutex);
+        if (!accessToken.empty()) {
+            writer.Key("access_token");
+            writer.String(accessToken.c_str(), static_cast<rapidjson::SizeType>(accessToken.size()));
+        }
+    }
+    writeParams(writer);
+    writer.EndObject();
+    writer.EndObject();
+
+    return sendFrame(id, buffer.GetString(), buffer.GetSize()) ? id : 0;
+}
+
+// Encode a typed request into a per-thread buffer and send it; the callback runs on the listener thread
+template <typename Request>
+uint64_t WebSocketClient::sendEncoded(const Request& request, RpcCallback callback) {
+    // Every typed request is order entry
+    const uint64_t id = registerRpc(callback, RateLimiter::Bucket::MatchingEngine);
+    if (id == 0) {
+        return 0;
+    }
+
+    static thread_local std::string buffer;
+    {
+        std::lock_guard<std::mutex> lock(tokenMutex);
+        RequestEncoder::encodeJsonRpc(buffer, id, accessToken, request);
+    }
+    return sendFrame(id, buffer.data(), buffer.size()) ? id : 0;
+}
+
+// Same, with the response delivered through a future
+template <typename Request>
+std::future<rapidjson::Document> WebSocketClient::sendEncoded(const Request& request) {
+    auto promise = std::make_shared<std::promise<rapidjson::Document>>();
+    std::future<rapidjson::Document> result = promise->get_future();
+    sendEncoded(request, [promise](rapidjson::Document&& doc) {
+        promise->set_value(std::move(doc));
+    });
+    return result;
+}
+
+// Send a JSON-RPC request and return a future for its response
+std::future<rapidjson::Document> WebSocketClient::sendRpcFuture(const std::string& method, const ParamsWriter& writeParams) {
+    auto promise = std::make_shared<std::promise<rapidjson::Document>>();
+    std::future<rapidjson::Document> result = promise->get_future();
+    sendRpc(method, writeParams, [promise](rapidjson::Document&& doc) {
+        promise->set_value(std::move(doc));
+    });
+    return result;
+}
+
+// Fail every request still waiting for a response
+void WebSocketClient::failPendingRequests(const char* reason) {
+    pendingRequests.drain([reason](RpcCallback&& callback) {
+        callback(errorDocument(reason));
+    });
+}
+
+// Place a buy order over JSON-RPC
+std::future<rapidjson::Document> WebSocketClient::buy(const BuyRequest& request) {
+    return sendEncoded(request);
+}
+
+// Place a sell order over JSON-RPC
+std::future<rapidjson::Document> WebSocketClient::sell(const SellRequest& request) {
+    return sendEncoded(request);
+}
+
+// Edit an existing order over JSON-RPC
+std::future<rapidjson::Document> WebSocketClient::edit(const EditRequest& request) {
+    return sendEncoded(request);
+}
+
+// Cancel an order over JSON-RPC
+std::future<rapidjson::Document> WebSocketClient::cancel(const CancelRequest& request) {
+    return sendEncoded(request);
+}
+
+// Callback variants
+uint64_t WebSocketClient::buy(const BuyRequest& request, RpcCallback callback) {
+    return sendEncoded(request, std::move(callback));
+}
+
+uint64_t WebSocketClient::sell(const SellRequest& request, RpcCallback callback) {
+    return sendEncoded(request, std::move(callback));
+}
+
+uint64_t WebSocketClient::edit(const EditRequest& request, RpcCallback callback) {
+    return sendEncoded(request, std::move(callback));
+}
+
+uint64_t WebSocketClient::cancel(const CancelRequest& request, RpcCallback callback) {
+    return sendEncoded(request, std::move(callback));
+}
+
 // WebSocket event handlers
 void WebSocketClient::on_open(websocketpp::connection_hdl hdl) {
     std::lock_guard<std::mutex> lock(mutex_);
@@ -278,10 +891,25 @@ void WebSocketClient::on_close(websocketpp::connection_hdl hdl) {
     connection.reset();
     connected = false;
     std::cout << "Connection closed" << std::endl;
+    failPendingRequests("Connection closed");
 }
 void WebSocketClient::on_message(websocketpp::connection_hdl hdl, MessagePtr msg) {
-    std::lock_guard<std::mutex> lock(queueMutex);
-    messageQueue.push(msg->get_payload());
+    // Move the payload buffer out of the message instead of copying it
+    QueuedMessage message{std::move(msg->get_raw_payload()), nowNs()};
+    if (shardsRunning.load(std::memory_order_relaxed)) {
+        const size_t shard = shardFor(message.payload);
+        if (shard != NoShard) {
+            // Wait for the shard to make room, unless it is being stopped
+            while (!shards[shard]->queue.tryPush(std::move(message))) {
+                if (!shardsRunning.load(std::memory_order_relaxed)) {
+                    return;
+                }
+                std::this_thread::yield();
+            }
+            return;
+        }
+    }
+    messageQueue.push(std::move(message));
 }
 
 void WebSocketClient::on_error(websocketpp::connection_hdl hdl) {
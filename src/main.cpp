@@ -1,6 +1,8 @@
 #include "System.h"
 #include "WebSocketClient.h"
-#include "utils.h"
+#include "Utils.h"
+#include "AuthSession.h"
+#include "RateLimiter.h"
 #include <iostream>
 #include <string>
 #include <thread>
@@ -8,7 +10,6 @@
 #include <rapidjson/document.h>
 #include <rapidjson/writer.h>
 #include <rapidjson/stringbuffer.h>
-#include <curl/curl.h>
 #include <rapidjson/document.h>
 #include <rapidjson/writer.h>
 
@@ -18,66 +19,7 @@
 
 namespace rj = rapidjson;
 using namespace std;
-// Callback function to write the response to a string
-static size_t WriteCallback(void *contents, size_t size, size_t nmemb, void *userp)
-{
-    ((std::string *)userp)->append((char *)contents, size * nmemb);
-    return size * nmemb;
-}
-// Function to retrieve the authentication token
-std::string getAuthToken()
-{
-    const std::string url = std::string(BASE_URL) + "/api/v2/public/auth?client_id=" + CLIENT_ID +
-                            "&client_secret=" + CLIENT_SECRET + "&grant_type=client_credentials";
-    std::string response;
-
-    // Initialize CURL
-    CURL *curl = curl_easy_init();
-    if (!curl)
-    {
-        std::cerr << "Failed to initialize CURL" << std::endl;
-        return "";
-    }
-
-    // Set CURL options
-    curl_easy_setopt(curl, CURLOPT_URL, url.c_str());
-    curl_easy_setopt(curl, CURLOPT_HTTPGET, 1L); // Use GET method
-    curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, WriteCallback);
-    curl_easy_setopt(curl, CURLOPT_WRITEDATA, &response);
-    curl_easy_setopt(curl, CURLOPT_SSL_VERIFYPEER, 1L); // SSL verification
 
-    // Perform the request
-    CURLcode res = curl_easy_perform(curl);
-    if (res != CURLE_OK)
-    {
-        std::cerr << "CURL error: " << curl_easy_strerror(res) << std::endl;
-        curl_easy_cleanup(curl);
-        return "";
-    }
-
-    // Clean up CURL
-    curl_easy_cleanup(curl);
-
-    // Parse JSON response
-    rj::Document doc;
-    if (doc.Parse(response.c_str()).HasParseError())
-    {
-        std::cerr << "JSON parse error" << std::endl;
-        return "";
-    }
-
-    // Check if the response contains the access token
-    if (doc.HasMember("result") && doc["result"].IsObject() &&
-        doc["result"].HasMember("access_token") && doc["result"]["access_token"].IsString())
-    {
-        return doc["result"]["access_token"].GetString();
-    }
-    else
-    {
-        std::cerr << "Failed to retrieve access token: " << response << std::endl;
-        return "";
-    }
-}
 int main()
 {
     std::cout << "Trading System Initializing...\n";
@@ -86,15 +28,26 @@ int main()
     Connection conn(BASE_URL);
     System system(conn, 4);
 
-    // Get authentication token
-    std::string token = getAuthToken();
-    if (token.empty())
+    // Bursts wait here for credits instead of drawing too_many_requests from the exchange
+    RateLimiter rateLimiter(RateLimiter::Policy::Queue);
+    system.setRateLimiter(&rateLimiter);
+
+    // Authenticate; the session refreshes the token in the background from here on
+    AuthSession auth(conn, CLIENT_ID, CLIENT_SECRET);
+    std::string token;
+    if (!auth.start())
     {
         std::cerr << "Failed to obtain authentication token. Exiting...\n";
         return 1;
     }
     std::cout << "Successfully authenticated!\n";
 
+    // Tick sizes and minimum amounts, from the warm-start file when it is recent
+    if (!system.loadInstruments({"BTC", "ETH"}))
+    {
+        std::cerr << "Instrument reference data unavailable, orders will not be checked locally\n";
+    }
+
     int networkChoice = 0;
     do
     {
@@ -115,14 +68,17 @@ int main()
             {
                 std::cout << "Starting WebSocket session...\n";
                 WebSocketClient client;
-                client.setMessageHandler([](const std::string &message)
+                client.setMessageHandler([](std::string_view message)
                                          { std::cout << "Received: " << message << std::endl; });
 
-                client.startWebSocketSession(token);
+                client.setRateLimiter(&rateLimiter);
+                client.startWebSocketSession(auth.token());
+                auth.attachWebSocket(&client); // Refreshes re-auth this connection in place
                 std::cout << "WebSocket session started. Press Enter to stop...\n";
 
                 std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
                 std::cin.get();
+                auth.attachWebSocket(nullptr);
                 client.close();
             }
             catch (const std::exception &e)
@@ -134,7 +90,23 @@ int main()
 
         case 2:
         { // Trade Menu
-            int choice;
+            // Follow the account's orders and positions so those queries are answered locally
+            WebSocketClient orderFeed;
+            orderFeed.setRateLimiter(&rateLimiter);
+            if (orderFeed.startSession("test.deribit.com", "443", auth.token()))
+            {
+                auth.attachWebSocket(&orderFeed);
+                if (!system.trackOrders(orderFeed, [&auth]() { return auth.token(); }))
+                {
+                    std::cerr << "Order tracking unavailable, order queries will use REST\n";
+                }
+                if (!system.trackPositions(orderFeed, auth.token()))
+                {
+                    std::cerr << "Position tracking unavailable, position queries will use REST\n";
+                }
+            }
+
+            int choice = 0;
             do
             {
                 showTradeMenu();
@@ -146,6 +118,7 @@ int main()
                     continue;
                 }
 
+                token = auth.token(); // Pick up any refresh since the last command
                 rj::Document response;
                 std::string instrument, orderId, currency, type, label;
                 double amount, price;
@@ -333,8 +306,10 @@ int main()
                         break;
                     }
                     case 11:
-                    {
-                        testOrderPlacement(20,token, system);
+                    { // Latency breakdown per endpoint and stage, from Connection's histograms
+                        system.getConnection().timings().write(std::cout);
+                        system.risk().write(std::cout);
+                        break;
                     }
                     case 12: 
                     {// Exit
@@ -350,7 +325,11 @@ int main()
                     std::cerr << "Error: " << e.what() << std::endl;
                 }
 
-            } while (choice != 17);
+            } while (choice != 12);
+            system.stopTrackingOrders();
+            system.stopTrackingPositions();
+            auth.attachWebSocket(nullptr);
+            orderFeed.close();
             break;
         }
 